@@ -19,8 +19,10 @@ const wb::ExecutionContextId EXECUTION_CONTEXT = WB_RES::LOCAL::GESTURE_TAP::EXE
 
 GestureService::GestureService()
     : ResourceProvider(WBDEBUG_NAME(__FUNCTION__), EXECUTION_CONTEXT)
-    , ResourceClient(WBDEBUG_NAME(__FUNCTION__), EXECUTION_CONTEXT)
     , LaunchableModule(LAUNCHABLE_NAME, EXECUTION_CONTEXT)
+    , m_tapConsumer(*this)
+    , m_shakeConsumer(*this)
+    , m_orientationConsumer(*this)
     , m_state({})
 {
 
@@ -170,95 +172,41 @@ void GestureService::onUnsubscribe(
     returnResult(request, wb::HTTP_CODE_OK);
 }
 
-void GestureService::onSubscribeResult(
-    wb::RequestId requestId,
-    wb::ResourceId resourceId,
-    wb::Result resultCode,
-    const wb::Value& result)
-{
-    if (resultCode >= 400)
-    {
-        DebugLogger::error("%s: onSubscribeResult resource: %d, status: %d",
-            LAUNCHABLE_NAME, resourceId.localResourceId, resultCode);
-    }
-}
-
-void GestureService::onUnsubscribeResult(
-    wb::RequestId requestId,
-    wb::ResourceId resourceId,
-    wb::Result resultCode,
-    const wb::Value& rResultData)
-{
-    if (resultCode >= 400)
-    {
-        DebugLogger::error("%s: onUnsubscribeResult resource: %d, status: %d",
-            LAUNCHABLE_NAME, resourceId.localResourceId, resultCode);
-    }
-}
-
-void GestureService::onNotify(
-    wb::ResourceId resourceId,
-    const wb::Value& value,
-    const wb::ParameterList& parameters)
-{
-    switch (resourceId.localResourceId)
-    {
-    case WB_RES::LOCAL::MEAS_ACC_SAMPLERATE::LID:
-    {
-        auto data = value.convertTo<const WB_RES::AccData&>();
-
-        if (m_state.tapSubscribers)
-            tapDetection(data);
-
-        if (m_state.shakeSubscribers)
-            shakeDetection(data);
-
-        if (m_state.orientationSubscribers)
-            orientationDetection(data);
-
-        break;
-    }
-    default:
-        DebugLogger::warning("%s: Unhandled notification from resource: %d",
-            LAUNCHABLE_NAME, resourceId.localResourceId);
-        break;
-    }
-}
-
 bool GestureService::handleSubscribe(wb::LocalResourceId resourceId)
 {
-    uint16_t currentSampleRate = getAccSampleRate();
+    SensorHub* hub = SensorHub::instance();
+    if (hub == nullptr)
+        return false;
 
     if (resourceId == WB_RES::LOCAL::GESTURE_TAP::LID)
     {
+        if (m_state.tapSubscribers == 0)
+        {
+            m_tap.reset();
+            if (!hub->subscribeAcc(m_tapConsumer, DEFAULT_TAP_DETECTION_ACC_SAMPLE_RATE))
+                return false;
+        }
         m_state.tapSubscribers += 1;
-        m_tap.reset();
     }
     else if (resourceId == WB_RES::LOCAL::GESTURE_SHAKE::LID)
     {
+        if (m_state.shakeSubscribers == 0)
+        {
+            m_shake.reset();
+            if (!hub->subscribeAcc(m_shakeConsumer, DEFAULT_SHAKE_DETECTION_ACC_SAMPLE_RATE))
+                return false;
+        }
         m_state.shakeSubscribers += 1;
-        m_shake.reset();
     }
     else if (resourceId == WB_RES::LOCAL::GESTURE_ORIENTATION::LID)
     {
-        m_state.orientationSubscribers += 1;
-        m_orientation.reset();
-    }
-
-    uint16_t requiredSampleRate = getAccSampleRate();
-
-    if (currentSampleRate != requiredSampleRate)
-    {
-        if (currentSampleRate > 0)
+        if (m_state.orientationSubscribers == 0)
         {
-            asyncUnsubscribe(
-                WB_RES::LOCAL::MEAS_ACC_SAMPLERATE(),
-                AsyncRequestOptions::Empty, currentSampleRate);
+            m_orientation.reset();
+            if (!hub->subscribeAcc(m_orientationConsumer, DEFAULT_ORIENTATION_ACC_SAMPLE_RATE))
+                return false;
         }
-
-        DebugLogger::info("%s: Subscribing to /Meas/Acc/%u", LAUNCHABLE_NAME, requiredSampleRate);
-        asyncSubscribe(WB_RES::LOCAL::MEAS_ACC_SAMPLERATE(),
-            AsyncRequestOptions::NotCriticalSubscription, requiredSampleRate);
+        m_state.orientationSubscribers += 1;
     }
 
     return true;
@@ -266,35 +214,27 @@ bool GestureService::handleSubscribe(wb::LocalResourceId resourceId)
 
 void GestureService::handleUnsubscribe(wb::LocalResourceId resourceId)
 {
-    uint16_t currentSampleRate = getAccSampleRate();
+    SensorHub* hub = SensorHub::instance();
+    if (hub == nullptr)
+        return;
 
     if (resourceId == WB_RES::LOCAL::GESTURE_TAP::LID && m_state.tapSubscribers > 0)
+    {
         m_state.tapSubscribers -= 1;
+        if (m_state.tapSubscribers == 0)
+            hub->unsubscribeAcc(m_tapConsumer);
+    }
     else if (resourceId == WB_RES::LOCAL::GESTURE_SHAKE::LID && m_state.shakeSubscribers > 0)
+    {
         m_state.shakeSubscribers -= 1;
+        if (m_state.shakeSubscribers == 0)
+            hub->unsubscribeAcc(m_shakeConsumer);
+    }
     else if (resourceId == WB_RES::LOCAL::GESTURE_ORIENTATION::LID && m_state.orientationSubscribers > 0)
-        m_state.orientationSubscribers -= 1;
-
-    uint16_t requiredSampleRate = getAccSampleRate();
-
-    if (currentSampleRate != requiredSampleRate)
     {
-        DebugLogger::info("%s: Changing acc samplerate %u -> %u",
-            LAUNCHABLE_NAME, currentSampleRate, requiredSampleRate);
-
-        if (currentSampleRate > 0)
-        {
-            asyncUnsubscribe(
-                WB_RES::LOCAL::MEAS_ACC_SAMPLERATE(),
-                AsyncRequestOptions::Empty, currentSampleRate);
-        }
-
-        if (requiredSampleRate)
-        {
-            asyncSubscribe(
-                WB_RES::LOCAL::MEAS_ACC_SAMPLERATE(),
-                AsyncRequestOptions::NotCriticalSubscription, requiredSampleRate);
-        }
+        m_state.orientationSubscribers -= 1;
+        if (m_state.orientationSubscribers == 0)
+            hub->unsubscribeAcc(m_orientationConsumer);
     }
 }
 
@@ -304,12 +244,7 @@ void GestureService::tapDetection(const WB_RES::AccData& data)
     constexpr uint32_t LATENCY = 80; // ms, should work with the lowest sample rate
     constexpr uint32_t TIMEOUT = 2000;
 
-    uint16_t sampleRate = getAccSampleRate();
-
-    if (sampleRate == 0)
-        return;
-
-    float interval = 1000.0f / sampleRate; // delta between samples
+    float interval = 1000.0f / DEFAULT_TAP_DETECTION_ACC_SAMPLE_RATE; // delta between samples
 
     for (size_t i = 0; i < data.arrayAcc.size(); i++)
     {
@@ -374,12 +309,7 @@ void GestureService::shakeDetection(const WB_RES::AccData& data)
     constexpr float THRESHOLD = (9.81f * 1.5f);
     constexpr uint32_t LATENCY = 500; // ms
 
-    uint16_t sampleRate = getAccSampleRate();
-
-    if (sampleRate == 0)
-        return;
-
-    float interval = 1000.0f / sampleRate;
+    float interval = 1000.0f / DEFAULT_SHAKE_DETECTION_ACC_SAMPLE_RATE;
 
     for (size_t i = 0; i < data.arrayAcc.size(); i++)
     {
@@ -431,12 +361,8 @@ void GestureService::shakeDetection(const WB_RES::AccData& data)
 void GestureService::orientationDetection(const WB_RES::AccData& data)
 {
     constexpr uint32_t LATENCY = 1000; // Time to hold (ms) the same orientation before committing
-    uint16_t sampleRate = getAccSampleRate();
-    
-    if (sampleRate == 0)
-        return;
 
-    float interval = 1000.0f / sampleRate;
+    float interval = 1000.0f / DEFAULT_ORIENTATION_ACC_SAMPLE_RATE;
 
     for (size_t i = 0; i < data.arrayAcc.size(); i++)
     {
@@ -485,20 +411,6 @@ void GestureService::orientationDetection(const WB_RES::AccData& data)
     }
 }
 
-uint16_t GestureService::getAccSampleRate()
-{
-    if (m_state.tapSubscribers > 0)
-        return DEFAULT_TAP_DETECTION_ACC_SAMPLE_RATE;
-
-    if (m_state.shakeSubscribers > 0)
-        return DEFAULT_SHAKE_DETECTION_ACC_SAMPLE_RATE;
-
-    if (m_state.orientationSubscribers > 0)
-        return DEFAULT_ORIENTATION_ACC_SAMPLE_RATE;
-
-    return 0;
-}
-
 void GestureService::TapDetection::reset()
 {
     count = 0;
@@ -1,13 +1,13 @@
 #pragma once
 #include <whiteboard/LaunchableModule.h>
-#include <whiteboard/ResourceClient.h>
 #include <whiteboard/ResourceProvider.h>
 
 #include "modules-resources/resources.h"
 #include "meas_acc/resources.h"
 #include "internal/Filter.hpp"
+#include "../SensorHub/SensorHub.hpp"
 
-class GestureService FINAL : private wb::ResourceProvider, private wb::ResourceClient, public wb::LaunchableModule
+class GestureService FINAL : private wb::ResourceProvider, public wb::LaunchableModule
 {
 public:
     static const char* const LAUNCHABLE_NAME;
@@ -38,33 +38,19 @@ private: /* wb::ResourceProvider */
         const wb::Request& request,
         const wb::ParameterList& parameters) OVERRIDE;
 
-private: /* wb::ResourceClient */
-    virtual void onSubscribeResult(
-        wb::RequestId requestId,
-        wb::ResourceId resourceId,
-        wb::Result resultCode,
-        const wb::Value& result) OVERRIDE;
-
-    virtual void onUnsubscribeResult(
-        wb::RequestId requestId,
-        wb::ResourceId resourceId,
-        wb::Result resultCode,
-        const wb::Value& rResultData) OVERRIDE;
-
-    virtual void onNotify(
-        wb::ResourceId resourceId,
-        const wb::Value& value,
-        const wb::ParameterList& parameters) OVERRIDE;
-
 private:
     bool handleSubscribe(wb::LocalResourceId resourceId);
     void handleUnsubscribe(wb::LocalResourceId resourceId);
-    uint16_t getAccSampleRate();
 
     void tapDetection(const WB_RES::AccData& data);
     void shakeDetection(const WB_RES::AccData& data);
     void orientationDetection(const WB_RES::AccData& data);
 
+    // Each detector gets the acc samples from the sensor hub at its own rate
+    sensor_hub::AccHandler<GestureService, &GestureService::tapDetection> m_tapConsumer;
+    sensor_hub::AccHandler<GestureService, &GestureService::shakeDetection> m_shakeConsumer;
+    sensor_hub::AccHandler<GestureService, &GestureService::orientationDetection> m_orientationConsumer;
+
     struct State
     {
         uint8_t tapSubscribers = 0;
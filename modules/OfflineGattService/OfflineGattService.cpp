@@ -1,6 +1,7 @@
 #include "OfflineGattService.hpp"
 
 #include "app-resources/resources.h"
+#include "modules-resources/resources.h"
 #include "comm_ble/resources.h"
 #include "comm_ble_gattsvc/resources.h"
 #include "sbem_types.h"
@@ -181,6 +182,41 @@ void OfflineGattService::onGetResult(
         }
         break;
     }
+    case WB_RES::LOCAL::OFFLINE_MEAS_STATS::LID:
+    {
+        if (resultCode != wb::HTTP_CODE_OK)
+        {
+            sendStatusResponse(pendingRequestId, resultCode);
+            return;
+        }
+
+        auto stats = result.convertTo<const WB_RES::OfflineMeasStats&>();
+
+        // Channel count, then per channel: channel, samples, bytes, blocks,
+        // gap blocks, max residual (uint32) and bits per sample (float)
+        constexpr size_t CHANNEL_SIZE = 1 + 5 * sizeof(uint32_t) + sizeof(float);
+        uint8_t data[1 + WB_RES::OfflineMeasurement::COUNT * CHANNEL_SIZE] = {};
+        size_t count = WB_MIN(stats.channels.size(), (size_t)WB_RES::OfflineMeasurement::COUNT);
+
+        data[0] = count;
+        uint8_t* out = data + 1;
+        for (size_t i = 0; i < count; i++)
+        {
+            const WB_RES::OfflineCompressionStats& channel = stats.channels[i];
+            const uint32_t counters[] = {
+                channel.samples, channel.bytes, channel.blocks, channel.gapBlocks, channel.maxResidual
+            };
+            float bitsPerSample = channel.bitsPerSample;
+
+            *out++ = channel.channel;
+            memcpy(out, counters, sizeof(counters));
+            out += sizeof(counters);
+            memcpy(out, &bitsPerSample, sizeof(bitsPerSample));
+            out += sizeof(bitsPerSample);
+        }
+        sendData(data, out - data);
+        break;
+    }
     case WB_RES::LOCAL::MEM_LOGBOOK_ENTRIES::LID:
     {
         if (resultCode >= 400)
@@ -625,6 +661,11 @@ void OfflineGattService::handleCommand(const CommandPacket& packet)
         asyncGet(WB_RES::LOCAL::OFFLINE_DEBUG(), AsyncRequestOptions::ForceAsync);
         break;
     }
+    case CommandPacket::CmdReadStats:
+    {
+        asyncGet(WB_RES::LOCAL::OFFLINE_MEAS_STATS(), AsyncRequestOptions::ForceAsync);
+        break;
+    }
     case CommandPacket::CmdStartDebugLogStream:
     {
         if (m_debugLogStream.packetRef != Packet::INVALID_REF)
@@ -690,38 +731,14 @@ bool OfflineGattService::asyncSubsribeHandleResource(int16_t charHandle, whitebo
 
 void OfflineGattService::sendData(const uint8_t* data, uint32_t size)
 {
-    uint32_t sent = 0;
-    do
-    {
-        DataPacket packet(pendingRequestId);
-        packet.offset = sent;
-        packet.totalBytes = size;
-
-        uint32_t len = WB_MIN(size, DataPacket::MAX_PAYLOAD);
-        packet.data = ReadableBuffer(data + sent, len);
-
-        sendPacket(packet);
-        sent += len;
-    } while (sent < size);
-
+    sendPartialData(data, size, size, 0);
     pendingRequestId = Packet::INVALID_REF;
 }
 
 void OfflineGattService::sendPartialData(const uint8_t* data, uint32_t partSize, uint32_t totalSize, uint32_t offset)
 {
-    uint32_t sent = 0;
-    do
-    {
-        DataPacket packet(pendingRequestId);
-        packet.offset = offset + sent;
-        packet.totalBytes = totalSize;
-
-        uint32_t len = WB_MIN(partSize - sent, DataPacket::MAX_PAYLOAD);
-        packet.data = ReadableBuffer(data + sent, len);
-
-        sendPacket(packet);
-        sent += len;
-    } while (sent < partSize);
+    DataPacket::Split(pendingRequestId, data, partSize, totalSize, offset,
+        [this](DataPacket& packet) { sendPacket(packet); });
 }
 
 void OfflineGattService::sendStatusResponse(uint8_t requestRef, uint16_t status)
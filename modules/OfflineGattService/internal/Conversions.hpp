@@ -21,7 +21,26 @@ namespace gatt_svc
             .wakeUpBehavior = (WB_RES::OfflineWakeup::Type)config.wakeUpBehavior,
             .measurementParams = wb::MakeArray(config.measurementParams.array),
             .sleepDelay = config.sleepDelay,
-            .options = config.optionsFlags
+            .options = config.optionsFlags,
+            .ecgCompression = config.ecgCompression,
+            .ecgPredictor = config.ecgPredictor,
+            .ecgBlockSize = config.ecgBlockSize,
+            .ecgBitDepth = config.ecgBitDepth,
+            .ecgMaxError = config.ecgMaxError,
+            .ecgWaveletThreshold = config.ecgWaveletThreshold,
+            .accRange = config.accRange,
+            .gyroRange = config.gyroRange,
+            .extendedOptions = config.extendedOptionsFlags,
+            .hrHysteresis = config.hrHysteresis,
+            .tempHysteresis = config.tempHysteresis,
+            .activityHysteresis = config.activityHysteresis,
+            .slowMinInterval = config.slowMinInterval,
+            .slowHeartbeat = config.slowHeartbeat,
+            .slowBlockAge = config.slowBlockAge,
+            .syncInterval = config.syncInterval,
+            .batchBytes = config.batchBytes,
+            .batchLatency = config.batchLatency,
+            .accBaseRate = config.accBaseRate,
         };
     }
 
@@ -35,6 +54,25 @@ namespace gatt_svc
         }
         internal.sleepDelay = config.sleepDelay;
         internal.optionsFlags = config.options;
+        internal.ecgCompression = (OfflineConfig::ECGCompression)config.ecgCompression;
+        internal.ecgPredictor = (OfflineConfig::ECGPredictor)config.ecgPredictor;
+        internal.ecgBlockSize = config.ecgBlockSize;
+        internal.ecgBitDepth = config.ecgBitDepth;
+        internal.ecgMaxError = config.ecgMaxError;
+        internal.ecgWaveletThreshold = config.ecgWaveletThreshold;
+        internal.accRange = config.accRange;
+        internal.gyroRange = config.gyroRange;
+        internal.extendedOptionsFlags = config.extendedOptions;
+        internal.hrHysteresis = config.hrHysteresis;
+        internal.tempHysteresis = config.tempHysteresis;
+        internal.activityHysteresis = config.activityHysteresis;
+        internal.slowMinInterval = config.slowMinInterval;
+        internal.slowHeartbeat = config.slowHeartbeat;
+        internal.slowBlockAge = config.slowBlockAge;
+        internal.syncInterval = config.syncInterval;
+        internal.batchBytes = config.batchBytes;
+        internal.batchLatency = config.batchLatency;
+        internal.accBaseRate = config.accBaseRate;
         return internal;
     }
 
@@ -13,6 +13,7 @@ struct CommandPacket : public Packet
         CmdDebugLastFault,
         CmdStartDebugLogStream,
         CmdStopDebugLogStream,
+        CmdReadStats,
         CmdCount
     } command;
 
@@ -13,4 +13,26 @@ struct DataPacket : public Packet
     virtual ~DataPacket();
     virtual bool Read(ReadableBuffer& stream);
     virtual bool Write(WritableBuffer& stream);
+
+    /// Split partSize bytes at offset of a reply of totalSize bytes into packets of at
+    /// most MAX_PAYLOAD bytes and pass each to send(DataPacket&). An empty part is sent
+    /// as one empty packet.
+    template<typename TSend>
+    static void Split(uint8_t ref, const uint8_t* data, uint32_t partSize, uint32_t totalSize, uint32_t offset,
+        TSend&& send)
+    {
+        uint32_t sent = 0;
+        do
+        {
+            DataPacket packet(ref);
+            packet.offset = offset + sent;
+            packet.totalBytes = totalSize;
+
+            uint32_t len = partSize - sent < MAX_PAYLOAD ? partSize - sent : MAX_PAYLOAD;
+            packet.data = ReadableBuffer(data + sent, len);
+
+            send(packet);
+            sent += len;
+        } while (sent < partSize);
+    }
 };
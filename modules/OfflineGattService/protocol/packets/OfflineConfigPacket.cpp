@@ -16,6 +16,44 @@ bool OfflineConfigPacket::Read(ReadableBuffer& stream)
     result &= stream.read(&config.sleepDelay, 2);
     result &= stream.read(&config.optionsFlags, 1);
     result &= stream.read(&config.measurementParams, OfflineConfig::MeasCount * 2);
+    if (stream.get_read_pos() < stream.get_read_size()) // Added in protocol version 1.4
+        result &= stream.read(&config.ecgCompression, 1);
+    if (stream.get_read_pos() < stream.get_read_size()) // Added in protocol version 1.5
+        result &= stream.read(&config.ecgPredictor, 1);
+    if (stream.get_read_pos() < stream.get_read_size()) // Added in protocol version 1.6
+        result &= stream.read(&config.ecgBlockSize, 2);
+    if (stream.get_read_pos() < stream.get_read_size()) // Added in protocol version 1.7
+        result &= stream.read(&config.ecgBitDepth, 1);
+    if (stream.get_read_pos() < stream.get_read_size()) // Added in protocol version 1.8
+        result &= stream.read(&config.ecgMaxError, 1);
+    if (stream.get_read_pos() < stream.get_read_size()) // Added in protocol version 1.9
+        result &= stream.read(&config.ecgWaveletThreshold, 1);
+    if (stream.get_read_pos() < stream.get_read_size()) // Added in protocol version 1.13
+    {
+        result &= stream.read(&config.accRange, 1);
+        result &= stream.read(&config.gyroRange, 2);
+    }
+    if (stream.get_read_pos() < stream.get_read_size()) // Added in protocol version 1.14
+        result &= stream.read(&config.extendedOptionsFlags, 1);
+    if (stream.get_read_pos() < stream.get_read_size()) // Added in protocol version 1.15
+    {
+        result &= stream.read(&config.hrHysteresis, 1);
+        result &= stream.read(&config.tempHysteresis, 1);
+        result &= stream.read(&config.activityHysteresis, 2);
+        result &= stream.read(&config.slowMinInterval, 2);
+        result &= stream.read(&config.slowHeartbeat, 2);
+    }
+    if (stream.get_read_pos() < stream.get_read_size()) // Added in protocol version 1.16
+        result &= stream.read(&config.slowBlockAge, 2);
+    if (stream.get_read_pos() < stream.get_read_size()) // Added in protocol version 1.17
+        result &= stream.read(&config.syncInterval, 2);
+    if (stream.get_read_pos() < stream.get_read_size()) // Added in protocol version 1.18
+    {
+        result &= stream.read(&config.batchBytes, 2);
+        result &= stream.read(&config.batchLatency, 2);
+    }
+    if (stream.get_read_pos() < stream.get_read_size()) // Added in protocol version 1.19
+        result &= stream.read(&config.accBaseRate, 2);
     return result;
 };
 
@@ -26,5 +64,24 @@ bool OfflineConfigPacket::Write(WritableBuffer& stream)
     result &= stream.write(&config.sleepDelay, 2);
     result &= stream.write(&config.optionsFlags, 1);
     result &= stream.write(&config.measurementParams, OfflineConfig::MeasCount * 2);
+    result &= stream.write(&config.ecgCompression, 1);
+    result &= stream.write(&config.ecgPredictor, 1);
+    result &= stream.write(&config.ecgBlockSize, 2);
+    result &= stream.write(&config.ecgBitDepth, 1);
+    result &= stream.write(&config.ecgMaxError, 1);
+    result &= stream.write(&config.ecgWaveletThreshold, 1);
+    result &= stream.write(&config.accRange, 1);
+    result &= stream.write(&config.gyroRange, 2);
+    result &= stream.write(&config.extendedOptionsFlags, 1);
+    result &= stream.write(&config.hrHysteresis, 1);
+    result &= stream.write(&config.tempHysteresis, 1);
+    result &= stream.write(&config.activityHysteresis, 2);
+    result &= stream.write(&config.slowMinInterval, 2);
+    result &= stream.write(&config.slowHeartbeat, 2);
+    result &= stream.write(&config.slowBlockAge, 2);
+    result &= stream.write(&config.syncInterval, 2);
+    result &= stream.write(&config.batchBytes, 2);
+    result &= stream.write(&config.batchLatency, 2);
+    result &= stream.write(&config.accBaseRate, 2);
     return result;
 }
@@ -0,0 +1,121 @@
+// DataPacket::Split: replies longer than a packet are sent in MAX_PAYLOAD pieces that
+// reassemble into the reply, like the compression stats reply (1 + 8 channels x 29 bytes).
+#include <cstdio>
+#include <vector>
+
+#include "packets/DataPacket.hpp"
+
+namespace
+{
+    int g_failures = 0;
+
+    bool check(bool condition, const char* text, int line)
+    {
+        if (!condition)
+        {
+            std::printf("%s:%d: check failed: %s\n", __FILE__, line, text);
+            g_failures++;
+        }
+        return condition;
+    }
+
+#define CHECK(condition) check((condition), #condition, __LINE__)
+
+    constexpr uint8_t REF = 42;
+
+    /// Serializes each packet like OfflineGattService::sendPacket, reads it back and
+    /// copies its payload to its offset
+    struct Receiver
+    {
+        std::vector<uint8_t> reply;
+        std::vector<bool> received;
+        size_t packets = 0;
+
+        explicit Receiver(uint32_t totalSize)
+            : reply(totalSize)
+            , received(totalSize)
+        {
+        }
+
+        void operator()(DataPacket& packet)
+        {
+            packets++;
+            uint8_t buffer[Packet::MAX_PACKET_SIZE];
+            WritableBuffer out(buffer, sizeof(buffer));
+            if (!CHECK(packet.Write(out)))
+                return;
+
+            ReadableBuffer in(buffer, out.get_write_pos());
+            DataPacket read(Packet::INVALID_REF);
+            CHECK(read.Read(in));
+            CHECK(read.type == Packet::TypeData && read.reference == REF);
+            CHECK(read.totalBytes == reply.size());
+            CHECK(read.data.get_read_size() <= DataPacket::MAX_PAYLOAD);
+            if (!CHECK(read.offset + read.data.get_read_size() <= reply.size()))
+                return;
+
+            for (size_t i = 0; i < read.data.get_read_size(); i++)
+            {
+                CHECK(!received[read.offset + i]);
+                received[read.offset + i] = true;
+                reply[read.offset + i] = read.data.get_read_ptr()[i];
+            }
+        }
+    };
+
+    std::vector<uint8_t> pattern(size_t size)
+    {
+        std::vector<uint8_t> data(size);
+        for (size_t i = 0; i < size; i++)
+            data[i] = static_cast<uint8_t>(i * 7 + 3);
+        return data;
+    }
+
+    void test_whole_reply(uint32_t size)
+    {
+        const std::vector<uint8_t> data = pattern(size);
+        Receiver receiver(size);
+        DataPacket::Split(REF, data.data(), size, size, 0, receiver);
+
+        const size_t expected = size == 0 ? 1 : (size + DataPacket::MAX_PAYLOAD - 1) / DataPacket::MAX_PAYLOAD;
+        const bool packets = CHECK(receiver.packets == expected);
+        if (!CHECK(receiver.reply == data) || !packets)
+            std::printf("  %u bytes: %zu packets\n", size, receiver.packets);
+        for (bool byte : receiver.received)
+            CHECK(byte);
+    }
+
+    /// Log downloads send each chunk of the log as a part at its offset
+    void test_parts(uint32_t totalSize, uint32_t partSize)
+    {
+        const std::vector<uint8_t> data = pattern(totalSize);
+        Receiver receiver(totalSize);
+        for (uint32_t offset = 0; offset < totalSize; offset += partSize)
+        {
+            const uint32_t size = totalSize - offset < partSize ? totalSize - offset : partSize;
+            DataPacket::Split(REF, data.data() + offset, size, totalSize, offset, receiver);
+        }
+        CHECK(receiver.reply == data);
+        for (bool byte : receiver.received)
+            CHECK(byte);
+    }
+} // namespace
+
+int main()
+{
+    // The compression stats reply: channel count and 8 channels of 1 + 6 x 4 + 4 bytes
+    constexpr uint32_t STATS_REPLY_SIZE = 1 + 8 * (1 + 6 * 4 + 4);
+    static_assert(STATS_REPLY_SIZE > DataPacket::MAX_PAYLOAD, "The stats reply has to span packets");
+    test_whole_reply(STATS_REPLY_SIZE);
+
+    constexpr uint32_t PAYLOAD = DataPacket::MAX_PAYLOAD;
+    for (uint32_t size : { 0u, 1u, PAYLOAD - 1, PAYLOAD, PAYLOAD + 1, 2 * PAYLOAD, 2 * PAYLOAD + 1, 1000u })
+        test_whole_reply(size);
+
+    test_parts(1000, 128);
+    test_parts(1000, 300);
+    test_parts(3 * PAYLOAD, PAYLOAD);
+
+    std::printf("data_packet_test: %s (%d failures)\n", g_failures == 0 ? "passed" : "FAILED", g_failures);
+    return g_failures == 0 ? 0 : 1;
+}
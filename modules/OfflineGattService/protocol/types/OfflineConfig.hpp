@@ -33,6 +33,31 @@ struct OfflineConfig
         OptionsTripleTapToStartLog  = (1 << 4),
         OptionsLogOrientation       = (1 << 5),
         OptionsStudsToConnect       = (1 << 6),
+        OptionsCompressIMU          = (1 << 7),
+    };
+
+    enum ExtendedOptionsFlags : uint8_t
+    {
+        ExtOptionsCompressRR         = (1 << 0),
+        ExtOptionsCompressSlow       = (1 << 1),
+        ExtOptionsImplicitTimestamps = (1 << 2),
+    };
+
+    enum ECGCompression : uint8_t
+    {
+        ECGCompressionGamma = 0U,
+        ECGCompressionRice  = 1U,
+        ECGCompressionWavelet = 2U,
+        ECGCompressionAdaptive = 3U,
+    };
+
+    enum ECGPredictor : uint8_t
+    {
+        ECGPredictorFirstOrder  = 0U,
+        ECGPredictorZeroOrder   = 1U,
+        ECGPredictorSecondOrder = 2U,
+        ECGPredictorLPC         = 3U,
+        ECGPredictorBeatTemplate = 4U,
     };
 
     uint16_t sleepDelay = 0;
@@ -53,4 +78,24 @@ struct OfflineConfig
         } bySensor;
         uint16_t array[MeasCount] = {};
     } measurementParams;
+
+    ECGCompression ecgCompression = ECGCompressionGamma;
+    ECGPredictor ecgPredictor = ECGPredictorFirstOrder;
+    uint16_t ecgBlockSize = 32;
+    uint8_t ecgBitDepth = 16;
+    uint8_t ecgMaxError = 0;
+    uint8_t ecgWaveletThreshold = 0;
+    uint8_t accRange = 0;
+    uint16_t gyroRange = 0;
+    uint8_t extendedOptionsFlags = 0;
+    uint8_t hrHysteresis = 1;
+    uint8_t tempHysteresis = 1;
+    uint16_t activityHysteresis = 0;
+    uint16_t slowMinInterval = 0;
+    uint16_t slowHeartbeat = 0;
+    uint16_t slowBlockAge = 900;
+    uint16_t syncInterval = 60;
+    uint16_t batchBytes = 0;
+    uint16_t batchLatency = 1000;
+    uint16_t accBaseRate = 0;
 };
@@ -17,8 +17,6 @@
 #include "compression/BitPack.hpp"
 #include "compression/FixedPoint.hpp"
 
-#include <functional>
-
 using namespace offline_meas;
 using namespace offline_meas::compression;
 
@@ -26,17 +24,40 @@ using namespace offline_meas::compression;
 
 const char* const OfflineMeasurements::LAUNCHABLE_NAME = "OfflineMeas";
 constexpr uint16_t DEFAULT_ACC_SAMPLE_RATE = 13;
+constexpr int32_t ECG_SAMPLE_MIN_18BIT = -(1 << 17);
+constexpr int32_t ECG_SAMPLE_MAX_18BIT = (1 << 17) - 1;
+constexpr float STANDARD_GRAVITY = 9.80665f; // m/s^2
+constexpr uint16_t DEFAULT_SLOW_BLOCK_AGE = 900; // s
+constexpr uint16_t DEFAULT_SYNC_INTERVAL = 60; // s
+constexpr uint16_t DEFAULT_BATCH_LATENCY = 1000; // ms
+constexpr uint32_t FLUSH_INTERVAL = 1000; // ms, resolution of the block ages and batch latencies
 
 static const wb::LocalResourceId sProviderResources[] = {
+    WB_RES::LOCAL::OFFLINE_MEAS_CONFIG::LID,
+    WB_RES::LOCAL::OFFLINE_MEAS_STATS::LID,
+    WB_RES::LOCAL::OFFLINE_MEAS_SYNC::LID,
     WB_RES::LOCAL::OFFLINE_MEAS_ECG_SAMPLERATE::LID,
     WB_RES::LOCAL::OFFLINE_MEAS_ECG_COMPRESSED_SAMPLERATE::LID,
+    WB_RES::LOCAL::OFFLINE_MEAS_ECG_IMPLICIT_SAMPLERATE::LID,
     WB_RES::LOCAL::OFFLINE_MEAS_HR::LID,
+    WB_RES::LOCAL::OFFLINE_MEAS_HR_COMPRESSED::LID,
     WB_RES::LOCAL::OFFLINE_MEAS_RR::LID,
+    WB_RES::LOCAL::OFFLINE_MEAS_RR_COMPRESSED::LID,
     WB_RES::LOCAL::OFFLINE_MEAS_ACC_SAMPLERATE::LID,
+    WB_RES::LOCAL::OFFLINE_MEAS_ACC_COMPRESSED_SAMPLERATE::LID,
+    WB_RES::LOCAL::OFFLINE_MEAS_ACC_COMPACT_SAMPLERATE::LID,
+    WB_RES::LOCAL::OFFLINE_MEAS_ACC_IMPLICIT_SAMPLERATE::LID,
     WB_RES::LOCAL::OFFLINE_MEAS_GYRO_SAMPLERATE::LID,
+    WB_RES::LOCAL::OFFLINE_MEAS_GYRO_COMPRESSED_SAMPLERATE::LID,
+    WB_RES::LOCAL::OFFLINE_MEAS_GYRO_COMPACT_SAMPLERATE::LID,
+    WB_RES::LOCAL::OFFLINE_MEAS_GYRO_IMPLICIT_SAMPLERATE::LID,
     WB_RES::LOCAL::OFFLINE_MEAS_MAGN_SAMPLERATE::LID,
+    WB_RES::LOCAL::OFFLINE_MEAS_MAGN_COMPRESSED_SAMPLERATE::LID,
+    WB_RES::LOCAL::OFFLINE_MEAS_MAGN_IMPLICIT_SAMPLERATE::LID,
     WB_RES::LOCAL::OFFLINE_MEAS_TEMP::LID,
+    WB_RES::LOCAL::OFFLINE_MEAS_TEMP_COMPRESSED::LID,
     WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_INTERVAL::LID,
+    WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_COMPRESSED_INTERVAL::LID,
 };
 
 const wb::ExecutionContextId EXECUTION_CONTEXT = WB_RES::LOCAL::OFFLINE_MEAS_ECG_SAMPLERATE::EXECUTION_CONTEXT;
@@ -45,10 +66,19 @@ OfflineMeasurements::OfflineMeasurements()
     : ResourceProvider(WBDEBUG_NAME(__FUNCTION__), EXECUTION_CONTEXT)
     , ResourceClient(WBDEBUG_NAME(__FUNCTION__), EXECUTION_CONTEXT)
     , LaunchableModule(LAUNCHABLE_NAME, EXECUTION_CONTEXT)
+    , m_accConsumer(*this)
+    , m_activityConsumer(*this)
     , m_state({})
+    , m_flushTimer(wb::ID_INVALID_TIMER)
     , m_options({})
 {
-
+    m_options.ecgBlockSize = State::ECG::COMPRESSOR_DEFAULT_BLOCK_SIZE;
+    m_options.ecgBitDepth = State::ECG::COMPRESSOR_DEFAULT_BIT_DEPTH;
+    m_options.hrHysteresis = 1;
+    m_options.tempHysteresis = 1;
+    m_options.slowBlockAge = DEFAULT_SLOW_BLOCK_AGE;
+    m_options.syncInterval = DEFAULT_SYNC_INTERVAL;
+    m_options.batchLatency = DEFAULT_BATCH_LATENCY;
 }
 
 OfflineMeasurements::~OfflineMeasurements()
@@ -79,6 +109,11 @@ bool OfflineMeasurements::startModule()
 
 void OfflineMeasurements::stopModule()
 {
+    if (m_flushTimer != wb::ID_INVALID_TIMER)
+    {
+        ResourceClient::stopTimer(m_flushTimer);
+        m_flushTimer = wb::ID_INVALID_TIMER;
+    }
     mModuleState = WB_RES::ModuleStateValues::STOPPED;
 }
 
@@ -97,6 +132,64 @@ void OfflineMeasurements::onGetRequest(
 
     switch (lid)
     {
+    case WB_RES::LOCAL::OFFLINE_MEAS_CONFIG::LID:
+    {
+        WB_RES::OfflineMeasConfig config = {
+            .ecgCompression = static_cast<WB_RES::OfflineECGCompression::Type>(m_options.ecgCompression),
+            .ecgPredictor = static_cast<WB_RES::OfflineECGPredictor::Type>(m_options.ecgPredictor),
+            .ecgBlockSize = m_options.ecgBlockSize,
+            .ecgBitDepth = m_options.ecgBitDepth,
+            .ecgMaxError = m_options.ecgMaxError,
+            .ecgWaveletThreshold = m_options.ecgWaveletThreshold,
+            .accRange = m_options.accRange,
+            .gyroRange = m_options.gyroRange,
+            .hrHysteresis = m_options.hrHysteresis,
+            .tempHysteresis = m_options.tempHysteresis,
+            .activityHysteresis = m_options.activityHysteresis,
+            .slowMinInterval = m_options.slowMinInterval,
+            .slowHeartbeat = m_options.slowHeartbeat,
+            .slowBlockAge = m_options.slowBlockAge,
+            .syncInterval = m_options.syncInterval,
+            .batchBytes = m_options.batchBytes,
+            .batchLatency = m_options.batchLatency,
+            .accBaseRate = m_options.accBaseRate,
+        };
+        returnResult(request, wb::HTTP_CODE_OK, ResponseOptions::Empty, config);
+        break;
+    }
+    case WB_RES::LOCAL::OFFLINE_MEAS_STATS::LID:
+    {
+        WB_RES::OfflineCompressionStats channels[WB_RES::OfflineMeasurement::COUNT];
+        size_t count = 0;
+
+        auto addChannel = [&channels, &count](WB_RES::OfflineMeasurement::Type channel, const CompressionStats& stats) {
+            if (stats.samples == 0)
+                return;
+            channels[count++] = {
+                .channel = channel,
+                .samples = stats.samples,
+                .bytes = stats.bytes,
+                .blocks = stats.blocks,
+                .gapBlocks = stats.gapBlocks,
+                .maxResidual = stats.maxResidual,
+                .bitsPerSample = stats.bits_per_sample(),
+            };
+            };
+
+        addChannel(WB_RES::OfflineMeasurement::ECG, m_state.ecg.stats);
+        addChannel(WB_RES::OfflineMeasurement::HR, m_state.hr.stats);
+        addChannel(WB_RES::OfflineMeasurement::RR, m_state.r_to_r.stats);
+        addChannel(WB_RES::OfflineMeasurement::ACC, m_state.imu[imu_channel(WB_RES::OfflineMeasurement::ACC)].stats);
+        addChannel(WB_RES::OfflineMeasurement::GYRO, m_state.imu[imu_channel(WB_RES::OfflineMeasurement::GYRO)].stats);
+        addChannel(WB_RES::OfflineMeasurement::MAGN, m_state.imu[imu_channel(WB_RES::OfflineMeasurement::MAGN)].stats);
+        addChannel(WB_RES::OfflineMeasurement::TEMP, m_state.temperature.stats);
+        addChannel(WB_RES::OfflineMeasurement::ACTIVITY, m_state.activity.stats);
+
+        WB_RES::OfflineMeasStats stats;
+        stats.channels = wb::MakeArray(channels, count);
+        returnResult(request, wb::HTTP_CODE_OK, ResponseOptions::Empty, stats);
+        break;
+    }
     default:
         DebugLogger::warning("%s: Unimplemented GET for resource %d", LAUNCHABLE_NAME, lid);
         returnResult(request, wb::HTTP_CODE_NOT_IMPLEMENTED);
@@ -126,6 +219,37 @@ void OfflineMeasurements::onPostRequest(
     }
 }
 
+void OfflineMeasurements::onPutRequest(
+    const wb::Request& request,
+    const wb::ParameterList& parameters)
+{
+    wb::LocalResourceId lid = request.getResourceId().localResourceId;
+    DebugLogger::verbose("%s: onPutRequest resource %d", LAUNCHABLE_NAME, lid);
+
+    if (mModuleState != WB_RES::ModuleStateValues::STARTED)
+    {
+        returnResult(request, wb::HTTP_CODE_SERVICE_UNAVAILABLE);
+        return;
+    }
+
+    switch (lid)
+    {
+    case WB_RES::LOCAL::OFFLINE_MEAS_CONFIG::LID:
+    {
+        const auto& config = WB_RES::LOCAL::OFFLINE_MEAS_CONFIG::PUT::ParameterListRef(parameters).getConfig();
+        if (applyConfig(config))
+            returnResult(request, wb::HTTP_CODE_OK);
+        else
+            returnResult(request, wb::HTTP_CODE_BAD_REQUEST);
+        break;
+    }
+    default:
+        DebugLogger::warning("%s: Unimplemented PUT for resource %d", LAUNCHABLE_NAME, lid);
+        returnResult(request, wb::HTTP_CODE_NOT_IMPLEMENTED);
+        break;
+    }
+}
+
 void OfflineMeasurements::onSubscribe(
     const whiteboard::Request& request,
     const whiteboard::ParameterList& parameters)
@@ -143,6 +267,15 @@ void OfflineMeasurements::onSubscribe(
 
     switch (lid)
     {
+    case WB_RES::LOCAL::OFFLINE_MEAS_SYNC::LID:
+    {
+        // Sync records sent before this subscription are lost, send new ones
+        m_state.ecg.clock.resync();
+        for (auto& imu : m_state.imu)
+            imu.clock.resync();
+        result = wb::HTTP_CODE_OK;
+        break;
+    }
     case WB_RES::LOCAL::OFFLINE_MEAS_ACC_SAMPLERATE::LID:
     {
         const auto& params = WB_RES::LOCAL::OFFLINE_MEAS_ACC_SAMPLERATE::SUBSCRIBE::ParameterListRef(parameters);
@@ -152,6 +285,33 @@ void OfflineMeasurements::onSubscribe(
             result = wb::HTTP_CODE_FORBIDDEN;
         break;
     }
+    case WB_RES::LOCAL::OFFLINE_MEAS_ACC_COMPRESSED_SAMPLERATE::LID:
+    {
+        const auto& params = WB_RES::LOCAL::OFFLINE_MEAS_ACC_COMPRESSED_SAMPLERATE::SUBSCRIBE::ParameterListRef(parameters);
+        if (subscribeAcc(lid, params.getSampleRate()))
+            result = wb::HTTP_CODE_OK;
+        else
+            result = wb::HTTP_CODE_FORBIDDEN;
+        break;
+    }
+    case WB_RES::LOCAL::OFFLINE_MEAS_ACC_COMPACT_SAMPLERATE::LID:
+    {
+        const auto& params = WB_RES::LOCAL::OFFLINE_MEAS_ACC_COMPACT_SAMPLERATE::SUBSCRIBE::ParameterListRef(parameters);
+        if (subscribeAcc(lid, params.getSampleRate()))
+            result = wb::HTTP_CODE_OK;
+        else
+            result = wb::HTTP_CODE_FORBIDDEN;
+        break;
+    }
+    case WB_RES::LOCAL::OFFLINE_MEAS_ACC_IMPLICIT_SAMPLERATE::LID:
+    {
+        const auto& params = WB_RES::LOCAL::OFFLINE_MEAS_ACC_IMPLICIT_SAMPLERATE::SUBSCRIBE::ParameterListRef(parameters);
+        if (subscribeAcc(lid, params.getSampleRate()))
+            result = wb::HTTP_CODE_OK;
+        else
+            result = wb::HTTP_CODE_FORBIDDEN;
+        break;
+    }
     case WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_INTERVAL::LID:
     {
         const auto& params = WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_INTERVAL::SUBSCRIBE::ParameterListRef(parameters);
@@ -161,6 +321,15 @@ void OfflineMeasurements::onSubscribe(
             result = wb::HTTP_CODE_FORBIDDEN;
         break;
     }
+    case WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_COMPRESSED_INTERVAL::LID:
+    {
+        const auto& params = WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_COMPRESSED_INTERVAL::SUBSCRIBE::ParameterListRef(parameters);
+        if (subscribeAcc(lid, params.getInterval()))
+            result = wb::HTTP_CODE_OK;
+        else
+            result = wb::HTTP_CODE_FORBIDDEN;
+        break;
+    }
     case WB_RES::LOCAL::OFFLINE_MEAS_GYRO_SAMPLERATE::LID:
     {
         const auto& params = WB_RES::LOCAL::OFFLINE_MEAS_GYRO_SAMPLERATE::SUBSCRIBE::ParameterListRef(parameters);
@@ -170,6 +339,33 @@ void OfflineMeasurements::onSubscribe(
             result = wb::HTTP_CODE_FORBIDDEN;
         break;
     }
+    case WB_RES::LOCAL::OFFLINE_MEAS_GYRO_COMPRESSED_SAMPLERATE::LID:
+    {
+        const auto& params = WB_RES::LOCAL::OFFLINE_MEAS_GYRO_COMPRESSED_SAMPLERATE::SUBSCRIBE::ParameterListRef(parameters);
+        if (subscribeGyro(lid, params.getSampleRate()))
+            result = wb::HTTP_CODE_OK;
+        else
+            result = wb::HTTP_CODE_FORBIDDEN;
+        break;
+    }
+    case WB_RES::LOCAL::OFFLINE_MEAS_GYRO_COMPACT_SAMPLERATE::LID:
+    {
+        const auto& params = WB_RES::LOCAL::OFFLINE_MEAS_GYRO_COMPACT_SAMPLERATE::SUBSCRIBE::ParameterListRef(parameters);
+        if (subscribeGyro(lid, params.getSampleRate()))
+            result = wb::HTTP_CODE_OK;
+        else
+            result = wb::HTTP_CODE_FORBIDDEN;
+        break;
+    }
+    case WB_RES::LOCAL::OFFLINE_MEAS_GYRO_IMPLICIT_SAMPLERATE::LID:
+    {
+        const auto& params = WB_RES::LOCAL::OFFLINE_MEAS_GYRO_IMPLICIT_SAMPLERATE::SUBSCRIBE::ParameterListRef(parameters);
+        if (subscribeGyro(lid, params.getSampleRate()))
+            result = wb::HTTP_CODE_OK;
+        else
+            result = wb::HTTP_CODE_FORBIDDEN;
+        break;
+    }
     case WB_RES::LOCAL::OFFLINE_MEAS_MAGN_SAMPLERATE::LID:
     {
         const auto& params = WB_RES::LOCAL::OFFLINE_MEAS_MAGN_SAMPLERATE::SUBSCRIBE::ParameterListRef(parameters);
@@ -179,8 +375,28 @@ void OfflineMeasurements::onSubscribe(
             result = wb::HTTP_CODE_FORBIDDEN;
         break;
     }
+    case WB_RES::LOCAL::OFFLINE_MEAS_MAGN_COMPRESSED_SAMPLERATE::LID:
+    {
+        const auto& params = WB_RES::LOCAL::OFFLINE_MEAS_MAGN_COMPRESSED_SAMPLERATE::SUBSCRIBE::ParameterListRef(parameters);
+        if (subscribeMagn(lid, params.getSampleRate()))
+            result = wb::HTTP_CODE_OK;
+        else
+            result = wb::HTTP_CODE_FORBIDDEN;
+        break;
+    }
+    case WB_RES::LOCAL::OFFLINE_MEAS_MAGN_IMPLICIT_SAMPLERATE::LID:
+    {
+        const auto& params = WB_RES::LOCAL::OFFLINE_MEAS_MAGN_IMPLICIT_SAMPLERATE::SUBSCRIBE::ParameterListRef(parameters);
+        if (subscribeMagn(lid, params.getSampleRate()))
+            result = wb::HTTP_CODE_OK;
+        else
+            result = wb::HTTP_CODE_FORBIDDEN;
+        break;
+    }
     case WB_RES::LOCAL::OFFLINE_MEAS_HR::LID:
+    case WB_RES::LOCAL::OFFLINE_MEAS_HR_COMPRESSED::LID:
     case WB_RES::LOCAL::OFFLINE_MEAS_RR::LID:
+    case WB_RES::LOCAL::OFFLINE_MEAS_RR_COMPRESSED::LID:
     {
         if (subscribeHR(lid))
             result = wb::HTTP_CODE_OK;
@@ -206,7 +422,17 @@ void OfflineMeasurements::onSubscribe(
             result = wb::HTTP_CODE_FORBIDDEN;
         break;
     }
+    case WB_RES::LOCAL::OFFLINE_MEAS_ECG_IMPLICIT_SAMPLERATE::LID:
+    {
+        const auto& params = WB_RES::LOCAL::OFFLINE_MEAS_ECG_IMPLICIT_SAMPLERATE::SUBSCRIBE::ParameterListRef(parameters);
+        if (subscribeECG(lid, params.getSampleRate()))
+            result = wb::HTTP_CODE_OK;
+        else
+            result = wb::HTTP_CODE_FORBIDDEN;
+        break;
+    }
     case WB_RES::LOCAL::OFFLINE_MEAS_TEMP::LID:
+    case WB_RES::LOCAL::OFFLINE_MEAS_TEMP_COMPRESSED::LID:
     {
         if (subscribeTemp(lid))
             result = wb::HTTP_CODE_OK;
@@ -221,6 +447,7 @@ void OfflineMeasurements::onSubscribe(
     }
     }
 
+    updateFlushTimer();
     returnResult(request, result);
 }
 
@@ -239,35 +466,50 @@ void OfflineMeasurements::onUnsubscribe(
 
     switch (lid)
     {
+    case WB_RES::LOCAL::OFFLINE_MEAS_SYNC::LID:
+        break;
     case WB_RES::LOCAL::OFFLINE_MEAS_ACC_SAMPLERATE::LID:
+    case WB_RES::LOCAL::OFFLINE_MEAS_ACC_COMPRESSED_SAMPLERATE::LID:
+    case WB_RES::LOCAL::OFFLINE_MEAS_ACC_COMPACT_SAMPLERATE::LID:
+    case WB_RES::LOCAL::OFFLINE_MEAS_ACC_IMPLICIT_SAMPLERATE::LID:
     case WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_INTERVAL::LID:
+    case WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_COMPRESSED_INTERVAL::LID:
     {
         dropAccSubscription(lid);
         break;
     }
     case WB_RES::LOCAL::OFFLINE_MEAS_GYRO_SAMPLERATE::LID:
+    case WB_RES::LOCAL::OFFLINE_MEAS_GYRO_COMPRESSED_SAMPLERATE::LID:
+    case WB_RES::LOCAL::OFFLINE_MEAS_GYRO_COMPACT_SAMPLERATE::LID:
+    case WB_RES::LOCAL::OFFLINE_MEAS_GYRO_IMPLICIT_SAMPLERATE::LID:
     {
         dropGyroSubscription(lid);
         break;
     }
     case WB_RES::LOCAL::OFFLINE_MEAS_MAGN_SAMPLERATE::LID:
+    case WB_RES::LOCAL::OFFLINE_MEAS_MAGN_COMPRESSED_SAMPLERATE::LID:
+    case WB_RES::LOCAL::OFFLINE_MEAS_MAGN_IMPLICIT_SAMPLERATE::LID:
     {
         dropMagnSubscription(lid);
         break;
     }
     case WB_RES::LOCAL::OFFLINE_MEAS_HR::LID:
+    case WB_RES::LOCAL::OFFLINE_MEAS_HR_COMPRESSED::LID:
     case WB_RES::LOCAL::OFFLINE_MEAS_RR::LID:
+    case WB_RES::LOCAL::OFFLINE_MEAS_RR_COMPRESSED::LID:
     {
         dropHRSubscription(lid);
         break;
     }
     case WB_RES::LOCAL::OFFLINE_MEAS_ECG_SAMPLERATE::LID:
     case WB_RES::LOCAL::OFFLINE_MEAS_ECG_COMPRESSED_SAMPLERATE::LID:
+    case WB_RES::LOCAL::OFFLINE_MEAS_ECG_IMPLICIT_SAMPLERATE::LID:
     {
         dropECGSubscription(lid);
         break;
     }
     case WB_RES::LOCAL::OFFLINE_MEAS_TEMP::LID:
+    case WB_RES::LOCAL::OFFLINE_MEAS_TEMP_COMPRESSED::LID:
     {
         dropTempSubscription(lid);
         break;
@@ -279,6 +521,7 @@ void OfflineMeasurements::onUnsubscribe(
     }
     }
 
+    updateFlushTimer();
     returnResult(request, wb::HTTP_CODE_OK);
 }
 
@@ -298,7 +541,6 @@ void OfflineMeasurements::onSubscribeResult(
     {
     case WB_RES::LOCAL::MEAS_ECG_REQUIREDSAMPLERATE::LID:
     case WB_RES::LOCAL::MEAS_HR::LID:
-    case WB_RES::LOCAL::MEAS_ACC_SAMPLERATE::LID:
     case WB_RES::LOCAL::MEAS_GYRO_SAMPLERATE::LID:
     case WB_RES::LOCAL::MEAS_MAGN_SAMPLERATE::LID:
     case WB_RES::LOCAL::MEAS_TEMP::LID:
@@ -352,31 +594,24 @@ void OfflineMeasurements::onNotify(
         if (m_state.subscribers[WB_RES::OfflineMeasurement::HR])
             recordHRAverages(data);
         if (m_state.subscribers[WB_RES::OfflineMeasurement::RR])
-            recordRRIntervals(data);
-        break;
-    }
-    case WB_RES::LOCAL::MEAS_ACC_SAMPLERATE::LID:
-    {
-        auto data = value.convertTo<const WB_RES::AccData&>();
-
-        if (m_state.subscribers[WB_RES::OfflineMeasurement::ACC])
-            recordAccelerationSamples(data);
-
-        if (m_state.subscribers[WB_RES::OfflineMeasurement::ACTIVITY])
-            recordActivity(data);
-
+        {
+            if (m_options.useRRCompression)
+                compressRRIntervals(data);
+            else
+                recordRRIntervals(data);
+        }
         break;
     }
     case WB_RES::LOCAL::MEAS_GYRO_SAMPLERATE::LID:
     {
         auto data = value.convertTo<const WB_RES::GyroData&>();
-        recordGyroscopeSamples(data);
+        recordGyroSamples(data);
         break;
     }
     case WB_RES::LOCAL::MEAS_MAGN_SAMPLERATE::LID:
     {
         auto data = value.convertTo<const WB_RES::MagnData&>();
-        recordMagnetometerSamples(data);
+        recordMagnSamples(data);
         break;
     }
     case WB_RES::LOCAL::MEAS_TEMP::LID:
@@ -392,43 +627,63 @@ void OfflineMeasurements::onNotify(
     }
 }
 
+void OfflineMeasurements::onTimer(wb::TimerId timerId)
+{
+    if (timerId == m_flushTimer)
+        expireBlocks(WbTimestampGet());
+}
+
 bool OfflineMeasurements::subscribeAcc(wb::LocalResourceId resourceId, int32_t param)
 {
-    uint16_t currentSampleRate = getAccSampleRate();
+    SensorHub* hub = SensorHub::instance();
+    if (hub == nullptr)
+        return false;
 
-    if (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACC_SAMPLERATE::LID)
+    if (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACC_SAMPLERATE::LID ||
+        resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACC_COMPRESSED_SAMPLERATE::LID ||
+        resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACC_COMPACT_SAMPLERATE::LID ||
+        resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACC_IMPLICIT_SAMPLERATE::LID)
     {
         if (m_state.subscribers[WB_RES::OfflineMeasurement::ACC] > 0)
-            return false; // Only one subscriber allowed at a time            
+            return joinSubscription(WB_RES::OfflineMeasurement::ACC, resourceId, param);
+
+        const bool compact = (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACC_COMPACT_SAMPLERATE::LID);
+        if (compact && m_options.accRange == 0)
+            return false; // Compact format depends on the range
+
+        // The hub sets the range, and restores the one of the sensor when no consumer needs it
+        const uint16_t sampleRate = param > 0 ? param : DEFAULT_ACC_SAMPLE_RATE;
+        if (!hub->subscribeAcc(m_accConsumer, sampleRate, m_options.accRange))
+            return false;
 
-        m_state.subscribers[WB_RES::OfflineMeasurement::ACC] += 1;
         m_state.params[WB_RES::OfflineMeasurement::ACC] = param;
+        m_state.subscribers[WB_RES::OfflineMeasurement::ACC] += 1;
+        m_state.resources[WB_RES::OfflineMeasurement::ACC] = resourceId;
+
+        const size_t channel = imu_channel(WB_RES::OfflineMeasurement::ACC);
+        m_options.useImuCompression[channel] = (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACC_COMPRESSED_SAMPLERATE::LID);
+        m_options.useImuCompact[channel] = compact;
+        m_options.useImuImplicit[channel] = (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACC_IMPLICIT_SAMPLERATE::LID);
+        setupIMUChannel(WB_RES::OfflineMeasurement::ACC, m_options.accRange * STANDARD_GRAVITY, 24, 12);
     }
-    else if (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_INTERVAL::LID)
+    else if (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_INTERVAL::LID ||
+        resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_COMPRESSED_INTERVAL::LID)
     {
         if (m_state.subscribers[WB_RES::OfflineMeasurement::ACTIVITY] > 0)
-            return false; // Only one subscriber allowed at a time    
+            return joinSubscription(WB_RES::OfflineMeasurement::ACTIVITY, resourceId, param);
+
+        if (!hub->subscribeAcc(m_activityConsumer, DEFAULT_ACC_SAMPLE_RATE))
+            return false;
 
         m_state.subscribers[WB_RES::OfflineMeasurement::ACTIVITY] += 1;
         m_state.params[WB_RES::OfflineMeasurement::ACTIVITY] = param;
+        m_state.resources[WB_RES::OfflineMeasurement::ACTIVITY] = resourceId;
         m_state.activity.reset();
-    }
-
-    uint16_t requiredSampleRate = getAccSampleRate();
-
-    if (currentSampleRate != requiredSampleRate)
-    {
-        if (currentSampleRate > 0)
-        {
-            asyncUnsubscribe(
-                WB_RES::LOCAL::MEAS_ACC_SAMPLERATE(),
-                AsyncRequestOptions::Empty, currentSampleRate);
-        }
-
-        DebugLogger::info("%s: Subscribing to /Meas/Acc/%u", LAUNCHABLE_NAME, requiredSampleRate);
-        asyncSubscribe(
-            WB_RES::LOCAL::MEAS_ACC_SAMPLERATE(),
-            AsyncRequestOptions::Empty, requiredSampleRate);
+        m_state.activity.deadband.configure(m_options.activityHysteresis,
+            m_options.slowMinInterval * 1000, m_options.slowHeartbeat * 1000);
+        m_options.useActivityCompression = (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_COMPRESSED_INTERVAL::LID);
+        m_state.activity.compressor.set_format(16, false);
+        m_state.activity.compressor.set_max_age(m_options.slowBlockAge * 1000);
     }
 
     return true;
@@ -438,13 +693,31 @@ bool OfflineMeasurements::subscribeGyro(wb::LocalResourceId resourceId, int32_t
 {
     auto& subscribers = m_state.subscribers[WB_RES::OfflineMeasurement::GYRO];
     if (subscribers > 0)
-        return false; // Only one subscriber allowed at a time
+        return joinSubscription(WB_RES::OfflineMeasurement::GYRO, resourceId, param);
+
+    const bool compact = (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_GYRO_COMPACT_SAMPLERATE::LID);
+    if (compact && m_options.gyroRange == 0)
+        return false; // Compact format depends on the range
 
     subscribers += 1;
     m_state.params[WB_RES::OfflineMeasurement::GYRO] = param;
+    m_state.resources[WB_RES::OfflineMeasurement::GYRO] = resourceId;
+
+    const size_t channel = imu_channel(WB_RES::OfflineMeasurement::GYRO);
+    m_options.useImuCompression[channel] = (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_GYRO_COMPRESSED_SAMPLERATE::LID);
+    m_options.useImuCompact[channel] = compact;
+    m_options.useImuImplicit[channel] = (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_GYRO_IMPLICIT_SAMPLERATE::LID);
+    setupIMUChannel(WB_RES::OfflineMeasurement::GYRO, m_options.gyroRange, 24, 12);
 
     if (subscribers == 1)
     {
+        if (m_options.gyroRange > 0)
+        {
+            WB_RES::GyroConfig gyroConfig = {};
+            gyroConfig.dPSRange = m_options.gyroRange;
+            asyncPut(WB_RES::LOCAL::MEAS_GYRO_CONFIG(), AsyncRequestOptions::Empty, gyroConfig);
+        }
+
         DebugLogger::info("%s: Subscribing to /Meas/Gyro/%u", LAUNCHABLE_NAME, param);
         asyncSubscribe(
             WB_RES::LOCAL::MEAS_GYRO_SAMPLERATE(), AsyncRequestOptions::Empty, param);
@@ -457,10 +730,16 @@ bool OfflineMeasurements::subscribeMagn(wb::LocalResourceId resourceId, int32_t
 {
     auto& subscribers = m_state.subscribers[WB_RES::OfflineMeasurement::MAGN];
     if (subscribers > 0)
-        return false; // Only one subscriber allowed at a time
+        return joinSubscription(WB_RES::OfflineMeasurement::MAGN, resourceId, param);
 
     subscribers += 1;
     m_state.params[WB_RES::OfflineMeasurement::MAGN] = param;
+    m_state.resources[WB_RES::OfflineMeasurement::MAGN] = resourceId;
+
+    const size_t channel = imu_channel(WB_RES::OfflineMeasurement::MAGN);
+    m_options.useImuCompression[channel] = (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_MAGN_COMPRESSED_SAMPLERATE::LID);
+    m_options.useImuImplicit[channel] = (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_MAGN_IMPLICIT_SAMPLERATE::LID);
+    setupIMUChannel(WB_RES::OfflineMeasurement::MAGN, 0, 16, 6); // Q10.6 is already 16 bits
 
     if (subscribers == 1)
     {
@@ -477,15 +756,33 @@ bool OfflineMeasurements::subscribeHR(wb::LocalResourceId resourceId)
     auto& hrSubs = m_state.subscribers[WB_RES::OfflineMeasurement::HR];
     auto& rrSubs = m_state.subscribers[WB_RES::OfflineMeasurement::RR];
 
-    if (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_HR::LID)
+    if (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_HR::LID ||
+        resourceId == WB_RES::LOCAL::OFFLINE_MEAS_HR_COMPRESSED::LID)
     {
+        if (hrSubs > 0)
+            return joinSubscription(WB_RES::OfflineMeasurement::HR, resourceId, 0);
+
+        m_state.params[WB_RES::OfflineMeasurement::HR] = 0;
+        m_state.resources[WB_RES::OfflineMeasurement::HR] = resourceId;
         m_state.hr.reset();
+        m_state.hr.deadband.configure(m_options.hrHysteresis,
+            m_options.slowMinInterval * 1000, m_options.slowHeartbeat * 1000);
+        m_options.useHRCompression = (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_HR_COMPRESSED::LID);
+        m_state.hr.compressor.set_format(8, false);
+        m_state.hr.compressor.set_max_age(m_options.slowBlockAge * 1000);
         hrSubs += 1;
     }
 
-    if (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_RR::LID)
+    if (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_RR::LID ||
+        resourceId == WB_RES::LOCAL::OFFLINE_MEAS_RR_COMPRESSED::LID)
     {
+        if (rrSubs > 0)
+            return joinSubscription(WB_RES::OfflineMeasurement::RR, resourceId, 0);
+
+        m_state.params[WB_RES::OfflineMeasurement::RR] = 0;
+        m_state.resources[WB_RES::OfflineMeasurement::RR] = resourceId;
         m_state.r_to_r.reset();
+        m_options.useRRCompression = (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_RR_COMPRESSED::LID);
         rrSubs += 1;
     }
 
@@ -502,15 +799,44 @@ bool OfflineMeasurements::subscribeECG(wb::LocalResourceId resourceId, int32_t p
 {
     auto& subscribers = m_state.subscribers[WB_RES::OfflineMeasurement::ECG];
     if (subscribers > 0)
-        return false; // Allow only one subscriber
+        return joinSubscription(WB_RES::OfflineMeasurement::ECG, resourceId, param);
 
     subscribers += 1;
     m_state.params[WB_RES::OfflineMeasurement::ECG] = param;
+    m_state.resources[WB_RES::OfflineMeasurement::ECG] = resourceId;
     m_options.useEcgCompression = (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ECG_COMPRESSED_SAMPLERATE::LID);
+    m_options.useEcgImplicit = (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ECG_IMPLICIT_SAMPLERATE::LID);
 
     if (subscribers == 1)
     {
         m_state.ecg.reset();
+        m_state.ecg.clock.configure(m_options.syncInterval * 1000);
+        m_state.ecg.batch.configure(sizeof(int16_t), m_options.batchBytes, m_options.batchLatency);
+        if (m_options.ecgCompression == WB_RES::OfflineECGCompression::WAVELET)
+        {
+            m_state.ecg.wavelet.set_block_size(m_options.ecgBlockSize);
+            m_state.ecg.wavelet.set_bit_depth(m_options.ecgBitDepth);
+            m_state.ecg.wavelet.set_threshold(m_options.ecgWaveletThreshold);
+        }
+        else
+        {
+            m_state.ecg.compressor.set_coding(m_options.ecgCompression == WB_RES::OfflineECGCompression::ADAPTIVE
+                    ? ECGCoding::Adaptive
+                    : static_cast<ECGCoding>(m_options.ecgCompression));
+            if (m_options.ecgPredictor == WB_RES::OfflineECGPredictor::BEATTEMPLATE)
+            {
+                m_state.ecg.compressor.set_predictor(ECGPredictor::FirstOrder);
+                m_state.ecg.compressor.set_beat_template(&m_state.ecg.beatTemplate);
+            }
+            else
+            {
+                m_state.ecg.compressor.set_predictor(static_cast<ECGPredictor>(m_options.ecgPredictor));
+                m_state.ecg.compressor.set_beat_template(nullptr);
+            }
+            m_state.ecg.compressor.set_block_size(m_options.ecgBlockSize);
+            m_state.ecg.compressor.set_bit_depth(m_options.ecgBitDepth);
+            m_state.ecg.compressor.set_max_error(m_options.ecgMaxError);
+        }
 
         DebugLogger::info("%s: Subscribing to /Meas/ECG/%u", LAUNCHABLE_NAME, param);
         asyncSubscribe(
@@ -522,57 +848,59 @@ bool OfflineMeasurements::subscribeECG(wb::LocalResourceId resourceId, int32_t p
 bool OfflineMeasurements::subscribeTemp(wb::LocalResourceId resourceId)
 {
     auto& subscribers = m_state.subscribers[WB_RES::OfflineMeasurement::TEMP];
-    subscribers += 1;
-
-    if (subscribers == 1)
-    {
-        DebugLogger::info("%s: Subscribing to /Meas/Temp", LAUNCHABLE_NAME);
-        asyncSubscribe(WB_RES::LOCAL::MEAS_TEMP(), AsyncRequestOptions::Empty);
-    }
+    if (subscribers > 0)
+        return joinSubscription(WB_RES::OfflineMeasurement::TEMP, resourceId, 0);
 
+    subscribers += 1;
+    m_state.params[WB_RES::OfflineMeasurement::TEMP] = 0;
+    m_state.resources[WB_RES::OfflineMeasurement::TEMP] = resourceId;
     m_state.temperature.reset();
-
+    m_state.temperature.deadband.configure(m_options.tempHysteresis,
+        m_options.slowMinInterval * 1000, m_options.slowHeartbeat * 1000);
+    m_options.useTempCompression = (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_TEMP_COMPRESSED::LID);
+    m_state.temperature.compressor.set_format(8, true);
+    m_state.temperature.compressor.set_max_age(m_options.slowBlockAge * 1000);
+
+    DebugLogger::info("%s: Subscribing to /Meas/Temp", LAUNCHABLE_NAME);
+    asyncSubscribe(WB_RES::LOCAL::MEAS_TEMP(), AsyncRequestOptions::Empty);
     return true;
 }
 
 void OfflineMeasurements::dropAccSubscription(wb::LocalResourceId resourceId)
 {
+    SensorHub* hub = SensorHub::instance();
     auto& accSubs = m_state.subscribers[WB_RES::OfflineMeasurement::ACC];
     auto& activitySubs = m_state.subscribers[WB_RES::OfflineMeasurement::ACTIVITY];
 
-    uint16_t currentSampleRate = getAccSampleRate();
+    if ((resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACC_SAMPLERATE::LID ||
+        resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACC_COMPRESSED_SAMPLERATE::LID ||
+        resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACC_COMPACT_SAMPLERATE::LID ||
+        resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACC_IMPLICIT_SAMPLERATE::LID) && accSubs > 0)
+    {
+        if (accSubs == 1)
+            flushMeasurement(WB_RES::OfflineMeasurement::ACC);
 
-    if (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACC_SAMPLERATE::LID && accSubs > 0)
         accSubs -= 1;
-    else if (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_INTERVAL::LID && activitySubs > 0)
-        activitySubs -= 1;
-
-    uint16_t requiredSampleRate = getAccSampleRate();
-
-    if (currentSampleRate != requiredSampleRate)
+        if (accSubs == 0 && hub != nullptr)
+            hub->unsubscribeAcc(m_accConsumer);
+    }
+    else if ((resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_INTERVAL::LID ||
+        resourceId == WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_COMPRESSED_INTERVAL::LID) && activitySubs > 0)
     {
-        DebugLogger::info("%s: Changing acc samplerate %u -> %u",
-            LAUNCHABLE_NAME, currentSampleRate, requiredSampleRate);
-
-        if (currentSampleRate > 0)
-        {
-            asyncUnsubscribe(
-                WB_RES::LOCAL::MEAS_ACC_SAMPLERATE(), AsyncRequestOptions::Empty,
-                currentSampleRate);
-        }
+        if (activitySubs == 1)
+            flushMeasurement(WB_RES::OfflineMeasurement::ACTIVITY);
 
-        if (requiredSampleRate)
-        {
-            asyncSubscribe(
-                WB_RES::LOCAL::MEAS_ACC_SAMPLERATE(), AsyncRequestOptions::Empty,
-                requiredSampleRate);
-        }
+        activitySubs -= 1;
+        if (activitySubs == 0 && hub != nullptr)
+            hub->unsubscribeAcc(m_activityConsumer);
     }
 }
 
 void OfflineMeasurements::dropGyroSubscription(wb::LocalResourceId resourceId)
 {
     auto& subscribers = m_state.subscribers[WB_RES::OfflineMeasurement::GYRO];
+    if (subscribers == 1)
+        flushMeasurement(WB_RES::OfflineMeasurement::GYRO);
     subscribers -= 1;
 
     if (subscribers == 0)
@@ -588,6 +916,8 @@ void OfflineMeasurements::dropGyroSubscription(wb::LocalResourceId resourceId)
 void OfflineMeasurements::dropMagnSubscription(wb::LocalResourceId resourceId)
 {
     auto& subscribers = m_state.subscribers[WB_RES::OfflineMeasurement::MAGN];
+    if (subscribers == 1)
+        flushMeasurement(WB_RES::OfflineMeasurement::MAGN);
     subscribers -= 1;
 
     if (subscribers == 0)
@@ -606,11 +936,21 @@ void OfflineMeasurements::dropHRSubscription(wb::LocalResourceId resourceId)
     auto& hrSubs = m_state.subscribers[WB_RES::OfflineMeasurement::HR];
     auto& rrSubs = m_state.subscribers[WB_RES::OfflineMeasurement::RR];
 
-    if (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_HR::LID && hrSubs > 0)
+    if ((resourceId == WB_RES::LOCAL::OFFLINE_MEAS_HR::LID ||
+        resourceId == WB_RES::LOCAL::OFFLINE_MEAS_HR_COMPRESSED::LID) && hrSubs > 0)
+    {
+        if (hrSubs == 1)
+            flushMeasurement(WB_RES::OfflineMeasurement::HR);
         hrSubs -= 1;
+    }
 
-    if (resourceId == WB_RES::LOCAL::OFFLINE_MEAS_RR::LID && rrSubs > 0)
+    if ((resourceId == WB_RES::LOCAL::OFFLINE_MEAS_RR::LID ||
+        resourceId == WB_RES::LOCAL::OFFLINE_MEAS_RR_COMPRESSED::LID) && rrSubs > 0)
+    {
+        if (rrSubs == 1)
+            flushMeasurement(WB_RES::OfflineMeasurement::RR);
         rrSubs -= 1;
+    }
 
     if (hrSubs == 0 && rrSubs == 0)
     {
@@ -622,6 +962,8 @@ void OfflineMeasurements::dropHRSubscription(wb::LocalResourceId resourceId)
 void OfflineMeasurements::dropECGSubscription(wb::LocalResourceId resourceId)
 {
     auto& subscribers = m_state.subscribers[WB_RES::OfflineMeasurement::ECG];
+    if (subscribers == 1)
+        flushMeasurement(WB_RES::OfflineMeasurement::ECG);
     subscribers -= 1;
 
     if (subscribers == 0)
@@ -637,6 +979,8 @@ void OfflineMeasurements::dropECGSubscription(wb::LocalResourceId resourceId)
 void OfflineMeasurements::dropTempSubscription(wb::LocalResourceId resourceId)
 {
     auto& subscribers = m_state.subscribers[WB_RES::OfflineMeasurement::TEMP];
+    if (subscribers == 1)
+        flushMeasurement(WB_RES::OfflineMeasurement::TEMP);
     subscribers -= 1;
 
     if (subscribers == 0)
@@ -646,6 +990,35 @@ void OfflineMeasurements::dropTempSubscription(wb::LocalResourceId resourceId)
     }
 }
 
+bool OfflineMeasurements::joinSubscription(WB_RES::OfflineMeasurement::Type measurement,
+    wb::LocalResourceId resourceId, int32_t param)
+{
+    // The samples are recorded once for all subscribers, so the format and the parameter have to match
+    if (resourceId != m_state.resources[measurement] || param != m_state.params[measurement])
+        return false;
+
+    m_state.subscribers[measurement] += 1;
+    return true;
+}
+
+void OfflineMeasurements::syncSamples(WB_RES::OfflineMeasurement::Type measurement, offline_meas::SampleClock& clock,
+    uint32_t timestamp, size_t count)
+{
+    uint16_t sampleRate = measurement == WB_RES::OfflineMeasurement::ACC
+        ? getAccSampleRate()
+        : m_state.params[measurement];
+
+    if (!clock.update(timestamp, count, sampleRate))
+        return;
+
+    WB_RES::OfflineSyncData sync;
+    sync.channel = measurement;
+    sync.timestamp = timestamp;
+    sync.sampleIndex = clock.sample_index();
+    sync.sampleRate = sampleRate;
+    updateResource(WB_RES::LOCAL::OFFLINE_MEAS_SYNC(), ResponseOptions::ForceAsync, sync);
+}
+
 void OfflineMeasurements::recordECGSamples(const WB_RES::ECGData& data)
 {
     // ECG Samples: 18 bits in registers
@@ -660,68 +1033,141 @@ void OfflineMeasurements::recordECGSamples(const WB_RES::ECGData& data)
         buffer[i] = (data.samples[i] >> 2);
     }
 
-    WB_RES::OfflineECGData ecg;
-    ecg.timestamp = data.timestamp;
-    ecg.sampleData = wb::MakeArray(buffer, samples);
+    uint16_t sampleRate = m_state.params[WB_RES::OfflineMeasurement::ECG];
+    if (m_options.useEcgImplicit)
+        syncSamples(WB_RES::OfflineMeasurement::ECG, m_state.ecg.clock, data.timestamp, samples);
 
+    auto onWrite = [this](const uint8_t* batch, size_t count, uint32_t timestamp) {
+        writeECGBatch(batch, count, timestamp);
+        };
+    m_state.ecg.batch.append(buffer, samples, data.timestamp, sampleRate, onWrite);
+}
+
+void OfflineMeasurements::writeECGBatch(const uint8_t* batch, size_t count, uint32_t timestamp)
+{
+    if (m_options.useEcgImplicit)
+    {
+        WB_RES::OfflineECGImplicitData ecg;
+        ecg.sampleData = wb::MakeArray(reinterpret_cast<const int16_t*>(batch), count);
+        updateResource(WB_RES::LOCAL::OFFLINE_MEAS_ECG_IMPLICIT_SAMPLERATE(), ResponseOptions::ForceAsync, ecg);
+        return;
+    }
+
+    WB_RES::OfflineECGData ecg;
+    ecg.timestamp = timestamp;
+    ecg.sampleData = wb::MakeArray(reinterpret_cast<const int16_t*>(batch), count);
     updateResource(WB_RES::LOCAL::OFFLINE_MEAS_ECG_SAMPLERATE(), ResponseOptions::ForceAsync, ecg);
 }
 
 void OfflineMeasurements::compressECGSamples(const WB_RES::ECGData& data)
 {
-    static int16_t buffer[16];
+    static int32_t buffer[16];
     size_t samples = data.samples.size();
     ASSERT(samples <= 16);
-    for (size_t i = 0; i < samples; i++)
+    if (m_options.ecgBitDepth == 18)
+    {
+        // Lossless, the samples are stored with the full 18-bit resolution
+        for (size_t i = 0; i < samples; i++)
+        {
+            buffer[i] = CLAMP(data.samples[i], ECG_SAMPLE_MIN_18BIT, ECG_SAMPLE_MAX_18BIT);
+        }
+    }
+    else
     {
-        buffer[i] = (data.samples[i] >> 2); // Discard 2 LSBs
+        for (size_t i = 0; i < samples; i++)
+        {
+            buffer[i] = static_cast<int16_t>(data.samples[i] >> 2); // Discard 2 LSBs
+        }
     }
 
-    if (!m_state.ecg.block_timestamp) // init timestamp
-        m_state.ecg.block_timestamp = data.timestamp;
+    if (m_options.ecgCompression == WB_RES::OfflineECGCompression::WAVELET)
+        packECGSamples(m_state.ecg.wavelet, buffer, samples, data.timestamp);
+    else
+        packECGSamples(m_state.ecg.compressor, buffer, samples, data.timestamp);
+}
 
+template<typename TCompressor>
+void OfflineMeasurements::packECGSamples(TCompressor& compressor, const int32_t* samples, size_t count, uint32_t timestamp)
+{
     uint16_t sampleRate = m_state.params[WB_RES::OfflineMeasurement::ECG];
-    float interval = 1000.0f / sampleRate;
-
-    // Callback to write blocks as they get completed
-    static auto onWrite = [&](uint8_t block[State::ECG::COMPRESSOR_BLOCK_SIZE]) {
-        WB_RES::OfflineECGCompressedData ecg;
-        ecg.timestamp = m_state.ecg.block_timestamp;
-        ecg.bytes = wb::MakeArray(block, State::ECG::COMPRESSOR_BLOCK_SIZE);
-        updateResource(WB_RES::LOCAL::OFFLINE_MEAS_ECG_COMPRESSED_SAMPLERATE(), ResponseOptions::ForceAsync, ecg);
 
-        m_state.ecg.block_timestamp += block[0] * interval;
+    // Sink for blocks as they get completed, resolved at compile time
+    auto onWrite = [this, &compressor](uint8_t* block, size_t size) {
+        writeCompressedECGBlock(block, size, compressor.block_samples());
         };
 
-    // Check that timestamp is more or less accurate
-    if (m_state.ecg.block_timestamp)
+    if (m_state.ecg.stream_samples == 0) // init timestamp
+        m_state.ecg.stream_timestamp = timestamp;
+
+    // Check that timestamp is more or less accurate. Blocks span several
+    // notifications, so compare with the expected timestamp of the next sample.
+    int32_t diff = timestamp - m_state.ecg.sample_timestamp(m_state.ecg.stream_samples, sampleRate);
+    int32_t maxDiff = (count * 1000 / 2) / sampleRate;
+    if (diff > maxDiff || diff < -maxDiff)
     {
-        // figure out if there was a pause
-        int32_t diff = data.timestamp - m_state.ecg.block_timestamp;
-        int maxDiff = ceil(16 * interval);
-        if (diff > maxDiff)
-        {
-            // Loss of data?
-            // Dump any buffered data and start new block
-            m_state.ecg.compressor.dump_buffer(onWrite);
-            m_state.ecg.block_timestamp = data.timestamp;
-        }
+        // Loss of data?
+        // Dump any buffered data and start new block
+        if (compressor.block_samples() > 0)
+            m_state.ecg.stats.gapBlocks++;
+        compressor.dump_buffer(onWrite);
+        m_state.ecg.stream_timestamp = timestamp;
+        m_state.ecg.stream_samples = 0;
+        m_state.ecg.block_first_sample = 0;
+    }
+    else
+    {
+        // Follow the timestamps, so that a real sample rate slightly off the
+        // nominal one does not add up to a gap. The sample indices stay.
+        m_state.ecg.stream_timestamp += diff;
     }
+    m_state.ecg.stream_samples += count;
 
-    size_t compressed = m_state.ecg.compressor.pack_continuous(wb::MakeArray(buffer), onWrite);
-    ASSERT(compressed == samples);
+    size_t compressed = compressor.pack_continuous(wb::MakeArray(samples, count), onWrite);
+    ASSERT(compressed == count);
+    m_state.ecg.stats.samples += count;
+    m_state.ecg.stats.add_residual(compressor.max_residual());
+}
+
+template<typename TCompressor>
+void OfflineMeasurements::flushECGSamples(TCompressor& compressor)
+{
+    auto onWrite = [this, &compressor](uint8_t* block, size_t size) {
+        writeCompressedECGBlock(block, size, compressor.block_samples());
+        };
+    compressor.dump_buffer(onWrite);
+}
+
+void OfflineMeasurements::writeCompressedECGBlock(uint8_t* block, size_t size, size_t samples)
+{
+    State::ECG& ecgState = m_state.ecg;
+    uint16_t sampleRate = m_state.params[WB_RES::OfflineMeasurement::ECG];
+
+    WB_RES::OfflineECGCompressedData ecg;
+    ecg.timestamp = ecgState.sample_timestamp(ecgState.block_first_sample, sampleRate);
+    ecg.bytes = wb::MakeArray(block, size);
+    updateResource(WB_RES::LOCAL::OFFLINE_MEAS_ECG_COMPRESSED_SAMPLERATE(), ResponseOptions::ForceAsync, ecg);
+
+    ecgState.block_first_sample += samples;
+    ecgState.stats.add_block(size);
 }
 
 void OfflineMeasurements::recordHRAverages(const WB_RES::HRData& data)
 {
     uint8_t average = static_cast<uint8_t>(roundf(data.average));
+    uint32_t timestamp = WbTimestampGet();
+
+    if (!m_state.hr.deadband.update(average, timestamp))
+        return;
 
-    if (m_state.hr.average != average)
+    if (m_options.useHRCompression)
+    {
+        compressSlowValue(WB_RES::LOCAL::OFFLINE_MEAS_HR_COMPRESSED(), m_state.hr.compressor,
+            m_state.hr.stats, average, timestamp);
         return;
-    m_state.hr.average = average;
+    }
 
     WB_RES::OfflineHRData hr;
-    hr.timestamp = WbTimestampGet();
+    hr.timestamp = timestamp;
     hr.average = average;
 
     updateResource(WB_RES::LOCAL::OFFLINE_MEAS_HR(), ResponseOptions::ForceAsync, hr);
@@ -730,26 +1176,27 @@ void OfflineMeasurements::recordHRAverages(const WB_RES::HRData& data)
 void OfflineMeasurements::recordRRIntervals(const WB_RES::HRData& data)
 {
     // RTOR samples: Bit-packed chunk of 12-bit values
-    // 8 x 12 bits = 96 bits = 8 bytes
+    // 8 x 12 bits = 96 bits = 12 bytes
     constexpr uint8_t sampleBits = 12;
-    constexpr uint8_t chunkSamples = 8;
-    constexpr uint8_t bufferSize = sampleBits * chunkSamples / 8;
-    static uint8_t buffer[bufferSize] = {};
+    constexpr uint8_t chunkSamples = State::RtoR::CHUNK_SAMPLES;
+    using Packer = BitPack<sampleBits, chunkSamples>;
+    static uint8_t buffer[Packer::BYTES] = {};
 
     for (size_t i = 0; i < data.rrData.size(); i++)
     {
         if (m_state.r_to_r.index == 0) // Update timestamp on first sample
             m_state.r_to_r.timestamp = WbTimestampGet();
 
-        uint16_t sample = data.rrData[i];
-        bit_pack::write<uint16_t, sampleBits, chunkSamples>(sample, buffer, m_state.r_to_r.index);
+        m_state.r_to_r.samples[m_state.r_to_r.index] = data.rrData[i];
         m_state.r_to_r.index += 1;
 
         if (m_state.r_to_r.index == chunkSamples)
         {
+            Packer::pack(m_state.r_to_r.samples, buffer);
+
             WB_RES::OfflineRRData rr;
             rr.timestamp = m_state.r_to_r.timestamp;
-            rr.intervalData = wb::MakeArray(buffer, bufferSize);
+            rr.intervalData = wb::MakeArray(buffer, Packer::BYTES);
 
             updateResource(WB_RES::LOCAL::OFFLINE_MEAS_RR(), ResponseOptions::ForceAsync, rr);
             m_state.r_to_r.index = 0;
@@ -757,24 +1204,90 @@ void OfflineMeasurements::recordRRIntervals(const WB_RES::HRData& data)
     }
 }
 
+void OfflineMeasurements::compressRRIntervals(const WB_RES::HRData& data)
+{
+    State::RtoR& rrState = m_state.r_to_r;
+    const size_t count = data.rrData.size();
+    if (count == 0)
+        return;
+
+    // Sink for blocks as they get completed, resolved at compile time
+    auto onWrite = [this](uint8_t* block, size_t size) {
+        writeCompressedRRBlock(block, size);
+        };
+
+    if (rrState.compressor.block_samples() == 0) // Update timestamp on first interval
+        rrState.timestamp = WbTimestampGet();
+
+    size_t compressed = rrState.compressor.pack_continuous(&data.rrData[0], count, onWrite);
+    ASSERT(compressed == count);
+    rrState.stats.samples += count;
+    rrState.stats.add_residual(rrState.compressor.max_residual());
+}
+
+void OfflineMeasurements::writeCompressedRRBlock(uint8_t* block, size_t size)
+{
+    State::RtoR& rrState = m_state.r_to_r;
+
+    WB_RES::OfflineRRCompressedData rr;
+    rr.timestamp = rrState.timestamp;
+    rr.bytes = wb::MakeArray(block, size);
+    updateResource(WB_RES::LOCAL::OFFLINE_MEAS_RR_COMPRESSED(), ResponseOptions::ForceAsync, rr);
+
+    // The interval that did not fit starts the next block, which gets the current time
+    rrState.stats.add_block(size);
+    rrState.timestamp = WbTimestampGet();
+}
+
+void OfflineMeasurements::recordAccSamples(const WB_RES::AccData& data)
+{
+    if (m_options.useImuCompression[imu_channel(WB_RES::OfflineMeasurement::ACC)])
+        compressIMUSamples(WB_RES::LOCAL::OFFLINE_MEAS_ACC_COMPRESSED_SAMPLERATE(),
+            WB_RES::OfflineMeasurement::ACC, data.arrayAcc, data.timestamp);
+    else if (m_options.useImuCompact[imu_channel(WB_RES::OfflineMeasurement::ACC)])
+        recordCompactIMUSamples(WB_RES::OfflineMeasurement::ACC, data.arrayAcc, data.timestamp);
+    else
+        recordAccelerationSamples(data);
+}
+
+void OfflineMeasurements::recordGyroSamples(const WB_RES::GyroData& data)
+{
+    if (m_options.useImuCompression[imu_channel(WB_RES::OfflineMeasurement::GYRO)])
+        compressIMUSamples(WB_RES::LOCAL::OFFLINE_MEAS_GYRO_COMPRESSED_SAMPLERATE(),
+            WB_RES::OfflineMeasurement::GYRO, data.arrayGyro, data.timestamp);
+    else if (m_options.useImuCompact[imu_channel(WB_RES::OfflineMeasurement::GYRO)])
+        recordCompactIMUSamples(WB_RES::OfflineMeasurement::GYRO, data.arrayGyro, data.timestamp);
+    else
+        recordGyroscopeSamples(data);
+}
+
+void OfflineMeasurements::recordMagnSamples(const WB_RES::MagnData& data)
+{
+    if (m_options.useImuCompression[imu_channel(WB_RES::OfflineMeasurement::MAGN)])
+        compressIMUSamples(WB_RES::LOCAL::OFFLINE_MEAS_MAGN_COMPRESSED_SAMPLERATE(),
+            WB_RES::OfflineMeasurement::MAGN, data.arrayMagn, data.timestamp);
+    else
+        recordMagnetometerSamples(data);
+}
+
 void OfflineMeasurements::recordAccelerationSamples(const WB_RES::AccData& data)
 {
     static WB_RES::Vec3_Q12_12 buffer[8]; // max 8 x (3 x 24-bit) samples
     size_t samples = data.arrayAcc.size();
     ASSERT(samples <= 8);
 
-    for (size_t i = 0; i < samples; i++)
-    {
-        buffer[i].x = float_to_fixed_point_Q12_12(data.arrayAcc[i].x);
-        buffer[i].y = float_to_fixed_point_Q12_12(data.arrayAcc[i].y);
-        buffer[i].z = float_to_fixed_point_Q12_12(data.arrayAcc[i].z);
-    }
+    float_to_fixed_point_Q12_12(data.arrayAcc, buffer);
 
-    WB_RES::OfflineAccData acc;
-    acc.timestamp = data.timestamp;
-    acc.measurements = wb::MakeArray(buffer, samples);
+    const size_t channel = imu_channel(WB_RES::OfflineMeasurement::ACC);
+    State::IMU& imu = m_state.imu[channel];
+    uint16_t sampleRate = getAccSampleRate();
+    if (m_options.useImuImplicit[channel])
+        syncSamples(WB_RES::OfflineMeasurement::ACC, imu.clock, data.timestamp, samples);
 
-    updateResource(WB_RES::LOCAL::OFFLINE_MEAS_ACC_SAMPLERATE(), ResponseOptions::ForceAsync, acc);
+    auto onWrite = [this](const uint8_t* batch, size_t count, uint32_t timestamp) {
+        writeIMUBatch(WB_RES::OfflineMeasurement::ACC, batch, count, timestamp);
+        };
+    imu.batch.append(buffer, samples, data.timestamp, sampleRate, onWrite);
 }
 
 void OfflineMeasurements::recordGyroscopeSamples(const WB_RES::GyroData& data)
@@ -783,18 +1296,18 @@ void OfflineMeasurements::recordGyroscopeSamples(const WB_RES::GyroData& data)
     size_t samples = data.arrayGyro.size();
     ASSERT(samples <= 8);
 
-    for (size_t i = 0; i < samples; i++)
-    {
-        buffer[i].x = float_to_fixed_point_Q12_12(data.arrayGyro[i].x);
-        buffer[i].y = float_to_fixed_point_Q12_12(data.arrayGyro[i].y);
-        buffer[i].z = float_to_fixed_point_Q12_12(data.arrayGyro[i].z);
-    }
+    float_to_fixed_point_Q12_12(data.arrayGyro, buffer);
 
-    WB_RES::OfflineGyroData gyro;
-    gyro.timestamp = data.timestamp;
-    gyro.measurements = wb::MakeArray(buffer, samples);
+    const size_t channel = imu_channel(WB_RES::OfflineMeasurement::GYRO);
+    State::IMU& imu = m_state.imu[channel];
+    uint16_t sampleRate = m_state.params[WB_RES::OfflineMeasurement::GYRO];
+    if (m_options.useImuImplicit[channel])
+        syncSamples(WB_RES::OfflineMeasurement::GYRO, imu.clock, data.timestamp, samples);
 
-    updateResource(WB_RES::LOCAL::OFFLINE_MEAS_GYRO_SAMPLERATE(), ResponseOptions::ForceAsync, gyro);
+    auto onWrite = [this](const uint8_t* batch, size_t count, uint32_t timestamp) {
+        writeIMUBatch(WB_RES::OfflineMeasurement::GYRO, batch, count, timestamp);
+        };
+    imu.batch.append(buffer, samples, data.timestamp, sampleRate, onWrite);
 }
 
 void OfflineMeasurements::recordMagnetometerSamples(const WB_RES::MagnData& data)
@@ -803,27 +1316,210 @@ void OfflineMeasurements::recordMagnetometerSamples(const WB_RES::MagnData& data
     size_t samples = data.arrayMagn.size();
     ASSERT(samples <= 8);
 
-    for (size_t i = 0; i < samples; i++)
+    float_to_fixed_point_Q10_6(data.arrayMagn, buffer);
+
+    const size_t channel = imu_channel(WB_RES::OfflineMeasurement::MAGN);
+    State::IMU& imu = m_state.imu[channel];
+    uint16_t sampleRate = m_state.params[WB_RES::OfflineMeasurement::MAGN];
+    if (m_options.useImuImplicit[channel])
+        syncSamples(WB_RES::OfflineMeasurement::MAGN, imu.clock, data.timestamp, samples);
+
+    auto onWrite = [this](const uint8_t* batch, size_t count, uint32_t timestamp) {
+        writeIMUBatch(WB_RES::OfflineMeasurement::MAGN, batch, count, timestamp);
+        };
+    imu.batch.append(buffer, samples, data.timestamp, sampleRate, onWrite);
+}
+
+void OfflineMeasurements::recordCompactIMUSamples(WB_RES::OfflineMeasurement::Type measurement,
+    const wb::Array<wb::FloatVector3D>& samples, uint32_t timestamp)
+{
+    static WB_RES::Vec3_Q16 buffer[8]; // max 8 x (3 x 16-bit) samples
+    size_t count = samples.size();
+    ASSERT(count <= 8);
+
+    State::IMU& imu = m_state.imu[imu_channel(measurement)];
+    float_to_fixed_point_Q16(samples, imu.fractionBits, buffer);
+
+    uint16_t sampleRate = measurement == WB_RES::OfflineMeasurement::ACC
+        ? getAccSampleRate()
+        : m_state.params[measurement];
+
+    auto onWrite = [this, measurement](const uint8_t* batch, size_t batchCount, uint32_t batchTimestamp) {
+        writeIMUBatch(measurement, batch, batchCount, batchTimestamp);
+        };
+    imu.batch.append(buffer, count, timestamp, sampleRate, onWrite);
+}
+
+void OfflineMeasurements::writeIMUBatch(WB_RES::OfflineMeasurement::Type measurement,
+    const uint8_t* batch, size_t count, uint32_t timestamp)
+{
+    const size_t channel = imu_channel(measurement);
+    if (m_options.useImuCompact[channel])
+    {
+        WB_RES::OfflineIMUCompactData data;
+        data.timestamp = timestamp;
+        data.fractionBits = m_state.imu[channel].fractionBits;
+        data.measurements = wb::MakeArray(reinterpret_cast<const WB_RES::Vec3_Q16*>(batch), count);
+        if (measurement == WB_RES::OfflineMeasurement::ACC)
+            updateResource(WB_RES::LOCAL::OFFLINE_MEAS_ACC_COMPACT_SAMPLERATE(), ResponseOptions::ForceAsync, data);
+        else
+            updateResource(WB_RES::LOCAL::OFFLINE_MEAS_GYRO_COMPACT_SAMPLERATE(), ResponseOptions::ForceAsync, data);
+        return;
+    }
+
+    if (m_options.useImuImplicit[channel])
+    {
+        if (measurement == WB_RES::OfflineMeasurement::MAGN)
+        {
+            WB_RES::OfflineMagnImplicitData implicit;
+            implicit.measurements = wb::MakeArray(reinterpret_cast<const WB_RES::Vec3_Q10_6*>(batch), count);
+            updateResource(WB_RES::LOCAL::OFFLINE_MEAS_MAGN_IMPLICIT_SAMPLERATE(), ResponseOptions::ForceAsync, implicit);
+            return;
+        }
+
+        WB_RES::OfflineIMUImplicitData implicit;
+        implicit.measurements = wb::MakeArray(reinterpret_cast<const WB_RES::Vec3_Q12_12*>(batch), count);
+        if (measurement == WB_RES::OfflineMeasurement::ACC)
+            updateResource(WB_RES::LOCAL::OFFLINE_MEAS_ACC_IMPLICIT_SAMPLERATE(), ResponseOptions::ForceAsync, implicit);
+        else
+            updateResource(WB_RES::LOCAL::OFFLINE_MEAS_GYRO_IMPLICIT_SAMPLERATE(), ResponseOptions::ForceAsync, implicit);
+        return;
+    }
+
+    switch (measurement)
+    {
+    case WB_RES::OfflineMeasurement::ACC:
+    {
+        WB_RES::OfflineAccData record;
+        record.timestamp = timestamp;
+        record.measurements = wb::MakeArray(reinterpret_cast<const WB_RES::Vec3_Q12_12*>(batch), count);
+        updateResource(WB_RES::LOCAL::OFFLINE_MEAS_ACC_SAMPLERATE(), ResponseOptions::ForceAsync, record);
+        break;
+    }
+    case WB_RES::OfflineMeasurement::GYRO:
+    {
+        WB_RES::OfflineGyroData record;
+        record.timestamp = timestamp;
+        record.measurements = wb::MakeArray(reinterpret_cast<const WB_RES::Vec3_Q12_12*>(batch), count);
+        updateResource(WB_RES::LOCAL::OFFLINE_MEAS_GYRO_SAMPLERATE(), ResponseOptions::ForceAsync, record);
+        break;
+    }
+    case WB_RES::OfflineMeasurement::MAGN:
     {
-        buffer[i].x = float_to_fixed_point_Q10_6(data.arrayMagn[i].x);
-        buffer[i].y = float_to_fixed_point_Q10_6(data.arrayMagn[i].y);
-        buffer[i].z = float_to_fixed_point_Q10_6(data.arrayMagn[i].z);
+        WB_RES::OfflineMagnData record;
+        record.timestamp = timestamp;
+        record.measurements = wb::MakeArray(reinterpret_cast<const WB_RES::Vec3_Q10_6*>(batch), count);
+        updateResource(WB_RES::LOCAL::OFFLINE_MEAS_MAGN_SAMPLERATE(), ResponseOptions::ForceAsync, record);
+        break;
     }
+    default:
+        break;
+    }
+}
+
+template<typename TResource>
+void OfflineMeasurements::compressIMUSamples(const TResource& resource, WB_RES::OfflineMeasurement::Type measurement,
+    const wb::Array<wb::FloatVector3D>& samples, uint32_t timestamp)
+{
+    static_assert(sizeof(wb::FloatVector3D) == 3 * sizeof(float), "Vectors are read as packed floats");
+    static int32_t buffer[8 * 3]; // max 8 x 3 fixed-point components
+    size_t count = samples.size();
+    ASSERT(count <= 8);
+    if (count == 0)
+        return;
+
+    State::IMU& imu = m_state.imu[imu_channel(measurement)];
+    uint16_t sampleRate = measurement == WB_RES::OfflineMeasurement::ACC
+        ? getAccSampleRate()
+        : m_state.params[measurement];
+
+    const float* values = reinterpret_cast<const float*>(&samples[0]);
+    if (imu.valueBits == 16)
+        float_to_fixed_point_sat<16>(values, buffer, count * 3, imu.fractionBits);
+    else
+        float_to_fixed_point_sat<24>(values, buffer, count * 3, imu.fractionBits);
+
+    // Sink for blocks as they get completed, resolved at compile time
+    auto onWrite = [this, &resource, measurement](uint8_t* block, size_t size) {
+        writeCompressedIMUBlock(resource, measurement, block, size);
+        };
+
+    if (imu.stream_samples == 0) // init timestamp
+        imu.stream_timestamp = timestamp;
+
+    // Blocks span several notifications, restart the stream if the timestamp is off
+    int32_t diff = timestamp - imu.sample_timestamp(imu.stream_samples, sampleRate);
+    int32_t maxDiff = (count * 1000 / 2) / sampleRate;
+    if (diff > maxDiff || diff < -maxDiff)
+    {
+        if (imu.compressor.block_samples() > 0)
+            imu.stats.gapBlocks++;
+        imu.compressor.dump_buffer(onWrite);
+        imu.stream_timestamp = timestamp;
+        imu.stream_samples = 0;
+        imu.block_first_sample = 0;
+    }
+    else
+    {
+        // Follow the timestamps, the real rate is not the nominal one (13 Hz is 12.5 Hz)
+        imu.stream_timestamp += diff;
+    }
+    imu.stream_samples += count;
+
+    size_t compressed = imu.compressor.pack_continuous(buffer, count, onWrite);
+    ASSERT(compressed == count);
+    imu.stats.samples += count;
+    imu.stats.add_residual(imu.compressor.max_residual());
+}
+
+template<typename TResource>
+void OfflineMeasurements::flushIMUSamples(const TResource& resource, WB_RES::OfflineMeasurement::Type measurement)
+{
+    auto onWrite = [this, &resource, measurement](uint8_t* block, size_t size) {
+        writeCompressedIMUBlock(resource, measurement, block, size);
+        };
+    m_state.imu[imu_channel(measurement)].compressor.dump_buffer(onWrite);
+}
 
-    WB_RES::OfflineMagnData magn;
-    magn.timestamp = data.timestamp;
-    magn.measurements = wb::MakeArray(buffer, samples);
+template<typename TResource>
+void OfflineMeasurements::writeCompressedIMUBlock(const TResource& resource, WB_RES::OfflineMeasurement::Type measurement,
+    uint8_t* block, size_t size)
+{
+    State::IMU& imu = m_state.imu[imu_channel(measurement)];
+    uint16_t sampleRate = measurement == WB_RES::OfflineMeasurement::ACC
+        ? getAccSampleRate()
+        : m_state.params[measurement];
+
+    WB_RES::OfflineIMUCompressedData data;
+    data.timestamp = imu.sample_timestamp(imu.block_first_sample, sampleRate);
+    data.bytes = wb::MakeArray(block, size);
+    updateResource(resource, ResponseOptions::ForceAsync, data);
+
+    imu.block_first_sample += imu.compressor.block_samples();
+    imu.stats.add_block(size);
+}
 
-    updateResource(WB_RES::LOCAL::OFFLINE_MEAS_MAGN_SAMPLERATE(), ResponseOptions::ForceAsync, magn);
+void OfflineMeasurements::flushIMUBatch(WB_RES::OfflineMeasurement::Type measurement)
+{
+    auto onWrite = [this, measurement](const uint8_t* batch, size_t count, uint32_t timestamp) {
+        writeIMUBatch(measurement, batch, count, timestamp);
+        };
+    m_state.imu[imu_channel(measurement)].batch.flush(onWrite);
 }
 
 void OfflineMeasurements::recordTemperatureSamples(const WB_RES::TemperatureValue& data)
 {
     int8_t as_c = (int8_t)CLAMP(data.measurement - 273.15f, INT8_MIN, INT8_MAX);
 
-    if (as_c == m_state.temperature.value) // Temperature has not changed enough. Ignore.
+    if (!m_state.temperature.deadband.update(as_c, data.timestamp)) // Temperature has not changed enough. Ignore.
         return;
-    m_state.temperature.value = as_c;
+
+    if (m_options.useTempCompression)
+    {
+        compressSlowValue(WB_RES::LOCAL::OFFLINE_MEAS_TEMP_COMPRESSED(), m_state.temperature.compressor,
+            m_state.temperature.stats, as_c, data.timestamp);
+        return;
+    }
 
     WB_RES::OfflineTempData temp;
     temp.timestamp = data.timestamp;
@@ -838,18 +1534,21 @@ void OfflineMeasurements::recordActivity(const WB_RES::AccData& data)
     if (refState.activity_start == 0)
         refState.activity_start = data.timestamp;
 
-    float total_len = 0.0f;
     size_t count = data.arrayAcc.size();
-    for (size_t i = 0; i < count; i++)
+    if (count > 0)
     {
-        const auto& s = data.arrayAcc[i];
-        wb::FloatVector3D v = refState.lpf.filter(s);
-        total_len += v.length<float>();
-    }
-    float avg_len = total_len / count;
+        float total_len = 0.0f;
+        for (size_t i = 0; i < count; i++)
+        {
+            const auto& s = data.arrayAcc[i];
+            wb::FloatVector3D v = refState.lpf.filter(s);
+            total_len += v.length<float>();
+        }
+        float avg_len = total_len / count;
 
-    refState.accumulated_average += avg_len;
-    refState.accumulated_count += 1;
+        refState.accumulated_average += avg_len;
+        refState.accumulated_count += 1;
+    }
 
     uint32_t timediff = data.timestamp - refState.activity_start;
     uint32_t interval = m_state.params[WB_RES::OfflineMeasurement::ACTIVITY] * 1000;
@@ -857,12 +1556,24 @@ void OfflineMeasurements::recordActivity(const WB_RES::AccData& data)
     {
         WB_RES::OfflineActivityData activityData;
         activityData.timestamp = data.timestamp;
-        activityData.activity = static_cast<uint16_t>(
+        activityData.activity = refState.accumulated_count == 0 ? 0 : static_cast<uint16_t>(
             refState.accumulated_average * (100.0f / refState.accumulated_count));
 
-        updateResource(
-            WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_INTERVAL(),
-            ResponseOptions::ForceAsync, activityData);
+        if (!refState.deadband.update(activityData.activity, data.timestamp))
+        {
+            // Not recorded
+        }
+        else if (m_options.useActivityCompression)
+        {
+            compressSlowValue(WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_COMPRESSED_INTERVAL(), refState.compressor,
+                refState.stats, activityData.activity, data.timestamp);
+        }
+        else
+        {
+            updateResource(
+                WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_INTERVAL(),
+                ResponseOptions::ForceAsync, activityData);
+        }
 
         refState.accumulated_average = 0;
         refState.accumulated_count = 0;
@@ -870,34 +1581,362 @@ void OfflineMeasurements::recordActivity(const WB_RES::AccData& data)
     }
 }
 
+template<typename TResource, typename TCompressor>
+void OfflineMeasurements::compressSlowValue(const TResource& resource, TCompressor& compressor,
+    CompressionStats& stats, int32_t value, uint32_t timestamp)
+{
+    // Sink for blocks as they get completed, resolved at compile time
+    auto onWrite = [this, &resource, &stats](uint8_t* block, size_t size, uint32_t blockTimestamp) {
+        writeSlowBlock(resource, stats, block, size, blockTimestamp);
+        };
+
+    compressor.pack(value, timestamp, onWrite);
+    stats.samples += 1;
+    stats.add_residual(compressor.max_residual());
+}
+
+template<typename TResource, typename TCompressor>
+void OfflineMeasurements::expireSlowValues(const TResource& resource, TCompressor& compressor,
+    CompressionStats& stats, uint32_t now)
+{
+    auto onWrite = [this, &resource, &stats](uint8_t* block, size_t size, uint32_t blockTimestamp) {
+        writeSlowBlock(resource, stats, block, size, blockTimestamp);
+        };
+    compressor.expire(now, onWrite);
+}
+
+template<typename TResource, typename TCompressor>
+void OfflineMeasurements::flushSlowValues(const TResource& resource, TCompressor& compressor, CompressionStats& stats)
+{
+    auto onWrite = [this, &resource, &stats](uint8_t* block, size_t size, uint32_t blockTimestamp) {
+        writeSlowBlock(resource, stats, block, size, blockTimestamp);
+        };
+    compressor.dump_buffer(onWrite);
+}
+
+template<typename TResource>
+void OfflineMeasurements::writeSlowBlock(const TResource& resource, CompressionStats& stats,
+    uint8_t* block, size_t size, uint32_t timestamp)
+{
+    WB_RES::OfflineSlowCompressedData data;
+    data.timestamp = timestamp;
+    data.bytes = wb::MakeArray(block, size);
+    updateResource(resource, ResponseOptions::ForceAsync, data);
+
+    stats.add_block(size);
+}
+
+void OfflineMeasurements::flushMeasurement(WB_RES::OfflineMeasurement::Type measurement)
+{
+    switch (measurement)
+    {
+    case WB_RES::OfflineMeasurement::ECG:
+        if (m_options.useEcgCompression)
+        {
+            if (m_options.ecgCompression == WB_RES::OfflineECGCompression::WAVELET)
+                flushECGSamples(m_state.ecg.wavelet);
+            else
+                flushECGSamples(m_state.ecg.compressor);
+        }
+        else
+        {
+            auto onWrite = [this](const uint8_t* batch, size_t count, uint32_t timestamp) {
+                writeECGBatch(batch, count, timestamp);
+                };
+            m_state.ecg.batch.flush(onWrite);
+        }
+        break;
+    case WB_RES::OfflineMeasurement::ACC:
+        if (m_options.useImuCompression[imu_channel(measurement)])
+            flushIMUSamples(WB_RES::LOCAL::OFFLINE_MEAS_ACC_COMPRESSED_SAMPLERATE(), measurement);
+        else
+            flushIMUBatch(measurement);
+        break;
+    case WB_RES::OfflineMeasurement::GYRO:
+        if (m_options.useImuCompression[imu_channel(measurement)])
+            flushIMUSamples(WB_RES::LOCAL::OFFLINE_MEAS_GYRO_COMPRESSED_SAMPLERATE(), measurement);
+        else
+            flushIMUBatch(measurement);
+        break;
+    case WB_RES::OfflineMeasurement::MAGN:
+        if (m_options.useImuCompression[imu_channel(measurement)])
+            flushIMUSamples(WB_RES::LOCAL::OFFLINE_MEAS_MAGN_COMPRESSED_SAMPLERATE(), measurement);
+        else
+            flushIMUBatch(measurement);
+        break;
+    case WB_RES::OfflineMeasurement::HR:
+        if (m_options.useHRCompression)
+            flushSlowValues(WB_RES::LOCAL::OFFLINE_MEAS_HR_COMPRESSED(), m_state.hr.compressor, m_state.hr.stats);
+        break;
+    case WB_RES::OfflineMeasurement::RR:
+        if (m_options.useRRCompression)
+        {
+            auto onWrite = [this](uint8_t* block, size_t size) {
+                writeCompressedRRBlock(block, size);
+                };
+            m_state.r_to_r.compressor.dump_buffer(onWrite);
+        }
+        break;
+    case WB_RES::OfflineMeasurement::TEMP:
+        if (m_options.useTempCompression)
+            flushSlowValues(WB_RES::LOCAL::OFFLINE_MEAS_TEMP_COMPRESSED(), m_state.temperature.compressor,
+                m_state.temperature.stats);
+        break;
+    case WB_RES::OfflineMeasurement::ACTIVITY:
+        if (m_options.useActivityCompression)
+            flushSlowValues(WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_COMPRESSED_INTERVAL(), m_state.activity.compressor,
+                m_state.activity.stats);
+        break;
+    default:
+        break;
+    }
+}
+
+void OfflineMeasurements::expireBlocks(uint32_t now)
+{
+    if (m_state.subscribers[WB_RES::OfflineMeasurement::ECG] > 0 && !m_options.useEcgCompression)
+    {
+        auto onWrite = [this](const uint8_t* batch, size_t count, uint32_t timestamp) {
+            writeECGBatch(batch, count, timestamp);
+            };
+        m_state.ecg.batch.expire(now, onWrite);
+    }
+
+    for (size_t channel = 0; channel < IMU_CHANNELS; channel++)
+    {
+        const auto measurement = static_cast<WB_RES::OfflineMeasurement::Type>(WB_RES::OfflineMeasurement::ACC + channel);
+        if (m_state.subscribers[measurement] == 0 || m_options.useImuCompression[channel])
+            continue;
+
+        auto onWrite = [this, measurement](const uint8_t* batch, size_t count, uint32_t timestamp) {
+            writeIMUBatch(measurement, batch, count, timestamp);
+            };
+        m_state.imu[channel].batch.expire(now, onWrite);
+    }
+
+    if (m_state.subscribers[WB_RES::OfflineMeasurement::HR] > 0 && m_options.useHRCompression)
+        expireSlowValues(WB_RES::LOCAL::OFFLINE_MEAS_HR_COMPRESSED(), m_state.hr.compressor, m_state.hr.stats, now);
+
+    if (m_state.subscribers[WB_RES::OfflineMeasurement::TEMP] > 0 && m_options.useTempCompression)
+        expireSlowValues(WB_RES::LOCAL::OFFLINE_MEAS_TEMP_COMPRESSED(), m_state.temperature.compressor,
+            m_state.temperature.stats, now);
+
+    if (m_state.subscribers[WB_RES::OfflineMeasurement::ACTIVITY] > 0 && m_options.useActivityCompression)
+        expireSlowValues(WB_RES::LOCAL::OFFLINE_MEAS_ACTIVITY_COMPRESSED_INTERVAL(), m_state.activity.compressor,
+            m_state.activity.stats, now);
+}
+
+void OfflineMeasurements::updateFlushTimer()
+{
+    bool batched = m_state.subscribers[WB_RES::OfflineMeasurement::ECG] > 0 && !m_options.useEcgCompression &&
+        m_state.ecg.batch.enabled();
+    for (size_t channel = 0; channel < IMU_CHANNELS; channel++)
+        batched = batched || (m_state.subscribers[WB_RES::OfflineMeasurement::ACC + channel] > 0 &&
+            !m_options.useImuCompression[channel] && m_state.imu[channel].batch.enabled());
+
+    const bool needed = (batched && m_options.batchLatency > 0) ||
+        (m_state.subscribers[WB_RES::OfflineMeasurement::HR] > 0 && m_options.useHRCompression) ||
+        (m_state.subscribers[WB_RES::OfflineMeasurement::TEMP] > 0 && m_options.useTempCompression) ||
+        (m_state.subscribers[WB_RES::OfflineMeasurement::ACTIVITY] > 0 && m_options.useActivityCompression);
+
+    if (needed && m_flushTimer == wb::ID_INVALID_TIMER)
+    {
+        m_flushTimer = ResourceClient::startTimer(FLUSH_INTERVAL, true);
+    }
+    else if (!needed && m_flushTimer != wb::ID_INVALID_TIMER)
+    {
+        ResourceClient::stopTimer(m_flushTimer);
+        m_flushTimer = wb::ID_INVALID_TIMER;
+    }
+}
+
+void OfflineMeasurements::setupIMUChannel(WB_RES::OfflineMeasurement::Type measurement,
+    float range, uint8_t wideBits, uint8_t wideFractionBits)
+{
+    State::IMU& imu = m_state.imu[imu_channel(measurement)];
+    imu.reset();
+
+    // With a known sensor range, 16 bits are enough for the useful resolution
+    if (range > 0)
+    {
+        imu.valueBits = 16;
+        imu.fractionBits = fraction_bits_for_range<16>(range);
+    }
+    else
+    {
+        imu.valueBits = wideBits;
+        imu.fractionBits = wideFractionBits;
+    }
+
+    imu.compressor.set_format(imu.valueBits, imu.fractionBits);
+    imu.compressor.set_predictor(IMUPredictor::Adaptive);
+    imu.clock.configure(m_options.syncInterval * 1000);
+
+    const size_t sampleSize = measurement == WB_RES::OfflineMeasurement::MAGN
+        ? sizeof(WB_RES::Vec3_Q10_6)
+        : (m_options.useImuCompact[imu_channel(measurement)] ? sizeof(WB_RES::Vec3_Q16) : sizeof(WB_RES::Vec3_Q12_12));
+    imu.batch.configure(sampleSize, m_options.batchBytes, m_options.batchLatency);
+}
+
 uint16_t OfflineMeasurements::getAccSampleRate()
 {
     uint16_t acc = m_state.params[WB_RES::OfflineMeasurement::ACC];
+    return acc > 0 ? acc : DEFAULT_ACC_SAMPLE_RATE;
+}
+
+bool OfflineMeasurements::applyConfig(const WB_RES::OfflineMeasConfig& config)
+{
+    switch (config.ecgCompression)
+    {
+    case WB_RES::OfflineECGCompression::GAMMA:
+    case WB_RES::OfflineECGCompression::RICE:
+    case WB_RES::OfflineECGCompression::WAVELET:
+    case WB_RES::OfflineECGCompression::ADAPTIVE:
+        break;
+    default:
+        return false;
+    }
+
+    switch (config.ecgPredictor)
+    {
+    case WB_RES::OfflineECGPredictor::FIRSTORDER:
+    case WB_RES::OfflineECGPredictor::ZEROORDER:
+    case WB_RES::OfflineECGPredictor::SECONDORDER:
+    case WB_RES::OfflineECGPredictor::LPC:
+    case WB_RES::OfflineECGPredictor::BEATTEMPLATE:
+        break;
+    default:
+        return false;
+    }
+
+    switch (config.ecgBlockSize)
+    {
+    case 32:
+    case 64:
+    case 128:
+    case 256:
+        break;
+    default:
+        return false;
+    }
+
+    if (config.ecgBitDepth != 16 && config.ecgBitDepth != 18)
+        return false;
+
+    if (config.ecgMaxError > 15)
+        return false;
+
+    switch (config.accRange)
+    {
+    case 0:
+    case 2:
+    case 4:
+    case 8:
+    case 16:
+        break;
+    default:
+        return false;
+    }
 
-    if (m_state.subscribers[WB_RES::OfflineMeasurement::ACC] > 0)
-        return acc > 0 ? acc : DEFAULT_ACC_SAMPLE_RATE;
+    switch (config.gyroRange)
+    {
+    case 0:
+    case 245:
+    case 500:
+    case 1000:
+    case 2000:
+        break;
+    default:
+        return false;
+    }
 
-    if (m_state.subscribers[WB_RES::OfflineMeasurement::ACTIVITY] > 0)
-        return DEFAULT_ACC_SAMPLE_RATE;
+    switch (config.accBaseRate)
+    {
+    case 0:
+    case 13:
+    case 26:
+    case 52:
+    case 104:
+    case 208:
+    case 416:
+    case 833:
+    case 1666:
+        break;
+    default:
+        return false;
+    }
 
-    return 0;
+    m_options.ecgCompression = config.ecgCompression;
+    m_options.ecgPredictor = config.ecgPredictor;
+    m_options.ecgBlockSize = config.ecgBlockSize;
+    m_options.ecgBitDepth = config.ecgBitDepth;
+    m_options.ecgMaxError = config.ecgMaxError;
+    m_options.ecgWaveletThreshold = config.ecgWaveletThreshold;
+    m_options.accRange = config.accRange;
+    m_options.gyroRange = config.gyroRange;
+    m_options.hrHysteresis = config.hrHysteresis;
+    m_options.tempHysteresis = config.tempHysteresis;
+    m_options.activityHysteresis = config.activityHysteresis;
+    m_options.slowMinInterval = config.slowMinInterval;
+    m_options.slowHeartbeat = config.slowHeartbeat;
+    m_options.slowBlockAge = config.slowBlockAge;
+    m_options.syncInterval = config.syncInterval;
+    m_options.batchBytes = config.batchBytes;
+    m_options.batchLatency = config.batchLatency;
+    m_options.accBaseRate = config.accBaseRate;
+
+    SensorHub* hub = SensorHub::instance();
+    if (hub != nullptr)
+        hub->setAccBaseRate(m_options.accBaseRate);
+    return true;
+}
+
+uint32_t OfflineMeasurements::State::ECG::sample_timestamp(uint32_t index, uint16_t sampleRate) const
+{
+    return stream_timestamp + static_cast<uint32_t>((uint64_t)index * 1000 / sampleRate);
 }
 
 void OfflineMeasurements::State::ECG::reset()
 {
     compressor.reset();
-    block_timestamp = 0;
+    wavelet.reset();
+    stats.reset();
+    clock.reset();
+    batch.reset();
+    stream_timestamp = 0;
+    stream_samples = 0;
+    block_first_sample = 0;
+}
+
+uint32_t OfflineMeasurements::State::IMU::sample_timestamp(uint32_t index, uint16_t sampleRate) const
+{
+    return stream_timestamp + static_cast<uint32_t>((uint64_t)index * 1000 / sampleRate);
+}
+
+void OfflineMeasurements::State::IMU::reset()
+{
+    compressor.reset();
+    stats.reset();
+    clock.reset();
+    batch.reset();
+    stream_timestamp = 0;
+    stream_samples = 0;
+    block_first_sample = 0;
 }
 
 void OfflineMeasurements::State::HR::reset()
 {
-    average = 0;
+    deadband.reset();
+    compressor.reset();
+    stats.reset();
 }
 
 void OfflineMeasurements::State::RtoR::reset()
 {
     timestamp = 0;
     index = 0;
+    compressor.reset();
+    stats.reset();
 }
 
 void OfflineMeasurements::State::Activity::reset()
@@ -906,9 +1945,14 @@ void OfflineMeasurements::State::Activity::reset()
     accumulated_count = 0;
     accumulated_average = 0.0f;
     lpf.reset();
+    deadband.reset();
+    compressor.reset();
+    stats.reset();
 }
 
 void OfflineMeasurements::State::Temperature::reset()
 {
-    value = 0;
+    deadband.reset();
+    compressor.reset();
+    stats.reset();
 }
@@ -10,8 +10,17 @@
 #include "meas_gyro/resources.h"
 #include "meas_magn/resources.h"
 #include "meas_temp/resources.h"
+#include "utils/CompressionStats.hpp"
+#include "utils/Deadband.hpp"
 #include "utils/Filter.hpp"
+#include "utils/SampleBatch.hpp"
+#include "utils/SampleClock.hpp"
 #include "compression/ECGCompression.hpp"
+#include "compression/ECGWavelet.hpp"
+#include "compression/IMUCompression.hpp"
+#include "compression/RRCompression.hpp"
+#include "compression/SlowCompression.hpp"
+#include "../SensorHub/SensorHub.hpp"
 
 class OfflineMeasurements FINAL : private wb::ResourceProvider, private wb::ResourceClient, public wb::LaunchableModule
 {
@@ -36,6 +45,10 @@ private: /* wb::ResourceProvider */
         const wb::Request& request,
         const wb::ParameterList& parameters) OVERRIDE;
 
+    virtual void onPutRequest(
+        const wb::Request& request,
+        const wb::ParameterList& parameters) OVERRIDE;
+
     virtual void onSubscribe(
         const wb::Request& request,
         const wb::ParameterList& parameters) OVERRIDE;
@@ -62,6 +75,8 @@ private: /* wb::ResourceClient */
         const wb::Value& value,
         const wb::ParameterList& parameters) OVERRIDE;
 
+    virtual void onTimer(wb::TimerId timerId) OVERRIDE;
+
 private:
     bool subscribeAcc(wb::LocalResourceId resourceId, int32_t param);
     bool subscribeGyro(wb::LocalResourceId resourceId, int32_t param);
@@ -76,42 +91,141 @@ private:
     void dropHRSubscription(wb::LocalResourceId resourceId);
     void dropECGSubscription(wb::LocalResourceId resourceId);
     void dropTempSubscription(wb::LocalResourceId resourceId);
+    bool joinSubscription(WB_RES::OfflineMeasurement::Type measurement, wb::LocalResourceId resourceId, int32_t param);
 
+    void syncSamples(WB_RES::OfflineMeasurement::Type measurement, offline_meas::SampleClock& clock,
+        uint32_t timestamp, size_t count);
     void recordECGSamples(const WB_RES::ECGData& data);
+    void writeECGBatch(const uint8_t* batch, size_t count, uint32_t timestamp);
     void compressECGSamples(const WB_RES::ECGData& data);
+    template<typename TCompressor>
+    void packECGSamples(TCompressor& compressor, const int32_t* samples, size_t count, uint32_t timestamp);
+    template<typename TCompressor>
+    void flushECGSamples(TCompressor& compressor);
+    void writeCompressedECGBlock(uint8_t* block, size_t size, size_t samples);
     void recordHRAverages(const WB_RES::HRData& data);
     void recordRRIntervals(const WB_RES::HRData& data);
+    void compressRRIntervals(const WB_RES::HRData& data);
+    void writeCompressedRRBlock(uint8_t* block, size_t size);
+    void recordAccSamples(const WB_RES::AccData& data);
+    void recordGyroSamples(const WB_RES::GyroData& data);
+    void recordMagnSamples(const WB_RES::MagnData& data);
     void recordAccelerationSamples(const WB_RES::AccData& data);
     void recordGyroscopeSamples(const WB_RES::GyroData& data);
     void recordMagnetometerSamples(const WB_RES::MagnData& data);
+    void recordCompactIMUSamples(WB_RES::OfflineMeasurement::Type measurement,
+        const wb::Array<wb::FloatVector3D>& samples, uint32_t timestamp);
+    void writeIMUBatch(WB_RES::OfflineMeasurement::Type measurement, const uint8_t* batch, size_t count, uint32_t timestamp);
+    void flushIMUBatch(WB_RES::OfflineMeasurement::Type measurement);
+    template<typename TResource>
+    void compressIMUSamples(const TResource& resource, WB_RES::OfflineMeasurement::Type measurement,
+        const wb::Array<wb::FloatVector3D>& samples, uint32_t timestamp);
+    template<typename TResource>
+    void flushIMUSamples(const TResource& resource, WB_RES::OfflineMeasurement::Type measurement);
+    template<typename TResource>
+    void writeCompressedIMUBlock(const TResource& resource, WB_RES::OfflineMeasurement::Type measurement,
+        uint8_t* block, size_t size);
     void recordTemperatureSamples(const WB_RES::TemperatureValue& data);
     void recordActivity(const WB_RES::AccData& data);
+    template<typename TResource, typename TCompressor>
+    void compressSlowValue(const TResource& resource, TCompressor& compressor,
+        offline_meas::CompressionStats& stats, int32_t value, uint32_t timestamp);
+    template<typename TResource, typename TCompressor>
+    void expireSlowValues(const TResource& resource, TCompressor& compressor,
+        offline_meas::CompressionStats& stats, uint32_t now);
+    template<typename TResource, typename TCompressor>
+    void flushSlowValues(const TResource& resource, TCompressor& compressor, offline_meas::CompressionStats& stats);
+    template<typename TResource>
+    void writeSlowBlock(const TResource& resource, offline_meas::CompressionStats& stats,
+        uint8_t* block, size_t size, uint32_t timestamp);
+
+    /// Write out what the encoders of a measurement still hold, before its last subscriber leaves
+    void flushMeasurement(WB_RES::OfflineMeasurement::Type measurement);
+    /// Write out the blocks and batches that are too old at now (ms), so they do not wait for the next values
+    void expireBlocks(uint32_t now);
+    void updateFlushTimer();
+
+    // Acc and activity get the acc samples from the sensor hub at their own rates
+    sensor_hub::AccHandler<OfflineMeasurements, &OfflineMeasurements::recordAccSamples> m_accConsumer;
+    sensor_hub::AccHandler<OfflineMeasurements, &OfflineMeasurements::recordActivity> m_activityConsumer;
 
     uint16_t getAccSampleRate();
 
+    /// Acc, Gyro and Magn have consecutive values in OfflineMeasurement
+    static constexpr size_t IMU_CHANNELS = 3;
+    static size_t imu_channel(WB_RES::OfflineMeasurement::Type measurement)
+    {
+        return measurement - WB_RES::OfflineMeasurement::ACC;
+    }
+
+    void setupIMUChannel(WB_RES::OfflineMeasurement::Type measurement, float range, uint8_t wideBits, uint8_t wideFractionBits);
+
+    bool applyConfig(const WB_RES::OfflineMeasConfig& config);
+
     struct State
     {
         uint8_t subscribers[WB_RES::OfflineMeasurement::COUNT] = {};
         uint16_t params[WB_RES::OfflineMeasurement::COUNT] = {};
+        wb::LocalResourceId resources[WB_RES::OfflineMeasurement::COUNT] = {}; // Subscribed format
+
+        static constexpr size_t SLOW_BLOCK_SIZE = 32; // Compressed HR, temperature and activity
 
         struct ECG
         {
-            static constexpr uint8_t COMPRESSOR_BLOCK_SIZE = 32;
-            uint32_t block_timestamp = 0;
-            ECGCompression<32, int16_t, int32_t> compressor;
+            static constexpr size_t COMPRESSOR_MAX_BLOCK_SIZE = 256;
+            static constexpr uint16_t COMPRESSOR_DEFAULT_BLOCK_SIZE = 32;
+            static constexpr uint8_t COMPRESSOR_DEFAULT_BIT_DEPTH = 16;
+            static constexpr size_t WAVELET_WINDOW_SIZE = 64;
+            static constexpr size_t BATCH_SIZE = 256; // bytes, 128 samples
+            uint32_t stream_timestamp = 0; // Timestamp of sample 0, moved with each notification
+            uint32_t stream_samples = 0; // Samples received since the (re)start
+            uint32_t block_first_sample = 0; // Index of the first sample of the current block
+            ECGCompression<COMPRESSOR_MAX_BLOCK_SIZE, int32_t, int32_t> compressor;
+            offline_meas::compression::ECGBeatTemplate beatTemplate; // Used by the compressor with the BeatTemplate predictor
+            offline_meas::CompressionStats stats;
+            ECGWaveletCompression<COMPRESSOR_MAX_BLOCK_SIZE, WAVELET_WINDOW_SIZE, int32_t> wavelet;
+            offline_meas::SampleClock clock; // Samples recorded without timestamps
+            offline_meas::SampleBatch<BATCH_SIZE> batch; // Uncompressed samples
+            uint32_t sample_timestamp(uint32_t index, uint16_t sampleRate) const;
             void reset();
         } ecg;
 
+        struct IMU
+        {
+            static constexpr size_t COMPRESSOR_BLOCK_SIZE = 256;
+            static constexpr size_t BATCH_SIZE = 288; // bytes, 32 Q12.12 vectors
+            uint32_t stream_timestamp = 0; // Timestamp of sample 0, moved with each notification
+            uint32_t stream_samples = 0; // Samples received since the (re)start
+            uint32_t block_first_sample = 0; // Index of the first sample of the current block
+            uint8_t valueBits = 0; // Fixed-point format of the compact and compressed samples
+            uint8_t fractionBits = 0;
+            IMUCompression<COMPRESSOR_BLOCK_SIZE> compressor;
+            offline_meas::CompressionStats stats;
+            offline_meas::SampleClock clock; // Samples recorded without timestamps
+            offline_meas::SampleBatch<BATCH_SIZE> batch; // Uncompressed samples
+            uint32_t sample_timestamp(uint32_t index, uint16_t sampleRate) const;
+            void reset();
+        } imu[IMU_CHANNELS]; // Compressed, compact and implicit Acc, Gyro and Magn, see imu_channel()
+
         struct HR
         {
-            uint8_t average = 0;
+            offline_meas::Deadband deadband;
+            SlowCompression<SLOW_BLOCK_SIZE> compressor;
+            offline_meas::CompressionStats stats;
             void reset();
         } hr;
 
         struct RtoR
         {
+            static constexpr uint8_t CHUNK_SAMPLES = 8;
+
             uint32_t timestamp = 0;
+            uint16_t samples[CHUNK_SAMPLES] = {};
             uint8_t index = 0;
+
+            static constexpr size_t COMPRESSOR_BLOCK_SIZE = 32;
+            RRCompression<COMPRESSOR_BLOCK_SIZE> compressor;
+            offline_meas::CompressionStats stats;
             void reset();
         } r_to_r;
 
@@ -121,18 +235,51 @@ private:
             uint32_t accumulated_count = 0;
             float accumulated_average = 0;
             offline_meas::SimpleFilter<offline_meas::FilterType::LowPass> lpf;
+            offline_meas::Deadband deadband;
+            SlowCompression<SLOW_BLOCK_SIZE> compressor;
+            offline_meas::CompressionStats stats;
             void reset();
         } activity;
 
         struct Temperature
         {
-            int8_t value = 0;
+            offline_meas::Deadband deadband;
+            SlowCompression<SLOW_BLOCK_SIZE> compressor;
+            offline_meas::CompressionStats stats;
             void reset();
         } temperature;
     } m_state;
 
+    wb::TimerId m_flushTimer; // Runs while a channel has blocks with a maximum age or batches with a latency
+
     struct Options
     {
         bool useEcgCompression;
+        bool useImuCompression[IMU_CHANNELS]; // See imu_channel()
+        bool useImuCompact[IMU_CHANNELS];
+        bool useEcgImplicit;
+        bool useImuImplicit[IMU_CHANNELS];
+        bool useRRCompression;
+        bool useHRCompression;
+        bool useTempCompression;
+        bool useActivityCompression;
+        uint8_t ecgCompression;
+        uint8_t ecgPredictor;
+        uint16_t ecgBlockSize;
+        uint8_t ecgBitDepth;
+        uint8_t ecgMaxError;
+        uint8_t ecgWaveletThreshold;
+        uint8_t accRange;   // g, 0 to keep the sensor range and Q12.12
+        uint16_t gyroRange; // dps, 0 to keep the sensor range and Q12.12
+        uint8_t hrHysteresis;        // bpm
+        uint8_t tempHysteresis;      // celsius
+        uint16_t activityHysteresis;
+        uint16_t slowMinInterval;    // s, HR, temperature and activity
+        uint16_t slowHeartbeat;      // s, HR, temperature and activity
+        uint16_t slowBlockAge;       // s, maximum age of compressed HR, temperature and activity blocks
+        uint16_t syncInterval;       // s, maximum time between sync records of implicit timestamps
+        uint16_t batchBytes;         // bytes per record of uncompressed ECG, Acc, Gyro and Magn, 0 disables batching
+        uint16_t batchLatency;       // ms, maximum delay of batched samples
+        uint16_t accBaseRate;        // Hz, lowest rate of the accelerometer while in use, 0 follows the channels (with gaps on rate changes)
     } m_options;
 };
@@ -1,34 +1,128 @@
 #pragma once
-#include <wb-resources/resources.h>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
 
-namespace offline_meas::compression::bit_pack
+namespace offline_meas::compression
 {
-    template<typename T, uint8_t BitsPerValue, uint8_t ValuesInChunk>
-    bool write(const T& sample, uint8_t buffer[BitsPerValue * ValuesInChunk / 8], uint8_t valueIndex)
+    /// Packing of N values of Bits bits, MSB first: value 0 starts at the MSB of byte 0
+    /// and each value continues right after the previous one. Trailing bits of the last
+    /// byte are zero.
+    ///
+    /// The layout is resolved at compile time, every output byte (or value) is an OR of
+    /// shifts by constants, without loops or branches at runtime.
+    template<uint8_t Bits, size_t N>
+    struct BitPack
     {
-        if (valueIndex >= ValuesInChunk)
-            return false;
+        static_assert(Bits > 0 && Bits <= 24, "Values have to be 1-24 bits");
 
-        uint8_t bitsUsed = valueIndex * BitsPerValue;
-        uint8_t writtenBits = 0;
+        static constexpr size_t BYTES = (Bits * N + 7) / 8;
+        static constexpr uint32_t MASK = (uint32_t(1) << Bits) - 1;
 
-        while (writtenBits < BitsPerValue)
+    private:
+        /// Stream position of the LSB of value
+        static constexpr int lsb_position(size_t value)
         {
-            uint8_t byteOffset = bitsUsed / 8;
-            uint8_t bitOffset = bitsUsed % 8;
-            uint8_t bitCount = WB_MIN(8 - bitOffset, BitsPerValue - writtenBits);
-            uint8_t bitsLeft = BitsPerValue - writtenBits;
+            return static_cast<int>(value * Bits + Bits - 1);
+        }
+
+        /// Left shift that moves the value LSB to its place in byte, negative for right shifts
+        static constexpr int value_shift(size_t byte, size_t value)
+        {
+            return static_cast<int>(byte * 8 + 7) - lsb_position(value);
+        }
+
+        template<int Shift>
+        static constexpr uint32_t shift(uint32_t x)
+        {
+            if constexpr (Shift >= 0)
+                return x << Shift;
+            else
+                return x >> -Shift;
+        }
+
+        template<size_t Byte, size_t Value, typename T>
+        static uint8_t byte_part(const T* in)
+        {
+            return static_cast<uint8_t>(shift<value_shift(Byte, Value)>(static_cast<uint32_t>(in[Value]) & MASK));
+        }
+
+        template<size_t Byte, size_t First, typename T, size_t... I>
+        static uint8_t pack_byte(const T* in, std::index_sequence<I...>)
+        {
+            return (byte_part<Byte, First + I>(in) | ...);
+        }
+
+        /// Values overlapping byte are First..Last
+        template<size_t Byte, typename T>
+        static uint8_t pack_byte(const T* in)
+        {
+            constexpr size_t First = Byte * 8 / Bits;
+            constexpr size_t Last = (Byte * 8 + 7) / Bits < N ? (Byte * 8 + 7) / Bits : N - 1;
+            return pack_byte<Byte, First>(in, std::make_index_sequence<Last - First + 1>());
+        }
+
+        template<typename T, size_t... Byte>
+        static void pack(const T* in, uint8_t* out, std::index_sequence<Byte...>)
+        {
+            ((out[Byte] = pack_byte<Byte>(in)), ...);
+        }
 
-            uint8_t value = sample >> (bitsLeft - bitCount);
-            uint8_t* out = buffer + byteOffset;
-            uint8_t mask = (0xFF << (8 - bitOffset));
-            uint8_t bits = (value << (8 - (bitCount + bitOffset)));
-            *out = (*out & mask) | (bits & ~mask);
+        template<size_t Value, size_t First, size_t... I>
+        static uint32_t unpack_value(const uint8_t* in, std::index_sequence<I...>)
+        {
+            return (shift<-value_shift(First + I, Value)>(in[First + I]) | ...) & MASK;
+        }
+
+        /// Bytes overlapping value are First..Last
+        template<size_t Value, typename T>
+        static T unpack_value(const uint8_t* in)
+        {
+            constexpr size_t First = Value * Bits / 8;
+            constexpr size_t Last = (Value * Bits + Bits - 1) / 8;
+            uint32_t value = unpack_value<Value, First>(in, std::make_index_sequence<Last - First + 1>());
+
+            if constexpr (std::is_signed<T>::value)
+                return static_cast<T>(static_cast<int32_t>(value << (32 - Bits)) >> (32 - Bits));
+            else
+                return static_cast<T>(value);
+        }
 
-            bitsUsed += bitCount;
-            writtenBits += bitCount;
+        template<typename T, size_t... Value>
+        static void unpack(const uint8_t* in, T* out, std::index_sequence<Value...>)
+        {
+            ((out[Value] = unpack_value<Value, T>(in)), ...);
+        }
+
+    public:
+        /// Pack N values into BYTES bytes. Only the Bits least significant bits of each value are stored.
+        template<typename T>
+        static void pack(const T* in, uint8_t* out)
+        {
+            pack(in, out, std::make_index_sequence<BYTES>());
         }
 
-        return true;
-    }
-} // namespace offline_meas::compression::bit_pack
+        /// Unpack N values from BYTES bytes, signed types are sign extended from Bits
+        template<typename T>
+        static void unpack(const uint8_t* in, T* out)
+        {
+            unpack(in, out, std::make_index_sequence<N>());
+        }
+    };
+
+    namespace bit_pack
+    {
+        template<uint8_t Bits, size_t N, typename T>
+        inline void pack(const T* in, uint8_t* out)
+        {
+            BitPack<Bits, N>::pack(in, out);
+        }
+
+        template<uint8_t Bits, size_t N, typename T>
+        inline void unpack(const uint8_t* in, T* out)
+        {
+            BitPack<Bits, N>::unpack(in, out);
+        }
+    } // namespace bit_pack
+} // namespace offline_meas::compression
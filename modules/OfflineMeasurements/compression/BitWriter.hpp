@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace offline_meas::compression
+{
+    /// Floor of base 2 logarithm, value must be non-zero
+    inline uint8_t floor_log2(uint32_t value)
+    {
+        return 31 - __builtin_clz(value);
+    }
+
+    /// MSB-first bit writer that collects bits in a 64-bit accumulator
+    /// and stores them into the output buffer a whole byte at a time.
+    class BitWriter
+    {
+    private:
+        uint8_t* m_out;
+        size_t m_bytePos;
+        uint64_t m_acc;
+        uint8_t m_pending;
+
+        void store_bytes()
+        {
+            while (m_pending >= 8)
+            {
+                m_pending -= 8;
+                m_out[m_bytePos++] = static_cast<uint8_t>(m_acc >> m_pending);
+            }
+        }
+
+    public:
+        /// Continue writing at bit offset of buffer,
+        /// keeping the bits already written in the current byte
+        BitWriter(uint8_t* buffer, size_t bitOffset)
+            : m_out(buffer)
+            , m_bytePos(bitOffset / 8)
+            , m_acc(0)
+            , m_pending(bitOffset % 8)
+        {
+            if (m_pending > 0)
+                m_acc = buffer[m_bytePos] >> (8 - m_pending);
+        }
+
+        /// Append count (<= 32) least significant bits of value
+        void write(uint32_t value, uint8_t count)
+        {
+            if (count == 0)
+                return;
+
+            uint64_t mask = (uint64_t(1) << count) - 1;
+            m_acc = (m_acc << count) | (value & mask);
+            m_pending += count;
+
+            if (m_pending >= 32)
+                store_bytes();
+        }
+
+        /// Append count zero bits
+        void write_zeros(uint8_t count)
+        {
+            while (count > 32)
+            {
+                write(0, 32);
+                count -= 32;
+            }
+            write(0, count);
+        }
+
+        /// Store all pending bits. A trailing partial byte is zero-padded,
+        /// bytes after it are left untouched.
+        void flush()
+        {
+            store_bytes();
+            if (m_pending > 0)
+                m_out[m_bytePos] = static_cast<uint8_t>(m_acc << (8 - m_pending));
+        }
+
+        size_t bit_position() const
+        {
+            return m_bytePos * 8 + m_pending;
+        }
+    };
+} // namespace offline_meas::compression
@@ -0,0 +1,172 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace offline_meas::compression
+{
+    /// Running average beat template for ECG prediction.
+    ///
+    /// Beats are detected from the slope |x[n] - x[n-2]| of the samples: the first sample after
+    /// the refractory period with a slope above half of the beat level starts a beat (phase 0).
+    /// The beat level follows the largest slope of the refractory period of each beat and decays
+    /// when no beats are detected.
+    ///
+    /// The template holds the average prediction residual of each phase after the start of a beat,
+    /// so it corrects whatever base predictor it is used with. Phases from LENGTH on are not corrected.
+    ///
+    /// The state only depends on the reconstructed samples and the residuals of the base
+    /// predictor, so the decoder (offline_meas::decoding::ECGBeatTemplate) can follow it.
+    ///
+    /// mark() and rollback() undo the updates in between, up to JOURNAL_LENGTH of them.
+    /// Each update changes at most one template value, so only the changed values and the
+    /// detection state are kept instead of a copy of the template.
+    class ECGBeatTemplate
+    {
+    public:
+        static constexpr size_t LENGTH = 128;
+        static constexpr uint16_t REFRACTORY = 48;
+        static constexpr uint16_t DECAY_INTERVAL = 64;
+        static constexpr uint8_t FRACTION_BITS = 3;
+        static constexpr uint8_t ADAPT_SHIFT = 3; // Averaging weight 1/8
+        static constexpr size_t JOURNAL_LENGTH = 16;
+
+    private:
+        /// Detection state at mark()
+        struct Mark
+        {
+            int32_t x1;
+            int32_t x2;
+            int32_t level;
+            int32_t beatMax;
+            uint16_t sinceBeat;
+            bool primed;
+        };
+
+        /// Template value before an update
+        struct JournalEntry
+        {
+            uint8_t index;
+            int16_t value;
+        };
+
+        int16_t m_values[LENGTH]; // Average residual of each phase, FRACTION_BITS fractional bits
+        int32_t m_x1;
+        int32_t m_x2;
+        int32_t m_level;
+        int32_t m_beatMax;
+        uint16_t m_sinceBeat; // Samples since the start of the last beat, saturating
+        bool m_primed;
+
+        Mark m_mark;
+        JournalEntry m_journal[JOURNAL_LENGTH];
+        uint8_t m_journalLength;
+
+        static constexpr uint16_t NO_BEAT = 0xFFFF;
+        static_assert(LENGTH <= UINT8_MAX + 1, "Journal indices are 8-bit");
+
+        /// Template index of the next sample, LENGTH if the phase is not corrected
+        size_t index() const
+        {
+            return m_sinceBeat < LENGTH - 1 ? m_sinceBeat + 1 : LENGTH;
+        }
+
+    public:
+        ECGBeatTemplate()
+        {
+            reset();
+        }
+
+        void reset()
+        {
+            for (size_t i = 0; i < LENGTH; i++)
+                m_values[i] = 0;
+            m_x1 = 0;
+            m_x2 = 0;
+            m_level = 0;
+            m_beatMax = 0;
+            m_sinceBeat = NO_BEAT;
+            m_primed = false;
+            mark();
+        }
+
+        /// Start recording the updates for rollback()
+        void mark()
+        {
+            m_mark = { m_x1, m_x2, m_level, m_beatMax, m_sinceBeat, m_primed };
+            m_journalLength = 0;
+        }
+
+        /// Return to the state at the last mark(). At most JOURNAL_LENGTH updates can be undone.
+        void rollback()
+        {
+            while (m_journalLength > 0)
+            {
+                const JournalEntry& entry = m_journal[--m_journalLength];
+                m_values[entry.index] = entry.value;
+            }
+            m_x1 = m_mark.x1;
+            m_x2 = m_mark.x2;
+            m_level = m_mark.level;
+            m_beatMax = m_mark.beatMax;
+            m_sinceBeat = m_mark.sinceBeat;
+            m_primed = m_mark.primed;
+        }
+
+        /// Correction to the base prediction of the next sample
+        int32_t prediction() const
+        {
+            const size_t i = index();
+            return i < LENGTH ? (m_values[i] + (1 << (FRACTION_BITS - 1))) >> FRACTION_BITS : 0;
+        }
+
+        /// Advance the beat detection without learning (first sample of a block)
+        void advance(int32_t sample)
+        {
+            if (!m_primed)
+            {
+                m_x1 = sample;
+                m_x2 = sample;
+                m_primed = true;
+            }
+
+            const int32_t slope = sample >= m_x2 ? sample - m_x2 : m_x2 - sample;
+            m_x2 = m_x1;
+            m_x1 = sample;
+
+            if (m_sinceBeat < NO_BEAT)
+                m_sinceBeat++;
+
+            if (m_sinceBeat <= REFRACTORY)
+            {
+                if (slope > m_beatMax)
+                    m_beatMax = slope;
+                if (m_sinceBeat == REFRACTORY)
+                    m_level += (m_beatMax - m_level) >> 2;
+            }
+            else if (slope > (m_level >> 1))
+            {
+                m_sinceBeat = 0;
+                m_beatMax = slope;
+            }
+            else if (m_sinceBeat % DECAY_INTERVAL == 0)
+            {
+                m_level -= m_level >> 3;
+            }
+        }
+
+        /// Learn the base prediction residual of the next sample and advance
+        void update(int32_t sample, int32_t residual)
+        {
+            const size_t i = index();
+            if (i < LENGTH)
+            {
+                constexpr int32_t limit = INT16_MAX >> FRACTION_BITS;
+                const int32_t target = (residual > limit ? limit : residual < -limit ? -limit : residual) * (1 << FRACTION_BITS);
+                if (m_journalLength < JOURNAL_LENGTH)
+                    m_journal[m_journalLength++] = { static_cast<uint8_t>(i), m_values[i] };
+                m_values[i] += (target - m_values[i]) >> ADAPT_SHIFT;
+            }
+            advance(sample);
+        }
+    };
+} // namespace offline_meas::compression
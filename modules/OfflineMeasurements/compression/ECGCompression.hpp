@@ -1,113 +1,657 @@
 #pragma once
 #include <cstdlib>
 #include <cstring>
-#include <functional>
 
-template<size_t BlockSize, typename TSample, typename TDiff>
+#include "BitWriter.hpp"
+#include "ECGBeatTemplate.hpp"
+#include "RiceCoder.hpp"
+
+/// Entropy coder for the deltas, stored in the block header
+enum class ECGCoding : uint8_t
+{
+    Gamma = 0,    // Elias Gamma, original block layout
+    Rice = 1,     // Adaptive Rice, extended block layout
+    Raw = 2,      // Samples in bit depth bits, no prediction
+    ZeroRun = 3,  // Elias Gamma coded runs of zero residuals, each followed by a non-zero residual
+    Adaptive = 4, // Each block is coded with all of the above and the one holding most samples is kept
+};
+
+/// Prediction of the next sample, the coded value is the residual
+enum class ECGPredictor : uint8_t
+{
+    FirstOrder = 0,  // x[n-1]
+    ZeroOrder = 1,   // 0
+    SecondOrder = 2, // 2x[n-1] - x[n-2]
+    LPC = 3,         // (84x[n-1] - 77x[n-2] + 25x[n-3]) / 32
+};
+
+/// Block layouts
+///
+/// Original (Gamma, first order prediction, at most 32 byte blocks):
+///   [0]    number of samples (non-zero)
+///   [1..]  first sample, followed by Elias Gamma coded deltas
+///
+/// Extended:
+///   [0]    0x00 marker
+///   [1]    coding: bits 0-1 coder (ECGCoding), bits 2-5 coder parameter, bits 6-7 predictor (ECGPredictor)
+///   [2..3] uint16: bits 0-11 number of samples, bits 12-14 sample bit depth - 16,
+///          bit 15 near-lossless
+///   [4]    maximum error, only if near-lossless
+///   [..]   first sample in (bit depth + 7) / 8 bytes, followed by coded residuals
+///
+/// Beat template blocks (set_beat_template) use the extended layout with marker 0xFE in [0],
+/// or 0xFD in the first block after the template was reset. The template is reset every
+/// TEMPLATE_RESTART_BLOCKS blocks and after dump_buffer, so a lost block or a gap in the
+/// samples only affects the blocks up to the next 0xFD.
+///
+/// Samples wider than 16 bits (set_bit_depth), near-lossless blocks (set_max_error) and beat
+/// template blocks always use the extended layout.
+///
+/// Near-lossless: residuals are quantized with step 2 * max error + 1 and the prediction
+/// uses the reconstructed samples, so the error of each sample stays within the maximum error.
+///
+/// Rice coding is backward adaptive (AdaptiveRice), the header stores the initial parameter.
+///
+/// Zero run coding writes Elias Gamma (run + 1) for the zero residuals preceding a non-zero
+/// residual, followed by the Elias Gamma coded zigzag mapped residual. The residual is left out
+/// when the block ends with a run.
+///
+/// Adaptive coding encodes the samples with all coders in parallel, each into a buffer of its
+/// own. When all of them are full, the coder that fit most samples (the fewest bits on a tie)
+/// is written. A block never holds fewer samples than raw samples would fit.
+///
+/// Higher order predictors fall back to lower orders until the block has enough history.
+///
+/// With a beat template, the prediction is corrected with the average residual at the same phase
+/// of the previous beats. The template continues over blocks, so these blocks have to be decoded
+/// in order, starting from the block with the 0xFD marker.
+///
+/// MaxBlockSize sets the size of the buffer, the block size can be selected at runtime.
+///
+/// Completed blocks are passed to a sink, any callable with signature
+/// void(uint8_t* block, size_t size). The sink type is a template parameter
+/// of pack_continuous and dump_buffer, so the call is resolved at compile time.
+template<size_t MaxBlockSize, typename TSample, typename TDiff>
 class ECGCompression
 {
 public:
-    using write_callback = std::function<void(uint8_t[BlockSize])>;
+    static constexpr size_t MIN_BLOCK_SIZE = 32;
+    static constexpr size_t MAX_BLOCK_SIZE = MaxBlockSize;
+    static constexpr size_t MAX_ORIGINAL_BLOCK_SIZE = 32; // Sample count has to fit in one byte
+
+    static_assert(MaxBlockSize >= MIN_BLOCK_SIZE, "Block size too small");
+    static_assert(MaxBlockSize * 8 < 4096, "Sample count has to fit in 12 bits");
+
+    /// Significant bits of the samples, the residuals need up to 3 bits more
+    static constexpr uint8_t DEFAULT_BIT_DEPTH = 16;
+    static constexpr uint8_t MAX_BIT_DEPTH = sizeof(TSample) * 8 < 23 ? sizeof(TSample) * 8 : 23;
+
+    /// Largest allowed reconstruction error of the near-lossless mode
+    static constexpr uint8_t MAX_ERROR = 15;
+
+    static constexpr uint8_t EXTENDED_BLOCK_MARKER = 0x00;
+    static constexpr uint8_t TEMPLATE_BLOCK_MARKER = 0xFE;
+    static constexpr uint8_t TEMPLATE_RESTART_BLOCK_MARKER = 0xFD;
+    static constexpr uint16_t TEMPLATE_RESTART_BLOCKS = 32;
+    static constexpr size_t HEADER_SIZE = 1;
+    static constexpr size_t EXTENDED_HEADER_SIZE = 4;
+
+    /// Coders that can be stored in a block
+    static constexpr uint8_t CODER_COUNT = 4;
+    static constexpr uint16_t MAX_BLOCK_SAMPLES = 0x0FFF;
+
+    /// Fixed LPC coefficients with LPC_SHIFT fractional bits
+    static constexpr TDiff LPC_A1 = 84;
+    static constexpr TDiff LPC_A2 = -77;
+    static constexpr TDiff LPC_A3 = 25;
+    static constexpr uint8_t LPC_SHIFT = 5;
 
 private:
+    /// Output of one coder
+    struct Lane
+    {
+        uint8_t buffer[MaxBlockSize];
+        size_t usedBits;
+        uint16_t samples;
+        bool full;
+    };
+
     bool m_initialize;
-    uint8_t m_buffer[BlockSize];
-    size_t m_usedBits;
-    uint8_t m_bufferedSamples;
+    Lane m_lanes[CODER_COUNT];
+    ECGCoding m_selected; // Coder of the block that is written out
+    size_t m_blockSize;
+    uint16_t m_bufferedSamples;
+    uint32_t m_maxResidual;
+    uint32_t m_zeroRun; // Zero residuals not yet written by the zero run coder
     TSample m_value;
+    TSample m_history[2]; // x[n-2], x[n-3]
+    ECGCoding m_coding;
+    ECGPredictor m_predictor;
+    uint8_t m_bitDepth;
+    uint8_t m_maxError;
+    uint8_t m_riceK;
+    offline_meas::compression::AdaptiveRice m_rice;
+    offline_meas::compression::ECGBeatTemplate* m_template;
+    bool m_templateRestart;
+    uint16_t m_templateBlocks; // Written since the template was reset
     static constexpr size_t MAX_DIFFS = 15;
+    static_assert(MAX_DIFFS <= offline_meas::compression::ECGBeatTemplate::JOURNAL_LENGTH,
+        "The beat template has to be able to undo the updates of a batch");
+
+    /// Prediction for the sample at index of the block
+    TDiff predict(size_t index) const
+    {
+        const TDiff x1 = m_value;
+        const TDiff x2 = m_history[0];
+        const TDiff x3 = m_history[1];
+
+        switch (m_predictor)
+        {
+        case ECGPredictor::ZeroOrder:
+            return 0;
+        case ECGPredictor::SecondOrder:
+            return index < 2 ? x1 : 2 * x1 - x2;
+        case ECGPredictor::LPC:
+            if (index < 2)
+                return x1;
+            if (index < 3)
+                return 2 * x1 - x2;
+            return (LPC_A1 * x1 + LPC_A2 * x2 + LPC_A3 * x3
+                + (1 << (LPC_SHIFT - 1))) >> LPC_SHIFT;
+        case ECGPredictor::FirstOrder:
+        default:
+            return x1;
+        }
+    }
 
-    static TSample calculate_diffs(TSample init, const TSample* samples, size_t sampleCount, TDiff* outDeltas)
+    /// Calculate prediction residuals, advances the sample history and the beat template.
+    /// outSamples receives the samples as the decoder reconstructs them, outBase their
+    /// residuals to the base predictor (without the beat template).
+    ///
+    /// Near-lossless residuals are quantized to multiples of 2 * max error + 1, the history
+    /// holds the samples as the decoder reconstructs them.
+    void calculate_residuals(const TSample* samples, size_t sampleCount, TDiff* outResiduals, TSample* outSamples, TDiff* outBase)
     {
-        TSample value = init;
+        const TDiff step = 2 * m_maxError + 1;
+        const TDiff maxValue = (1 << (m_bitDepth - 1)) - 1;
+        const TDiff minValue = -maxValue - 1;
+
         for (size_t i = 0; i < sampleCount; i++)
         {
-            outDeltas[i] = ((TDiff)samples[i]) - value;
-            value = samples[i];
+            const TDiff base = predict(m_bufferedSamples + i);
+            const TDiff prediction = m_template ? base + m_template->prediction() : base;
+            const TDiff residual = ((TDiff)samples[i]) - prediction;
+            TDiff reconstructed = samples[i];
+
+            const uint32_t magnitude = residual >= 0 ? residual : -residual;
+            if (magnitude > m_maxResidual)
+                m_maxResidual = magnitude;
+
+            if (m_maxError > 0)
+            {
+                const TDiff quantized = residual >= 0
+                    ? (residual + m_maxError) / step
+                    : -((m_maxError - residual) / step);
+
+                reconstructed = prediction + quantized * step;
+                if (reconstructed > maxValue)
+                    reconstructed = maxValue;
+                else if (reconstructed < minValue)
+                    reconstructed = minValue;
+                outResiduals[i] = quantized;
+            }
+            else
+            {
+                outResiduals[i] = residual;
+            }
+
+            outSamples[i] = reconstructed;
+            outBase[i] = reconstructed - base;
+            if (m_template)
+                m_template->update(reconstructed, outBase[i]);
+
+            m_history[1] = m_history[0];
+            m_history[0] = m_value;
+            m_value = reconstructed;
         }
-        return value;
     }
 
-    template<typename TSigned>
-    static size_t count_bits_unsigned(const TSigned& value)
+    /// Map signed value to a positive integer (bijection) for Elias Gamma coding
+    static uint32_t encode_value(const TDiff& value)
     {
-        int32_t a = abs(value);
-        float l = a > 0 ? log2f(a) : 0.0f;
-        return (size_t)floor(l);
+        return value >= 0
+            ? (static_cast<uint32_t>(value) << 1) + 1
+            : (static_cast<uint32_t>(-value) << 1);
     }
 
-    static size_t encode_value(const TDiff& value, uint64_t& out)
+    /// Bits of an Elias Gamma code of a non-zero value
+    static size_t gamma_bits(uint32_t value)
     {
-        out = (abs(value) << 1) + (value >= 0 ? 1 : 0);
-        int n = count_bits_unsigned<int64_t>(out);
-        return n * 2 + 1;
+        return offline_meas::compression::floor_log2(value) * 2 + 1;
     }
 
-    static void write_bits(uint8_t* c, uint8_t bits, size_t offset, size_t count)
+    static void write_gamma(offline_meas::compression::BitWriter& writer, uint32_t value)
     {
-        uint8_t mask = (0xFF << (8 - offset));
-        uint8_t set = (bits << (8 - (count + offset)));
-        *c = (*c & mask) | (set & ~mask);
+        // n zeros followed by the n + 1 significant bits of the value
+        uint8_t n = offline_meas::compression::floor_log2(value);
+        writer.write_zeros(n);
+        writer.write(value, n + 1);
     }
 
     /// Encode values using Elias Gamma encoding with bijection
     size_t encode_buffer(const TDiff* values, size_t count, uint8_t* outBuffer, size_t bufferSize, size_t& writtenBits)
     {
         size_t samplesEncoded = 0;
+        offline_meas::compression::BitWriter writer(outBuffer, writtenBits);
 
         for (size_t i = 0; i < count; i++)
         {
-            uint64_t encodedValue = 0;
-            size_t sampleBits = encode_value(values[i], encodedValue);
-            if (!(writtenBits + sampleBits < bufferSize * 8))
+            uint32_t encodedValue = encode_value(values[i]);
+            if (!(writer.bit_position() + gamma_bits(encodedValue) < bufferSize * 8))
                 break; // Out of buffer
 
-            size_t valueWrittenBits = 0;
-            while (valueWrittenBits < sampleBits)
-            {
-                size_t bufOffset = writtenBits / 8;
-                size_t offset = writtenBits % 8;
-                size_t bitCount = WB_MIN(8 - offset, sampleBits - valueWrittenBits);
-                size_t left = sampleBits - valueWrittenBits;
+            write_gamma(writer, encodedValue);
+
+            samplesEncoded++;
+        }
+
+        writer.flush();
+        writtenBits = writer.bit_position();
+        return samplesEncoded;
+    }
+
+    /// Encode values using adaptive Rice coding
+    size_t encode_rice_buffer(const TDiff* values, size_t count, uint8_t* outBuffer, size_t bufferSize, size_t& writtenBits)
+    {
+        using offline_meas::compression::AdaptiveRice;
+        size_t samplesEncoded = 0;
+        offline_meas::compression::BitWriter writer(outBuffer, writtenBits);
+        const uint8_t escapeBits = m_bitDepth + 3;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const uint8_t k = m_rice.parameter();
+            uint32_t mapped = AdaptiveRice::zigzag(values[i]);
+            if (writer.bit_position() + AdaptiveRice::code_bits(mapped, k, escapeBits) > bufferSize * 8)
+                break; // Out of buffer
+
+            AdaptiveRice::write(writer, mapped, k, escapeBits);
+            m_rice.update(mapped);
+            samplesEncoded++;
+        }
 
-                uint8_t value = encodedValue >> (left - bitCount);
-                write_bits(outBuffer + bufOffset, value, offset, bitCount);
+        writer.flush();
+        writtenBits = writer.bit_position();
+        return samplesEncoded;
+    }
+
+    /// Encode samples as bit depth wide two's complement values
+    size_t encode_raw_buffer(const TSample* samples, size_t count, uint8_t* outBuffer, size_t bufferSize, size_t& writtenBits)
+    {
+        size_t samplesEncoded = 0;
+        offline_meas::compression::BitWriter writer(outBuffer, writtenBits);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (writer.bit_position() + m_bitDepth > bufferSize * 8)
+                break; // Out of buffer
+
+            writer.write(static_cast<uint32_t>(samples[i]), m_bitDepth);
+            samplesEncoded++;
+        }
 
-                writtenBits += bitCount;
-                valueWrittenBits += bitCount;
+        writer.flush();
+        writtenBits = writer.bit_position();
+        return samplesEncoded;
+    }
+
+    /// Encode values as runs of zeros followed by a non-zero value. A pending run is
+    /// written by finish_zero_run, the space for it is reserved here.
+    size_t encode_zero_run_buffer(const TDiff* values, size_t count, uint8_t* outBuffer, size_t bufferSize, size_t& writtenBits,
+        uint16_t blockSamples)
+    {
+        using offline_meas::compression::AdaptiveRice;
+        size_t samplesEncoded = 0;
+        offline_meas::compression::BitWriter writer(outBuffer, writtenBits);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (blockSamples + i >= MAX_BLOCK_SAMPLES)
+                break; // Sample count has to fit in the header
+
+            if (values[i] == 0)
+            {
+                if (writer.bit_position() + gamma_bits(m_zeroRun + 2) > bufferSize * 8)
+                    break; // No room to close the longer run
+
+                m_zeroRun++;
             }
+            else
+            {
+                uint32_t mapped = AdaptiveRice::zigzag(values[i]);
+                if (writer.bit_position() + gamma_bits(m_zeroRun + 1) + gamma_bits(mapped) > bufferSize * 8)
+                    break; // Out of buffer
 
+                write_gamma(writer, m_zeroRun + 1);
+                write_gamma(writer, mapped);
+                m_zeroRun = 0;
+            }
             samplesEncoded++;
         }
 
+        writer.flush();
+        writtenBits = writer.bit_position();
         return samplesEncoded;
     }
 
-    void write_block(write_callback callback)
+    /// Write the pending run of zeros at the end of a block
+    void finish_zero_run(Lane& lane)
+    {
+        if (m_zeroRun == 0)
+            return;
+
+        const size_t headerSize = header_size();
+        offline_meas::compression::BitWriter writer(lane.buffer + headerSize, lane.usedBits);
+        write_gamma(writer, m_zeroRun + 1);
+        writer.flush();
+        lane.usedBits = writer.bit_position();
+        m_zeroRun = 0;
+    }
+
+    /// Coders that encode the current block
+    bool active(ECGCoding coder) const
+    {
+        return m_coding == ECGCoding::Adaptive || m_coding == coder;
+    }
+
+    /// Encode the next samples and their residuals with a coder, returns the number of encoded samples
+    size_t encode(ECGCoding coder, const TSample* samples, const TDiff* residuals, size_t count, Lane& lane)
+    {
+        uint8_t* out = lane.buffer + header_size();
+        const size_t size = m_blockSize - header_size();
+
+        switch (coder)
+        {
+        case ECGCoding::Gamma: // Elias Gamma with bijection for negative deltas
+            return encode_buffer(residuals, count, out, size, lane.usedBits);
+        case ECGCoding::Rice:
+            return encode_rice_buffer(residuals, count, out, size, lane.usedBits);
+        case ECGCoding::Raw:
+            return encode_raw_buffer(samples, count, out, size, lane.usedBits);
+        case ECGCoding::ZeroRun:
+            return encode_zero_run_buffer(residuals, count, out, size, lane.usedBits, lane.samples);
+        default:
+            return 0;
+        }
+    }
+
+    /// Select the coder with most samples in the block, then the fewest bits
+    ECGCoding select_coder()
+    {
+        ECGCoding selected = m_coding;
+        for (uint8_t i = 0; i < CODER_COUNT; i++)
+        {
+            ECGCoding coder = static_cast<ECGCoding>(i);
+            if (!active(coder))
+                continue;
+
+            Lane& lane = m_lanes[i];
+            if (coder == ECGCoding::ZeroRun)
+                finish_zero_run(lane);
+
+            if (selected == ECGCoding::Adaptive)
+            {
+                selected = coder;
+                continue;
+            }
+
+            const Lane& best = m_lanes[static_cast<uint8_t>(selected)];
+            if (lane.samples > best.samples || (lane.samples == best.samples && lane.usedBits < best.usedBits))
+                selected = coder;
+        }
+        return selected;
+    }
+
+    /// Original block layout is used for Gamma coded first order deltas of 16-bit samples
+    bool extended() const
+    {
+        return m_coding != ECGCoding::Gamma || m_predictor != ECGPredictor::FirstOrder
+            || m_blockSize > MAX_ORIGINAL_BLOCK_SIZE || m_bitDepth != DEFAULT_BIT_DEPTH
+            || m_maxError > 0 || m_template;
+    }
+
+    size_t sample_bytes() const
+    {
+        return (m_bitDepth + 7) / 8;
+    }
+
+    size_t header_size() const
+    {
+        if (!extended())
+            return HEADER_SIZE;
+        return m_maxError > 0 ? EXTENDED_HEADER_SIZE + 1 : EXTENDED_HEADER_SIZE;
+    }
+
+    void start_block(TSample first)
+    {
+        const size_t headerSize = header_size();
+        const size_t sampleBytes = sample_bytes();
+        if (extended())
+        {
+            // Restart the statistics from the initial parameter, so that the block can be decoded alone
+            m_riceK = m_rice.parameter();
+            m_rice.start(m_riceK);
+        }
+
+        for (uint8_t i = 0; i < CODER_COUNT; i++)
+        {
+            if (!active(static_cast<ECGCoding>(i)))
+                continue;
+
+            Lane& lane = m_lanes[i];
+            if (extended())
+                memset(lane.buffer, 0x00, m_blockSize);
+
+            // Little-endian, truncated to the bit depth
+            for (size_t j = 0; j < sampleBytes; j++)
+                lane.buffer[headerSize + j] = static_cast<uint32_t>(first) >> (j * 8);
+
+            lane.usedBits = sampleBytes * 8;
+            lane.samples = 1;
+            lane.full = false;
+        }
+
+        m_value = first;
+        m_history[0] = first;
+        m_history[1] = first;
+        m_zeroRun = 0;
+        if (m_template)
+            m_template->advance(first);
+
+        m_initialize = false;
+        m_bufferedSamples = 1;
+    }
+
+    template<typename TSink>
+    void write_block(TSink& sink)
     {
         if (!m_initialize && m_bufferedSamples > 0)
         {
-            m_buffer[0] = m_bufferedSamples;
-            callback(m_buffer);
+            m_selected = select_coder();
+            Lane& lane = m_lanes[static_cast<uint8_t>(m_selected)];
+            uint8_t* buffer = lane.buffer;
+            m_bufferedSamples = lane.samples;
+
+            if (!extended())
+            {
+                buffer[0] = m_bufferedSamples;
+            }
+            else
+            {
+                uint8_t param = m_selected == ECGCoding::Rice ? m_riceK : 0;
+                buffer[0] = !m_template ? EXTENDED_BLOCK_MARKER
+                    : m_templateRestart ? TEMPLATE_RESTART_BLOCK_MARKER
+                    : TEMPLATE_BLOCK_MARKER;
+                m_templateRestart = false;
+                m_templateBlocks += m_template ? 1 : 0;
+                buffer[1] = static_cast<uint8_t>(m_selected) | (param << 2)
+                    | (static_cast<uint8_t>(m_predictor) << 6);
+                uint16_t countAndDepth = m_bufferedSamples | ((m_bitDepth - DEFAULT_BIT_DEPTH) << 12)
+                    | (m_maxError > 0 ? 0x8000 : 0);
+                buffer[2] = countAndDepth & 0xFF;
+                buffer[3] = countAndDepth >> 8;
+                if (m_maxError > 0)
+                    buffer[4] = m_maxError;
+            }
+            sink(buffer, m_blockSize);
+
+            if (m_templateBlocks >= TEMPLATE_RESTART_BLOCKS)
+                restart_template();
         }
     }
 
+    /// Start the template over from the next block, which is marked with 0xFD
+    void restart_template()
+    {
+        if (m_template)
+            m_template->reset();
+        m_templateRestart = true;
+        m_templateBlocks = 0;
+    }
+
 public:
     void reset()
     {
         m_initialize = true;
-        m_usedBits = 0;
+        m_selected = m_coding;
         m_bufferedSamples = 0;
+        m_maxResidual = 0;
+        m_zeroRun = 0;
         m_value = 0;
-        memset(m_buffer, 0x00, sizeof(m_buffer));
+        m_history[0] = 0;
+        m_history[1] = 0;
+        m_riceK = 0;
+        m_rice.start(4);
+        memset(m_lanes, 0x00, sizeof(m_lanes));
+        restart_template();
     }
 
     ECGCompression()
+        : m_blockSize(MAX_ORIGINAL_BLOCK_SIZE)
+        , m_coding(ECGCoding::Gamma)
+        , m_predictor(ECGPredictor::FirstOrder)
+        , m_bitDepth(DEFAULT_BIT_DEPTH)
+        , m_maxError(0)
+        , m_template(nullptr)
+    {
+        reset();
+    }
+
+    /// Select the block size, resets the compressor
+    bool set_block_size(size_t blockSize)
+    {
+        if (blockSize < MIN_BLOCK_SIZE || blockSize > MaxBlockSize)
+            return false;
+
+        m_blockSize = blockSize;
+        reset();
+        return true;
+    }
+
+    size_t block_size() const
+    {
+        return m_blockSize;
+    }
+
+    /// Select the coder, resets the compressor
+    void set_coding(ECGCoding coding)
     {
+        m_coding = coding;
         reset();
     }
 
-    size_t pack_continuous(const wb::Array<TSample>& samples, write_callback callback)
+    ECGCoding coding() const
+    {
+        return m_coding;
+    }
+
+    /// Coder of the last written block
+    ECGCoding block_coding() const
+    {
+        return m_selected;
+    }
+
+    /// Select the predictor, resets the compressor
+    void set_predictor(ECGPredictor predictor)
+    {
+        m_predictor = predictor;
+        reset();
+    }
+
+    ECGPredictor predictor() const
+    {
+        return m_predictor;
+    }
+
+    /// Select the significant bits of the samples, resets the compressor.
+    /// Samples have to fit in the bit depth as signed values.
+    bool set_bit_depth(uint8_t bitDepth)
+    {
+        if (bitDepth < DEFAULT_BIT_DEPTH || bitDepth > MAX_BIT_DEPTH)
+            return false;
+
+        m_bitDepth = bitDepth;
+        reset();
+        return true;
+    }
+
+    uint8_t bit_depth() const
+    {
+        return m_bitDepth;
+    }
+
+    /// Select the maximum reconstruction error, 0 is lossless. Resets the compressor.
+    bool set_max_error(uint8_t maxError)
+    {
+        if (maxError > MAX_ERROR)
+            return false;
+
+        m_maxError = maxError;
+        reset();
+        return true;
+    }
+
+    uint8_t max_error() const
+    {
+        return m_maxError;
+    }
+
+    /// Correct the predictions with a beat template, nullptr disables. Resets the compressor.
+    void set_beat_template(offline_meas::compression::ECGBeatTemplate* beatTemplate)
+    {
+        m_template = beatTemplate;
+        reset();
+    }
+
+    bool beat_template() const
+    {
+        return m_template != nullptr;
+    }
+
+    /// Number of samples in the current block
+    size_t block_samples() const
+    {
+        return m_initialize ? 0 : m_bufferedSamples;
+    }
+
+    /// Largest prediction residual magnitude (before near-lossless quantization) since reset
+    uint32_t max_residual() const
+    {
+        return m_maxResidual;
+    }
+
+    template<typename TSink>
+    size_t pack_continuous(const wb::Array<TSample>& samples, TSink&& sink)
     {
         size_t sampleCount = samples.size();
         size_t processedSamples = 0;
@@ -116,28 +660,51 @@ public:
         {
             if (m_initialize) // Start a new block with absolute initial value
             {
-                m_value = samples[processedSamples];
-                memcpy(m_buffer + 1, &m_value, sizeof(m_value));
-
-                m_usedBits = sizeof(m_value) * 8;
-                m_initialize = false;
-                m_bufferedSamples = 1;
-
+                start_block(samples[processedSamples]);
                 processedSamples += 1;
             }
-            else // Append diffs in Elias Gamma VLC with bijection for negative deltas
+            else // Append prediction residuals in VLC
             {
+                const size_t capacity = (m_blockSize - header_size()) * 8;
                 TDiff diffs[MAX_DIFFS] = {};
+                TDiff base[MAX_DIFFS] = {};
+                TSample reconstructed[MAX_DIFFS] = {};
                 size_t count = WB_MIN(MAX_DIFFS, sampleCount - processedSamples);
-                m_value = calculate_diffs(m_value, &samples[processedSamples], count, diffs);
 
-                size_t encoded = encode_buffer(diffs, count, m_buffer + 1, BlockSize - 1, m_usedBits);
+                // The template may only follow the samples that end up in this block
+                if (m_template)
+                    m_template->mark();
+                calculate_residuals(&samples[processedSamples], count, diffs, reconstructed, base);
+
+                // Each coder continues until its buffer is full
+                size_t encoded = 0;
+                bool full = true;
+                for (uint8_t i = 0; i < CODER_COUNT; i++)
+                {
+                    Lane& lane = m_lanes[i];
+                    if (!active(static_cast<ECGCoding>(i)) || lane.full)
+                        continue;
+
+                    size_t laneEncoded = encode(static_cast<ECGCoding>(i), reconstructed, diffs, count, lane);
+                    lane.samples += laneEncoded;
+                    lane.full = laneEncoded < count || lane.usedBits == capacity;
+                    encoded = WB_MAX(encoded, laneEncoded);
+                    full &= lane.full;
+                }
+
+                if (m_template && encoded < count)
+                {
+                    m_template->rollback();
+                    for (size_t i = 0; i < encoded; i++)
+                        m_template->update(reconstructed[i], base[i]);
+                }
+
                 processedSamples += encoded;
                 m_bufferedSamples += encoded;
 
-                if (encoded < count || m_usedBits == (BlockSize - 1) * 8) // buffer full
+                if (full) // all buffers full
                 {
-                    write_block(callback);
+                    write_block(sink);
                     m_initialize = true; // Start new block on next samples
                 }
             }
@@ -146,9 +713,13 @@ public:
         return processedSamples;
     }
 
-    void dump_buffer(write_callback callback)
+    /// Write the current block. The next block starts the beat template over, as the
+    /// samples after a dump (a gap) do not continue the beats.
+    template<typename TSink>
+    void dump_buffer(TSink&& sink)
     {
-        write_block(callback);
+        write_block(sink);
         m_initialize = true;
+        restart_template();
     }
 };
@@ -0,0 +1,419 @@
+#pragma once
+#include <cstdlib>
+#include <cstring>
+
+#include "BitWriter.hpp"
+#include "RiceCoder.hpp"
+
+/// Block layout
+///   [0]    0xFF marker, tags the block as wavelet coded
+///          (predictive blocks start with a sample count or 0x00)
+///   [1]    bits 0-2 wavelet levels, bits 3-5 sample bit depth - 16,
+///          bits 6-7 window size (16 << value samples)
+///   [2]    detail coefficient threshold, 0 for lossless
+///   [3..4] number of samples (uint16)
+///   [5..]  MSB first: initial Rice parameter of each subband in 4 bits (approximation,
+///          then details from level 1 to levels), followed by windows until the number
+///          of samples is reached. A window starts with a one for a full window, or a zero
+///          and the window length - 1 in WINDOW_LENGTH_BITS bits. The coefficients follow:
+///          approximation subband, then details from the coarsest to the finest level.
+///          With a threshold, each detail subband starts with a zero if all of its
+///          coefficients are coded as zero (and are omitted), or with a one.
+///
+/// Windows are transformed with the reversible integer 5/3 (LeGall) lifting wavelet,
+/// with symmetric extension at the window edges. A window of n samples gets
+/// min(levels, number of levels with at least 2 approximation coefficients) levels.
+///
+/// Approximation coefficients are coded as deltas, continuing from the last approximation
+/// coefficient of the previous window in the block (0 at the start of a block). Detail
+/// coefficients with magnitude <= threshold are coded as zero. Each subband has its own
+/// adaptive Rice state (AdaptiveRice) that continues over the windows of the block.
+/// The escape width is bit depth + levels + 2 bits.
+///
+/// Windows that do not fit in the rest of the block are split to fill it,
+/// the rest of the window goes to the next block.
+///
+/// Completed blocks are passed to a sink, any callable with signature
+/// void(uint8_t* block, size_t size).
+template<size_t MaxBlockSize, size_t WindowSize, typename TSample>
+class ECGWaveletCompression
+{
+public:
+    static constexpr size_t MIN_BLOCK_SIZE = 32;
+    static constexpr size_t MAX_BLOCK_SIZE = MaxBlockSize;
+    static constexpr uint8_t BLOCK_MARKER = 0xFF;
+    static constexpr size_t HEADER_SIZE = 5;
+    static constexpr uint8_t WINDOW_LENGTH_BITS = 7;
+    static constexpr uint8_t RICE_PARAMETER_BITS = 4;
+
+    /// Windows shorter than this are not split to fill the end of a block
+    static constexpr size_t MIN_SPLIT_LENGTH = 16;
+
+    /// Halvings of a window down to a single sample
+    static constexpr size_t MAX_SPLITS = WindowSize == 16 ? 4 : WindowSize == 32 ? 5 : WindowSize == 64 ? 6 : 7;
+
+    static constexpr uint8_t MAX_LEVELS = 5;
+    static constexpr uint8_t DEFAULT_LEVELS = 2;
+    static constexpr uint8_t DEFAULT_BIT_DEPTH = 16;
+    static constexpr uint8_t MAX_BIT_DEPTH = sizeof(TSample) * 8 < 23 ? sizeof(TSample) * 8 : 23;
+
+    static_assert(MaxBlockSize >= MIN_BLOCK_SIZE, "Block size too small");
+    static_assert(MaxBlockSize * 8 < UINT16_MAX, "Sample count has to fit in 16 bits");
+    static_assert(WindowSize == 16 || WindowSize == 32 || WindowSize == 64 || WindowSize == 128,
+        "Window size has to be 16, 32, 64 or 128 samples");
+
+private:
+    using AdaptiveRice = offline_meas::compression::AdaptiveRice;
+    using BitWriter = offline_meas::compression::BitWriter;
+
+    uint8_t m_buffer[MaxBlockSize];
+    size_t m_blockSize;
+    size_t m_usedBits;
+    uint16_t m_blockSamples;
+    int32_t m_lastApproximation;
+    AdaptiveRice m_rice[MAX_LEVELS + 1]; // Approximation, details of levels 1..MAX_LEVELS
+    TSample m_window[WindowSize];
+    int32_t m_coeffs[WindowSize];
+    size_t m_windowSamples;
+    uint8_t m_levels;
+    uint8_t m_bitDepth;
+    uint8_t m_threshold;
+    uint32_t m_maxResidual;
+
+    /// One level of the forward 5/3 lifting on x[i * stride], i < count (count >= 2).
+    /// Details are left in the odd and approximations in the even positions.
+    static void lift_forward(int32_t* x, size_t count, size_t stride)
+    {
+        const size_t details = count / 2;
+        const size_t approximations = count - details;
+
+        for (size_t i = 0; i < details; i++)
+        {
+            int32_t left = x[2 * i * stride];
+            int32_t right = 2 * i + 2 < count ? x[(2 * i + 2) * stride] : left;
+            x[(2 * i + 1) * stride] -= (left + right) >> 1;
+        }
+
+        for (size_t i = 0; i < approximations; i++)
+        {
+            int32_t left = i > 0 ? x[(2 * i - 1) * stride] : x[stride];
+            int32_t right = i < details ? x[(2 * i + 1) * stride] : left;
+            x[2 * i * stride] += (left + right + 2) >> 2;
+        }
+    }
+
+    /// Transform count values in place, returns the number of levels applied
+    uint8_t transform(int32_t* x, size_t count) const
+    {
+        uint8_t level = 0;
+        size_t stride = 1;
+        while (level < m_levels && count >= 2)
+        {
+            lift_forward(x, count, stride);
+            count = (count + 1) / 2;
+            stride *= 2;
+            level++;
+        }
+        return level;
+    }
+
+    /// Code a subband of the transformed window. Only counts the bits if writer is null.
+    /// Approximations are coded as deltas to previous, details are thresholded.
+    size_t code_subband(size_t first, size_t step, size_t count, int32_t* previous,
+        AdaptiveRice& rice, uint8_t escapeBits, BitWriter* writer)
+    {
+        size_t bits = 0;
+        if (!previous && m_threshold > 0)
+        {
+            bool zero = true;
+            for (size_t j = 0; j < count && zero; j++)
+                zero = abs(m_coeffs[first + j * step]) <= m_threshold;
+
+            bits += 1;
+            if (writer)
+                writer->write(zero ? 0 : 1, 1);
+            if (zero)
+                return bits;
+        }
+
+        for (size_t j = 0; j < count; j++)
+        {
+            int32_t value = m_coeffs[first + j * step];
+            if (previous)
+            {
+                int32_t delta = value - *previous;
+                *previous = value;
+                value = delta;
+            }
+            else if (abs(value) <= m_threshold)
+            {
+                value = 0;
+            }
+
+            const uint32_t mapped = AdaptiveRice::zigzag(value);
+            const uint8_t k = rice.parameter();
+            bits += AdaptiveRice::code_bits(mapped, k, escapeBits);
+            if (writer)
+            {
+                AdaptiveRice::write(*writer, mapped, k, escapeBits);
+
+                // The first approximation of a block is absolute
+                const bool absolute = previous && j == 0 && m_blockSamples == 0;
+                if (!absolute && static_cast<uint32_t>(abs(value)) > m_maxResidual)
+                    m_maxResidual = abs(value);
+            }
+            rice.update(mapped);
+        }
+        return bits;
+    }
+
+    /// Code the transformed window of count samples. Only counts the bits if writer
+    /// is null, in which case the coder state is left untouched.
+    size_t code_window(size_t count, uint8_t levels, BitWriter* writer)
+    {
+        AdaptiveRice scratch[MAX_LEVELS + 1];
+        AdaptiveRice* rice = m_rice;
+        if (!writer)
+        {
+            memcpy(scratch, m_rice, sizeof(scratch));
+            rice = scratch;
+        }
+
+        const uint8_t escapeBits = m_bitDepth + levels + 2;
+        size_t bits = count == WindowSize ? 1 : 1 + WINDOW_LENGTH_BITS;
+        if (writer)
+        {
+            if (count == WindowSize)
+                writer->write(1, 1);
+            else
+                writer->write(count - 1, 1 + WINDOW_LENGTH_BITS);
+        }
+
+        // Approximation subband, count / 2^levels rounded up
+        int32_t approximation = m_lastApproximation;
+        const size_t approximationStep = size_t(1) << levels;
+        bits += code_subband(0, approximationStep, (count + approximationStep - 1) >> levels,
+            &approximation, rice[0], escapeBits, writer);
+
+        // Details of level l are the odd positions of the approximations of level l - 1
+        for (uint8_t level = levels; level >= 1; level--)
+        {
+            const size_t parentStride = size_t(1) << (level - 1);
+            const size_t parentCount = (count + parentStride - 1) >> (level - 1);
+            bits += code_subband(parentStride, parentStride * 2, parentCount / 2,
+                nullptr, rice[level], escapeBits, writer);
+        }
+
+        if (writer)
+            m_lastApproximation = approximation;
+        return bits;
+    }
+
+    size_t capacity_bits() const
+    {
+        return (m_blockSize - HEADER_SIZE) * 8;
+    }
+
+    /// Start a new block, the subband statistics continue from the initial parameters
+    void start_block()
+    {
+        memset(m_buffer, 0x00, m_blockSize);
+        m_blockSamples = 0;
+        m_lastApproximation = 0;
+
+        BitWriter writer(m_buffer + HEADER_SIZE, 0);
+        for (uint8_t band = 0; band <= m_levels; band++)
+        {
+            const uint8_t k = m_rice[band].parameter();
+            m_rice[band].start(k);
+            writer.write(k, RICE_PARAMETER_BITS);
+        }
+        writer.flush();
+        m_usedBits = writer.bit_position();
+    }
+
+    template<typename TSink>
+    void write_block(TSink& sink)
+    {
+        if (m_blockSamples > 0)
+        {
+            uint8_t windowCode = WindowSize == 16 ? 0 : WindowSize == 32 ? 1 : WindowSize == 64 ? 2 : 3;
+            m_buffer[0] = BLOCK_MARKER;
+            m_buffer[1] = m_levels | ((m_bitDepth - DEFAULT_BIT_DEPTH) << 3) | (windowCode << 6);
+            m_buffer[2] = m_threshold;
+            m_buffer[3] = m_blockSamples & 0xFF;
+            m_buffer[4] = m_blockSamples >> 8;
+            sink(m_buffer, m_blockSize);
+        }
+        start_block();
+    }
+
+    /// Code count samples as one window, or split into the pieces that fit. A piece that does
+    /// not fit in the rest of the block is halved (the first half fills the block), unless it
+    /// is shorter than MIN_SPLIT_LENGTH and the block has samples, in which case the block is
+    /// written and the piece retried. The halves still to be coded are kept in pending, in the
+    /// order a depth-first split would code them.
+    template<typename TSink>
+    void append_window(const TSample* samples, size_t count, TSink& sink)
+    {
+        size_t pending[MAX_SPLITS]; // Ends of the second halves still to be coded
+        size_t pendingCount = 0;
+        size_t offset = 0;
+        size_t end = count;
+
+        while (true)
+        {
+            const size_t length = end - offset;
+            for (size_t i = 0; i < length; i++)
+                m_coeffs[i] = samples[offset + i];
+            const uint8_t levels = transform(m_coeffs, length);
+
+            size_t bits = code_window(length, levels, nullptr);
+            if (m_usedBits + bits > capacity_bits())
+            {
+                if (length >= 2 && (length >= MIN_SPLIT_LENGTH || m_blockSamples == 0))
+                {
+                    // Fill the rest of the block with the first half
+                    pending[pendingCount++] = end;
+                    end = offset + length / 2;
+                    continue;
+                }
+
+                write_block(sink);
+                bits = code_window(length, levels, nullptr);
+                if (m_usedBits + bits > capacity_bits())
+                    continue; // Split in the empty block
+            }
+
+            BitWriter writer(m_buffer + HEADER_SIZE, m_usedBits);
+            code_window(length, levels, &writer);
+            writer.flush();
+            m_usedBits = writer.bit_position();
+            m_blockSamples += length;
+
+            if (pendingCount == 0)
+                break;
+            offset = end;
+            end = pending[--pendingCount];
+        }
+    }
+
+public:
+    void reset()
+    {
+        m_windowSamples = 0;
+        m_maxResidual = 0;
+        for (uint8_t band = 0; band <= MAX_LEVELS; band++)
+            m_rice[band].start(4);
+        start_block();
+    }
+
+    ECGWaveletCompression()
+        : m_blockSize(MIN_BLOCK_SIZE)
+        , m_levels(DEFAULT_LEVELS)
+        , m_bitDepth(DEFAULT_BIT_DEPTH)
+        , m_threshold(0)
+    {
+        reset();
+    }
+
+    /// Select the block size, resets the compressor
+    bool set_block_size(size_t blockSize)
+    {
+        if (blockSize < MIN_BLOCK_SIZE || blockSize > MaxBlockSize)
+            return false;
+
+        m_blockSize = blockSize;
+        reset();
+        return true;
+    }
+
+    size_t block_size() const
+    {
+        return m_blockSize;
+    }
+
+    /// Select the number of wavelet levels, resets the compressor
+    bool set_levels(uint8_t levels)
+    {
+        if (levels < 1 || levels > MAX_LEVELS)
+            return false;
+
+        m_levels = levels;
+        reset();
+        return true;
+    }
+
+    uint8_t levels() const
+    {
+        return m_levels;
+    }
+
+    /// Select the significant bits of the samples, resets the compressor
+    bool set_bit_depth(uint8_t bitDepth)
+    {
+        if (bitDepth < DEFAULT_BIT_DEPTH || bitDepth > MAX_BIT_DEPTH)
+            return false;
+
+        m_bitDepth = bitDepth;
+        reset();
+        return true;
+    }
+
+    uint8_t bit_depth() const
+    {
+        return m_bitDepth;
+    }
+
+    /// Select the detail coefficient threshold, 0 is lossless. Resets the compressor.
+    void set_threshold(uint8_t threshold)
+    {
+        m_threshold = threshold;
+        reset();
+    }
+
+    uint8_t threshold() const
+    {
+        return m_threshold;
+    }
+
+    /// Number of samples in the current block
+    size_t block_samples() const
+    {
+        return m_blockSamples;
+    }
+
+    /// Largest magnitude of the coded coefficients (approximation deltas and
+    /// thresholded details) since reset
+    uint32_t max_residual() const
+    {
+        return m_maxResidual;
+    }
+
+    template<typename TSink>
+    size_t pack_continuous(const wb::Array<TSample>& samples, TSink&& sink)
+    {
+        size_t sampleCount = samples.size();
+        for (size_t i = 0; i < sampleCount; i++)
+        {
+            m_window[m_windowSamples++] = samples[i];
+            if (m_windowSamples == WindowSize)
+            {
+                append_window(m_window, WindowSize, sink);
+                m_windowSamples = 0;
+            }
+        }
+        return sampleCount;
+    }
+
+    template<typename TSink>
+    void dump_buffer(TSink&& sink)
+    {
+        if (m_windowSamples > 0)
+        {
+            append_window(m_window, m_windowSamples, sink);
+            m_windowSamples = 0;
+        }
+        write_block(sink);
+    }
+};
@@ -3,10 +3,58 @@
 
 namespace offline_meas::compression
 {
-    template<typename T, uint8_t F_bits>
-    inline T float_to_fixed_point(float value)
+    /// Convert to a signed fixed-point value of Bits bits in total, saturated to its range.
+    /// Rounds halfway cases away from zero like round(), but without libm or promotion to double:
+    /// twice the scaled value is exact in float, so its truncation tells the halfway cases apart.
+    /// doubleScale is 2^(F_bits + 1), the scale of the format doubled.
+    template<uint8_t Bits>
+    inline int32_t float_to_fixed_point_sat(float value, float doubleScale)
+    {
+        static_assert(Bits <= 24, "Twice the scaled value has to be exact in float");
+        constexpr float max = static_cast<float>(2 * ((1 << (Bits - 1)) - 1));
+        constexpr float min = -static_cast<float>(2 * (1 << (Bits - 1)));
+
+        float doubled = value * doubleScale;
+        doubled = doubled < max ? doubled : max;
+        doubled = doubled > min ? doubled : min;
+
+        int32_t twice = static_cast<int32_t>(doubled);
+        return (twice + (1 | (twice >> 31))) / 2;
+    }
+
+    template<uint8_t Bits, uint8_t F_bits>
+    inline int32_t float_to_fixed_point_sat(float value)
+    {
+        static_assert(F_bits < Bits, "Sign bit does not fit in the format");
+        return float_to_fixed_point_sat<Bits>(value, static_cast<float>(2 << F_bits));
+    }
+
+    /// Batch version of float_to_fixed_point_sat, without branches so the loop can be vectorized
+    template<uint8_t Bits, uint8_t F_bits>
+    inline void float_to_fixed_point_sat(const float* in, int32_t* out, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+            out[i] = float_to_fixed_point_sat<Bits, F_bits>(in[i]);
+    }
+
+    /// Batch version with the fractional bits selected at runtime
+    template<uint8_t Bits>
+    inline void float_to_fixed_point_sat(const float* in, int32_t* out, size_t count, uint8_t F_bits)
+    {
+        const float doubleScale = static_cast<float>(2u << F_bits);
+        for (size_t i = 0; i < count; i++)
+            out[i] = float_to_fixed_point_sat<Bits>(in[i], doubleScale);
+    }
+
+    /// Fractional bits of the Bits-bit signed format with the finest resolution that
+    /// still holds values up to +-range. E.g. 8 for +-8 g (78.5 m/s^2) in 16 bits (Q8.8).
+    template<uint8_t Bits>
+    constexpr uint8_t fraction_bits_for_range(float range)
     {
-        return static_cast<T>(round(value * (1 << F_bits)));
+        uint8_t integerBits = 1; // Sign
+        while (integerBits < Bits && static_cast<float>(1u << (integerBits - 1)) <= range)
+            integerBits++;
+        return Bits - integerBits;
     }
 
     template<typename T, uint8_t F_bits>
@@ -17,7 +65,7 @@ namespace offline_meas::compression
 
     inline WB_RES::Q16_8 float_to_fixed_point_Q16_8(float value)
     {
-        int32_t fixed = float_to_fixed_point<int32_t, 8>(value);
+        int32_t fixed = float_to_fixed_point_sat<24, 8>(value);
         WB_RES::Q16_8 out = {};
         out.b0 = (fixed & 0xFF);
         out.b1 = ((fixed >> 8) & 0xFF);
@@ -33,7 +81,7 @@ namespace offline_meas::compression
 
     inline WB_RES::Q12_12 float_to_fixed_point_Q12_12(float value)
     {
-        int32_t fixed = float_to_fixed_point<int32_t, 12>(value);
+        int32_t fixed = float_to_fixed_point_sat<24, 12>(value);
         WB_RES::Q12_12 out = {};
         out.b0 = (fixed & 0xFF);
         out.b1 = ((fixed >> 8) & 0xFF);
@@ -49,7 +97,7 @@ namespace offline_meas::compression
 
     inline WB_RES::Q10_6 float_to_fixed_point_Q10_6(float value)
     {
-        int16_t fixed = float_to_fixed_point<int16_t, 6>(value);
+        int32_t fixed = float_to_fixed_point_sat<16, 6>(value);
         WB_RES::Q10_6 out = {};
         out.b0 = (fixed & 0xFF);
         out.b1 = ((fixed >> 8) & 0xFF);
@@ -61,4 +109,74 @@ namespace offline_meas::compression
         int16_t fixed = value.b0 | (value.b1 << 8);
         return fixed_point_to_float<int16_t, 6>(fixed);
     }
+
+    /// Convert 3D vectors to packed Vec3_Q16 in batches, F_bits selects the format
+    /// (see fraction_bits_for_range).
+    inline void float_to_fixed_point_Q16(const wb::Array<wb::FloatVector3D>& in, uint8_t F_bits, WB_RES::Vec3_Q16* out)
+    {
+        static_assert(sizeof(wb::FloatVector3D) == 3 * sizeof(float), "Vectors are read as packed floats");
+        static_assert(sizeof(WB_RES::Vec3_Q16) == 3 * sizeof(int16_t), "Vectors are written as packed components");
+        constexpr size_t BATCH = 8;
+        int32_t fixed[3 * BATCH];
+
+        for (size_t start = 0; start < in.size(); start += BATCH)
+        {
+            const size_t count = WB_MIN(BATCH, in.size() - start);
+            const float* values = reinterpret_cast<const float*>(&in[start]);
+            float_to_fixed_point_sat<16>(values, fixed, 3 * count, F_bits);
+
+            int16_t* components = &out[start].x;
+            for (size_t i = 0; i < 3 * count; i++)
+                components[i] = static_cast<int16_t>(fixed[i]);
+        }
+    }
+
+    /// Convert 3D vectors to packed Vec3_Q12_12 in batches. Output is equal to
+    /// float_to_fixed_point_Q12_12 per component.
+    inline void float_to_fixed_point_Q12_12(const wb::Array<wb::FloatVector3D>& in, WB_RES::Vec3_Q12_12* out)
+    {
+        static_assert(sizeof(wb::FloatVector3D) == 3 * sizeof(float), "Vectors are read as packed floats");
+        static_assert(sizeof(WB_RES::Vec3_Q12_12) == 3 * sizeof(WB_RES::Q12_12), "Vectors are written as packed components");
+        constexpr size_t BATCH = 8;
+        int32_t fixed[3 * BATCH];
+
+        for (size_t start = 0; start < in.size(); start += BATCH)
+        {
+            const size_t count = WB_MIN(BATCH, in.size() - start);
+            const float* values = reinterpret_cast<const float*>(&in[start]);
+            float_to_fixed_point_sat<24, 12>(values, fixed, 3 * count);
+
+            WB_RES::Q12_12* components = &out[start].x;
+            for (size_t i = 0; i < 3 * count; i++)
+            {
+                components[i].b0 = (fixed[i] & 0xFF);
+                components[i].b1 = ((fixed[i] >> 8) & 0xFF);
+                components[i].b2 = ((fixed[i] >> 16) & 0xFF);
+            }
+        }
+    }
+
+    /// Convert 3D vectors to packed Vec3_Q10_6 in batches. Output is equal to
+    /// float_to_fixed_point_Q10_6 per component.
+    inline void float_to_fixed_point_Q10_6(const wb::Array<wb::FloatVector3D>& in, WB_RES::Vec3_Q10_6* out)
+    {
+        static_assert(sizeof(wb::FloatVector3D) == 3 * sizeof(float), "Vectors are read as packed floats");
+        static_assert(sizeof(WB_RES::Vec3_Q10_6) == 3 * sizeof(WB_RES::Q10_6), "Vectors are written as packed components");
+        constexpr size_t BATCH = 8;
+        int32_t fixed[3 * BATCH];
+
+        for (size_t start = 0; start < in.size(); start += BATCH)
+        {
+            const size_t count = WB_MIN(BATCH, in.size() - start);
+            const float* values = reinterpret_cast<const float*>(&in[start]);
+            float_to_fixed_point_sat<16, 6>(values, fixed, 3 * count);
+
+            WB_RES::Q10_6* components = &out[start].x;
+            for (size_t i = 0; i < 3 * count; i++)
+            {
+                components[i].b0 = (fixed[i] & 0xFF);
+                components[i].b1 = ((fixed[i] >> 8) & 0xFF);
+            }
+        }
+    }
 } // namespace offline_meas::compression
@@ -0,0 +1,304 @@
+#pragma once
+#include <cstdlib>
+#include <cstring>
+
+#include "BitWriter.hpp"
+#include "RiceCoder.hpp"
+
+/// Prediction of the next vector component from the previous ones of the same axis
+enum class IMUPredictor : uint8_t
+{
+    FirstOrder = 0,  // x[n-1]
+    SecondOrder = 1, // 2x[n-1] - x[n-2]
+    Adaptive = 2,    // Each block uses the predictor that had the smaller residuals in the previous block
+};
+
+/// Compression of 3D vectors of fixed-point values (/Offline/Meas/{Acc,Gyro,Magn}/Compressed).
+///
+/// Block layout
+///   [0]    value bits (total bits of a fixed-point component)
+///   [1]    fractional bits of the components
+///   [2..3] number of vectors (uint16)
+///   [4]    bits 0-3 initial Rice parameter of x, bits 4-7 of y
+///   [5]    bits 0-3 initial Rice parameter of z, bits 4-5 predictor (IMUPredictor)
+///   [6..]  MSB first: x, y and z of the first vector in value bits each, followed by the
+///          x, y and z residuals of the following vectors.
+///
+/// Each axis has an adaptive Rice state (AdaptiveRice) of its own, restarted from the
+/// parameter in the header at the start of each block. The escape width is value bits + 2.
+/// A vector is only written if all of its components fit in the block.
+///
+/// The adaptive predictor sums the residual magnitudes of both predictors over a block
+/// and codes the next block with the one that had the smaller sum.
+///
+/// Completed blocks are passed to a sink, any callable with signature
+/// void(uint8_t* block, size_t size).
+template<size_t MaxBlockSize>
+class IMUCompression
+{
+public:
+    static constexpr size_t AXES = 3;
+    static constexpr size_t MIN_BLOCK_SIZE = 32;
+    static constexpr size_t MAX_BLOCK_SIZE = MaxBlockSize;
+    static constexpr size_t HEADER_SIZE = 6;
+    static constexpr uint8_t MAX_VALUE_BITS = 24;
+
+    static_assert(MaxBlockSize >= MIN_BLOCK_SIZE, "Block size too small");
+    static_assert(MaxBlockSize * 8 / AXES < UINT16_MAX, "Vector count has to fit in 16 bits");
+
+private:
+    using AdaptiveRice = offline_meas::compression::AdaptiveRice;
+    using BitWriter = offline_meas::compression::BitWriter;
+
+    uint8_t m_buffer[MaxBlockSize];
+    size_t m_blockSize;
+    size_t m_usedBits;
+    uint16_t m_blockSamples;
+    AdaptiveRice m_rice[AXES];
+    uint8_t m_riceK[AXES];
+    int32_t m_history[2][AXES]; // x[n-1], x[n-2]
+    IMUPredictor m_predictor;
+    IMUPredictor m_blockPredictor; // Predictor of the current block
+    uint32_t m_cost[2];            // Residual magnitudes of the first and second order predictors in the block
+    uint8_t m_valueBits;
+    uint8_t m_fractionBits;
+    uint32_t m_maxResidual;
+
+    int32_t predict(IMUPredictor predictor, size_t axis) const
+    {
+        const int32_t x1 = m_history[0][axis];
+        const int32_t x2 = m_history[1][axis];
+
+        // The first residual of a block has only one previous vector
+        if (predictor == IMUPredictor::SecondOrder && m_blockSamples > 1)
+            return 2 * x1 - x2;
+        return x1;
+    }
+
+    static uint32_t magnitude(int32_t value)
+    {
+        return value >= 0 ? value : -value;
+    }
+
+    void push_history(const int32_t* vector)
+    {
+        for (size_t axis = 0; axis < AXES; axis++)
+        {
+            m_history[1][axis] = m_history[0][axis];
+            m_history[0][axis] = vector[axis];
+        }
+    }
+
+    void start_block(const int32_t* first)
+    {
+        memset(m_buffer, 0x00, m_blockSize);
+
+        if (m_predictor == IMUPredictor::Adaptive)
+        {
+            m_blockPredictor = m_cost[1] < m_cost[0] ? IMUPredictor::SecondOrder : IMUPredictor::FirstOrder;
+            m_cost[0] = 0;
+            m_cost[1] = 0;
+        }
+
+        // Restart the statistics from the initial parameters, so that the block can be decoded alone
+        BitWriter writer(m_buffer + HEADER_SIZE, 0);
+        for (size_t axis = 0; axis < AXES; axis++)
+        {
+            m_riceK[axis] = m_rice[axis].parameter();
+            m_rice[axis].start(m_riceK[axis]);
+            writer.write(static_cast<uint32_t>(first[axis]), m_valueBits);
+        }
+        writer.flush();
+
+        m_usedBits = writer.bit_position();
+        m_blockSamples = 1;
+        push_history(first);
+        push_history(first);
+    }
+
+    /// Code the residuals of a vector, returns false if they do not fit in the block
+    bool append(BitWriter& writer, const int32_t* vector)
+    {
+        const uint8_t escapeBits = m_valueBits + 2;
+        const size_t capacity = (m_blockSize - HEADER_SIZE) * 8;
+
+        uint32_t mapped[AXES];
+        uint8_t k[AXES];
+        size_t bits = 0;
+        for (size_t axis = 0; axis < AXES; axis++)
+        {
+            const int32_t residual = vector[axis] - predict(m_blockPredictor, axis);
+            if (magnitude(residual) > m_maxResidual)
+                m_maxResidual = magnitude(residual);
+
+            mapped[axis] = AdaptiveRice::zigzag(residual);
+            k[axis] = m_rice[axis].parameter();
+            bits += AdaptiveRice::code_bits(mapped[axis], k[axis], escapeBits);
+        }
+
+        if (writer.bit_position() + bits > capacity)
+            return false;
+
+        for (size_t axis = 0; axis < AXES; axis++)
+        {
+            AdaptiveRice::write(writer, mapped[axis], k[axis], escapeBits);
+            m_rice[axis].update(mapped[axis]);
+
+            if (m_predictor == IMUPredictor::Adaptive)
+            {
+                m_cost[0] += magnitude(vector[axis] - predict(IMUPredictor::FirstOrder, axis));
+                m_cost[1] += magnitude(vector[axis] - predict(IMUPredictor::SecondOrder, axis));
+            }
+        }
+        push_history(vector);
+        m_blockSamples++;
+        return true;
+    }
+
+    template<typename TSink>
+    void write_block(TSink& sink)
+    {
+        if (m_blockSamples == 0)
+            return;
+
+        m_buffer[0] = m_valueBits;
+        m_buffer[1] = m_fractionBits;
+        m_buffer[2] = m_blockSamples & 0xFF;
+        m_buffer[3] = m_blockSamples >> 8;
+        m_buffer[4] = m_riceK[0] | (m_riceK[1] << 4);
+        m_buffer[5] = m_riceK[2] | (static_cast<uint8_t>(m_blockPredictor) << 4);
+        sink(m_buffer, m_blockSize);
+        m_blockSamples = 0;
+    }
+
+public:
+    void reset()
+    {
+        m_usedBits = 0;
+        m_blockSamples = 0;
+        m_maxResidual = 0;
+        for (size_t axis = 0; axis < AXES; axis++)
+        {
+            m_rice[axis].start(4);
+            m_riceK[axis] = 0;
+        }
+        memset(m_history, 0x00, sizeof(m_history));
+        m_blockPredictor = m_predictor == IMUPredictor::Adaptive ? IMUPredictor::FirstOrder : m_predictor;
+        m_cost[0] = 0;
+        m_cost[1] = 0;
+    }
+
+    IMUCompression()
+        : m_blockSize(MaxBlockSize)
+        , m_predictor(IMUPredictor::FirstOrder)
+        , m_valueBits(MAX_VALUE_BITS)
+        , m_fractionBits(0)
+    {
+        reset();
+    }
+
+    /// Select the block size, resets the compressor
+    bool set_block_size(size_t blockSize)
+    {
+        if (blockSize < MIN_BLOCK_SIZE || blockSize > MaxBlockSize)
+            return false;
+
+        m_blockSize = blockSize;
+        reset();
+        return true;
+    }
+
+    size_t block_size() const
+    {
+        return m_blockSize;
+    }
+
+    /// Select the fixed-point format of the components, resets the compressor.
+    /// Components have to fit in valueBits as signed values.
+    bool set_format(uint8_t valueBits, uint8_t fractionBits)
+    {
+        if (valueBits == 0 || valueBits > MAX_VALUE_BITS || fractionBits > valueBits)
+            return false;
+
+        m_valueBits = valueBits;
+        m_fractionBits = fractionBits;
+        reset();
+        return true;
+    }
+
+    uint8_t value_bits() const
+    {
+        return m_valueBits;
+    }
+
+    uint8_t fraction_bits() const
+    {
+        return m_fractionBits;
+    }
+
+    /// Select the predictor, resets the compressor
+    void set_predictor(IMUPredictor predictor)
+    {
+        m_predictor = predictor;
+        reset();
+    }
+
+    IMUPredictor predictor() const
+    {
+        return m_predictor;
+    }
+
+    /// Number of vectors in the current block
+    size_t block_samples() const
+    {
+        return m_blockSamples;
+    }
+
+    /// Largest prediction residual magnitude since reset
+    uint32_t max_residual() const
+    {
+        return m_maxResidual;
+    }
+
+    /// Compress count vectors of interleaved x, y, z components
+    template<typename TSink>
+    size_t pack_continuous(const int32_t* vectors, size_t count, TSink&& sink)
+    {
+        size_t processed = 0;
+        while (processed < count)
+        {
+            if (m_blockSamples == 0) // Start a new block with absolute initial vector
+            {
+                start_block(vectors + processed * AXES);
+                processed += 1;
+                continue;
+            }
+
+            BitWriter writer(m_buffer + HEADER_SIZE, m_usedBits);
+            bool full = false;
+            while (processed < count)
+            {
+                if (!append(writer, vectors + processed * AXES))
+                {
+                    full = true;
+                    break;
+                }
+                processed += 1;
+            }
+
+            writer.flush();
+            m_usedBits = writer.bit_position();
+
+            if (full)
+                write_block(sink);
+        }
+
+        return processed;
+    }
+
+    template<typename TSink>
+    void dump_buffer(TSink&& sink)
+    {
+        write_block(sink);
+    }
+};
@@ -0,0 +1,166 @@
+#pragma once
+#include <cstdlib>
+#include <cstring>
+
+#include "BitWriter.hpp"
+#include "RiceCoder.hpp"
+
+/// Compression of RR-intervals (/Offline/Meas/RR/Compressed).
+///
+/// Block layout
+///   [0]    number of intervals
+///   [1]    bits 0-3 initial Rice parameter
+///   [2..]  MSB first: the first interval in 16 bits, followed by the differences
+///          of the following intervals to their previous ones.
+///
+/// The differences are zigzag mapped and coded with an adaptive Rice code (AdaptiveRice),
+/// restarted from the parameter in the header at the start of each block.
+/// The escape width is 17 bits. Unused bits at the end of the block are zero.
+///
+/// Completed blocks are passed to a sink, any callable with signature
+/// void(uint8_t* block, size_t size).
+template<size_t BlockSize>
+class RRCompression
+{
+public:
+    static constexpr size_t HEADER_SIZE = 2;
+    static constexpr uint8_t VALUE_BITS = 16;
+    static constexpr uint8_t ESCAPE_BITS = VALUE_BITS + 1;
+
+    static_assert(BlockSize > HEADER_SIZE + VALUE_BITS / 8, "Block size too small");
+    static_assert(1 + (BlockSize - HEADER_SIZE) * 8 - VALUE_BITS <= UINT8_MAX, "Interval count has to fit in 8 bits");
+
+private:
+    using AdaptiveRice = offline_meas::compression::AdaptiveRice;
+    using BitWriter = offline_meas::compression::BitWriter;
+
+    uint8_t m_buffer[BlockSize];
+    size_t m_usedBits;
+    uint8_t m_blockSamples;
+    AdaptiveRice m_rice;
+    uint8_t m_riceK;
+    uint16_t m_previous;
+    uint32_t m_maxResidual;
+
+    void start_block(uint16_t first)
+    {
+        memset(m_buffer, 0x00, BlockSize);
+
+        // Restart the statistics from the initial parameter, so that the block can be decoded alone
+        m_riceK = m_rice.parameter();
+        m_rice.start(m_riceK);
+
+        BitWriter writer(m_buffer + HEADER_SIZE, 0);
+        writer.write(first, VALUE_BITS);
+        writer.flush();
+
+        m_usedBits = writer.bit_position();
+        m_blockSamples = 1;
+        m_previous = first;
+    }
+
+    /// Code the difference of an interval, returns false if it does not fit in the block
+    bool append(BitWriter& writer, uint16_t interval)
+    {
+        const size_t capacity = (BlockSize - HEADER_SIZE) * 8;
+        const int32_t residual = static_cast<int32_t>(interval) - m_previous;
+        const uint32_t mapped = AdaptiveRice::zigzag(residual);
+        const uint8_t k = m_rice.parameter();
+
+        if (writer.bit_position() + AdaptiveRice::code_bits(mapped, k, ESCAPE_BITS) > capacity)
+            return false;
+
+        AdaptiveRice::write(writer, mapped, k, ESCAPE_BITS);
+        m_rice.update(mapped);
+
+        const uint32_t magnitude = residual >= 0 ? residual : -residual;
+        if (magnitude > m_maxResidual)
+            m_maxResidual = magnitude;
+
+        m_previous = interval;
+        m_blockSamples++;
+        return true;
+    }
+
+    template<typename TSink>
+    void write_block(TSink& sink)
+    {
+        if (m_blockSamples == 0)
+            return;
+
+        m_buffer[0] = m_blockSamples;
+        m_buffer[1] = m_riceK;
+        sink(m_buffer, BlockSize);
+        m_blockSamples = 0;
+    }
+
+public:
+    void reset()
+    {
+        m_usedBits = 0;
+        m_blockSamples = 0;
+        m_rice.start(4);
+        m_riceK = 0;
+        m_previous = 0;
+        m_maxResidual = 0;
+    }
+
+    RRCompression()
+    {
+        reset();
+    }
+
+    /// Number of intervals in the current block
+    size_t block_samples() const
+    {
+        return m_blockSamples;
+    }
+
+    /// Largest difference between successive intervals since reset
+    uint32_t max_residual() const
+    {
+        return m_maxResidual;
+    }
+
+    /// Compress count intervals (ms)
+    template<typename TSink>
+    size_t pack_continuous(const uint16_t* intervals, size_t count, TSink&& sink)
+    {
+        size_t processed = 0;
+        while (processed < count)
+        {
+            if (m_blockSamples == 0) // Start a new block with absolute initial interval
+            {
+                start_block(intervals[processed]);
+                processed += 1;
+                continue;
+            }
+
+            BitWriter writer(m_buffer + HEADER_SIZE, m_usedBits);
+            bool full = false;
+            while (processed < count)
+            {
+                if (!append(writer, intervals[processed]))
+                {
+                    full = true;
+                    break;
+                }
+                processed += 1;
+            }
+
+            writer.flush();
+            m_usedBits = writer.bit_position();
+
+            if (full)
+                write_block(sink);
+        }
+
+        return processed;
+    }
+
+    template<typename TSink>
+    void dump_buffer(TSink&& sink)
+    {
+        write_block(sink);
+    }
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "BitWriter.hpp"
+
+namespace offline_meas::compression
+{
+    /// Backward adaptive Rice coder.
+    ///
+    /// Values are zigzag mapped (d >= 0 -> 2d, d < 0 -> -2d - 1). The parameter k of each
+    /// value is the smallest k for which N * 2^k >= A, where A is the sum of the previous
+    /// mapped values and N their count. A and N are halved when N reaches STATS_WINDOW.
+    /// Coding starts from an initial k (A = 2^k, N = 1) that the decoder has to know.
+    ///
+    /// Codes with quotient >= ESCAPE are written as ESCAPE zeros, a one and the mapped
+    /// value in escapeBits bits.
+    class AdaptiveRice
+    {
+    public:
+        static constexpr uint8_t ESCAPE = 16;
+        static constexpr uint8_t MAX_K = 15;
+        static constexpr uint32_t STATS_WINDOW = 8;
+
+    private:
+        uint32_t m_sum;
+        uint32_t m_count;
+
+    public:
+        explicit AdaptiveRice(uint8_t initialK = 4)
+        {
+            start(initialK);
+        }
+
+        static uint32_t zigzag(int32_t value)
+        {
+            return value >= 0
+                ? (static_cast<uint32_t>(value) << 1)
+                : (static_cast<uint32_t>(-value) << 1) - 1;
+        }
+
+        /// Restart the statistics from initial parameter k
+        void start(uint8_t k)
+        {
+            m_sum = 1u << k;
+            m_count = 1;
+        }
+
+        /// Smallest k for which count * 2^k >= sum of the mapped values
+        static uint8_t parameter(uint32_t sum, uint32_t count)
+        {
+            if (sum <= count)
+                return 0;
+
+            // count << k has the same bit length as the sum, or is one bit longer after correction
+            uint8_t k = floor_log2(sum) - floor_log2(count);
+            if ((count << k) < sum)
+                k++;
+            return k < MAX_K ? k : MAX_K;
+        }
+
+        uint8_t parameter() const
+        {
+            return parameter(m_sum, m_count);
+        }
+
+        /// Code length of a mapped value with parameter k
+        static size_t code_bits(uint32_t mapped, uint8_t k, uint8_t escapeBits)
+        {
+            uint32_t quotient = mapped >> k;
+            return quotient >= ESCAPE
+                ? ESCAPE + 1 + escapeBits
+                : quotient + 1 + k;
+        }
+
+        /// Write a mapped value with parameter k
+        static void write(BitWriter& writer, uint32_t mapped, uint8_t k, uint8_t escapeBits)
+        {
+            uint32_t quotient = mapped >> k;
+            if (quotient >= ESCAPE)
+            {
+                writer.write_zeros(ESCAPE);
+                writer.write(1, 1);
+                writer.write(mapped, escapeBits);
+            }
+            else
+            {
+                // Unary quotient terminated with a one, then k remainder bits
+                writer.write_zeros(quotient);
+                writer.write((1u << k) | mapped, k + 1);
+            }
+        }
+
+        void update(uint32_t mapped)
+        {
+            m_sum += mapped;
+            m_count += 1;
+            if (m_count >= STATS_WINDOW)
+            {
+                m_sum >>= 1;
+                m_count >>= 1;
+            }
+        }
+    };
+} // namespace offline_meas::compression
@@ -0,0 +1,268 @@
+#pragma once
+#include <cstdlib>
+#include <cstring>
+
+#include "BitWriter.hpp"
+
+/// Compression of slow time-series, such as HR, temperature and activity
+/// (/Offline/Meas/{HR,Temp,Activity}/Compressed).
+///
+/// The timestamp of the first reading is sent with the block.
+///
+/// Block layout
+///   [0]    number of readings
+///   [1]    bits 0-4 value bits, bit 7 set for signed values
+///   [2..]  MSB first: the first value in value bits, followed by a timestamp code
+///          and a value code for each following reading.
+///
+/// Timestamp codes carry the delta-of-delta of the timestamps (ms), two's complement:
+///   0                 same interval as before (the interval before the second reading is 0)
+///   10   + 8 bits     -128 ... 127
+///   110  + 12 bits    -2048 ... 2047
+///   1110 + 16 bits    -32768 ... 32767
+///   1111 + 32 bits    any
+///
+/// Value codes carry the difference to the previous value, two's complement:
+///   0                 no change
+///   10 + 4 bits       -8 ... 7
+///   11 + value bits + 1
+///
+/// A block is completed when the next reading does not fit, or when the next reading
+/// (or expire()) is the max age or more after the first one of the block. Completed
+/// blocks are rounded up to 8, 16 or BlockSize bytes and passed to a sink, any callable
+/// with signature void(uint8_t* block, size_t size, uint32_t timestamp).
+template<size_t BlockSize>
+class SlowCompression
+{
+public:
+    static constexpr size_t HEADER_SIZE = 2;
+    static constexpr uint8_t MAX_VALUE_BITS = 16;
+    static constexpr uint8_t SIGNED_FLAG = 0x80;
+
+    static_assert(BlockSize >= 16, "Blocks are rounded up to 8, 16 or BlockSize bytes");
+
+private:
+    using BitWriter = offline_meas::compression::BitWriter;
+
+    uint8_t m_buffer[BlockSize];
+    size_t m_usedBits;
+    uint8_t m_blockSamples;
+    uint8_t m_valueBits;
+    bool m_signed;
+    uint32_t m_maxAge;
+
+    uint32_t m_firstTimestamp;
+    uint32_t m_previousTimestamp;
+    int32_t m_previousDelta;
+    int32_t m_previousValue;
+    uint32_t m_maxResidual;
+
+    static bool fits(int32_t value, uint8_t bits)
+    {
+        return value >= -(1 << (bits - 1)) && value < (1 << (bits - 1));
+    }
+
+    static size_t timestamp_code_bits(int32_t dod)
+    {
+        if (dod == 0)
+            return 1;
+        if (fits(dod, 8))
+            return 2 + 8;
+        if (fits(dod, 12))
+            return 3 + 12;
+        if (fits(dod, 16))
+            return 4 + 16;
+        return 4 + 32;
+    }
+
+    static void write_timestamp_code(BitWriter& writer, int32_t dod)
+    {
+        const uint32_t bits = static_cast<uint32_t>(dod);
+        if (dod == 0)
+            writer.write(0b0, 1);
+        else if (fits(dod, 8))
+        {
+            writer.write(0b10, 2);
+            writer.write(bits, 8);
+        }
+        else if (fits(dod, 12))
+        {
+            writer.write(0b110, 3);
+            writer.write(bits, 12);
+        }
+        else if (fits(dod, 16))
+        {
+            writer.write(0b1110, 4);
+            writer.write(bits, 16);
+        }
+        else
+        {
+            writer.write(0b1111, 4);
+            writer.write(bits, 32);
+        }
+    }
+
+    size_t value_code_bits(int32_t delta) const
+    {
+        if (delta == 0)
+            return 1;
+        if (fits(delta, 4))
+            return 2 + 4;
+        return 2 + m_valueBits + 1;
+    }
+
+    void write_value_code(BitWriter& writer, int32_t delta) const
+    {
+        const uint32_t bits = static_cast<uint32_t>(delta);
+        if (delta == 0)
+            writer.write(0b0, 1);
+        else if (fits(delta, 4))
+        {
+            writer.write(0b10, 2);
+            writer.write(bits, 4);
+        }
+        else
+        {
+            writer.write(0b11, 2);
+            writer.write(bits, m_valueBits + 1);
+        }
+    }
+
+    void start_block(int32_t value, uint32_t timestamp)
+    {
+        memset(m_buffer, 0x00, BlockSize);
+
+        BitWriter writer(m_buffer + HEADER_SIZE, 0);
+        writer.write(static_cast<uint32_t>(value), m_valueBits);
+        writer.flush();
+
+        m_usedBits = writer.bit_position();
+        m_blockSamples = 1;
+        m_firstTimestamp = timestamp;
+        m_previousTimestamp = timestamp;
+        m_previousDelta = 0;
+        m_previousValue = value;
+    }
+
+    /// Code a reading, returns false if it does not fit in the block
+    bool append(int32_t value, uint32_t timestamp)
+    {
+        const size_t capacity = (BlockSize - HEADER_SIZE) * 8;
+        const int32_t delta = static_cast<int32_t>(timestamp - m_previousTimestamp);
+        const int32_t dod = delta - m_previousDelta;
+        const int32_t change = value - m_previousValue;
+
+        if (m_blockSamples == UINT8_MAX ||
+            m_usedBits + timestamp_code_bits(dod) + value_code_bits(change) > capacity)
+            return false;
+
+        BitWriter writer(m_buffer + HEADER_SIZE, m_usedBits);
+        write_timestamp_code(writer, dod);
+        write_value_code(writer, change);
+        writer.flush();
+        m_usedBits = writer.bit_position();
+
+        const uint32_t magnitude = change >= 0 ? change : -change;
+        if (magnitude > m_maxResidual)
+            m_maxResidual = magnitude;
+
+        m_previousTimestamp = timestamp;
+        m_previousDelta = delta;
+        m_previousValue = value;
+        m_blockSamples++;
+        return true;
+    }
+
+    template<typename TSink>
+    void write_block(TSink& sink)
+    {
+        if (m_blockSamples == 0)
+            return;
+
+        m_buffer[0] = m_blockSamples;
+        m_buffer[1] = m_valueBits | (m_signed ? SIGNED_FLAG : 0);
+
+        const size_t used = HEADER_SIZE + (m_usedBits + 7) / 8;
+        const size_t size = used <= 8 ? 8 : (used <= 16 ? 16 : BlockSize);
+        sink(m_buffer, size, m_firstTimestamp);
+        m_blockSamples = 0;
+    }
+
+public:
+    void reset()
+    {
+        m_usedBits = 0;
+        m_blockSamples = 0;
+        m_firstTimestamp = 0;
+        m_previousTimestamp = 0;
+        m_previousDelta = 0;
+        m_previousValue = 0;
+        m_maxResidual = 0;
+    }
+
+    SlowCompression()
+        : m_valueBits(8)
+        , m_signed(false)
+        , m_maxAge(0)
+    {
+        reset();
+    }
+
+    /// Select the format of the values, resets the compressor
+    bool set_format(uint8_t valueBits, bool isSigned)
+    {
+        if (valueBits == 0 || valueBits > MAX_VALUE_BITS)
+            return false;
+
+        m_valueBits = valueBits;
+        m_signed = isSigned;
+        reset();
+        return true;
+    }
+
+    /// Complete blocks when a reading is maxAge (ms) or more after the first one, 0 disables
+    void set_max_age(uint32_t maxAge)
+    {
+        m_maxAge = maxAge;
+    }
+
+    /// Number of readings in the current block
+    size_t block_samples() const
+    {
+        return m_blockSamples;
+    }
+
+    /// Largest difference between successive values since reset
+    uint32_t max_residual() const
+    {
+        return m_maxResidual;
+    }
+
+    /// Compress a reading, value has to fit in the value bits
+    template<typename TSink>
+    void pack(int32_t value, uint32_t timestamp, TSink&& sink)
+    {
+        expire(timestamp, sink);
+
+        if (m_blockSamples > 0 && !append(value, timestamp))
+            write_block(sink);
+
+        if (m_blockSamples == 0)
+            start_block(value, timestamp);
+    }
+
+    /// Complete the current block if its first reading is the max age or more before now (ms).
+    /// Called from a timer, so blocks also complete when the readings stop.
+    template<typename TSink>
+    void expire(uint32_t now, TSink&& sink)
+    {
+        if (m_blockSamples > 0 && m_maxAge > 0 && now - m_firstTimestamp >= m_maxAge)
+            write_block(sink);
+    }
+
+    template<typename TSink>
+    void dump_buffer(TSink&& sink)
+    {
+        write_block(sink);
+    }
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace offline_meas::decoding
+{
+    /// MSB-first bit reader. Reads past the end of the buffer return zero bits.
+    class BitReader
+    {
+    private:
+        const uint8_t* m_data;
+        size_t m_size;
+        size_t m_bitPos;
+
+    public:
+        BitReader(const uint8_t* data, size_t size, size_t bitOffset = 0)
+            : m_data(data)
+            , m_size(size)
+            , m_bitPos(bitOffset)
+        {
+        }
+
+        /// Next 32 bits, first bit in the MSB
+        uint32_t peek32() const
+        {
+            size_t byte = m_bitPos >> 3;
+            uint64_t word = 0;
+
+            if (byte + sizeof(word) <= m_size)
+            {
+                memcpy(&word, m_data + byte, sizeof(word));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+                word = __builtin_bswap64(word);
+#endif
+            }
+            else
+            {
+                for (size_t i = 0; i < sizeof(word) && byte + i < m_size; i++)
+                    word |= uint64_t(m_data[byte + i]) << (56 - 8 * i);
+            }
+
+            return static_cast<uint32_t>((word << (m_bitPos & 7)) >> 32);
+        }
+
+        /// Read count (<= 32) bits as an unsigned value
+        uint32_t read(uint8_t count)
+        {
+            if (count == 0)
+                return 0;
+
+            uint32_t value = peek32() >> (32 - count);
+            m_bitPos += count;
+            return value;
+        }
+
+        void skip(size_t count)
+        {
+            m_bitPos += count;
+        }
+
+        size_t bit_position() const
+        {
+            return m_bitPos;
+        }
+
+        size_t bits_left() const
+        {
+            return m_bitPos < m_size * 8 ? m_size * 8 - m_bitPos : 0;
+        }
+    };
+} // namespace offline_meas::decoding
@@ -0,0 +1,13 @@
+#pragma once
+// Host-side decoders for the offline measurement formats.
+// These headers do not depend on the Movesense core library.
+
+#include "BitReader.hpp"
+#include "ECGDecoder.hpp"
+#include "FixedPointDecoder.hpp"
+#include "IMUDecoder.hpp"
+#include "RRDecoder.hpp"
+#include "RecordDecoder.hpp"
+#include "RiceDecoder.hpp"
+#include "SlowDecoder.hpp"
+#include "SyncDecoder.hpp"
@@ -0,0 +1,689 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "BitReader.hpp"
+#include "RiceDecoder.hpp"
+
+namespace offline_meas::decoding
+{
+    /// Lookup table for short Elias Gamma codes (bijection mapped deltas).
+    /// Indexed with the next TABLE_BITS bits of the stream.
+    struct GammaTable
+    {
+        static constexpr uint8_t TABLE_BITS = 12;
+
+        struct Entry
+        {
+            int16_t delta;
+            uint8_t length; // 0 if the code does not fit in the table
+        } entries[1 << TABLE_BITS];
+
+        GammaTable()
+        {
+            for (uint32_t i = 0; i < (1u << TABLE_BITS); i++)
+            {
+                entries[i] = {};
+                uint32_t bits = i << (32 - TABLE_BITS);
+                if (bits == 0)
+                    continue;
+
+                uint8_t n = __builtin_clz(bits);
+                uint8_t length = n * 2 + 1;
+                if (length > TABLE_BITS)
+                    continue;
+
+                uint32_t code = bits >> (32 - length);
+                entries[i].delta = (code & 1) ? (code >> 1) : -static_cast<int32_t>(code >> 1);
+                entries[i].length = length;
+            }
+        }
+
+        static const GammaTable& get()
+        {
+            static const GammaTable table;
+            return table;
+        }
+    };
+
+    /// Decode one bijection mapped Elias Gamma code. Returns false on a truncated stream.
+    inline bool read_gamma(BitReader& reader, const GammaTable& table, int32_t& delta)
+    {
+        uint32_t bits = reader.peek32();
+        const GammaTable::Entry& entry = table.entries[bits >> (32 - GammaTable::TABLE_BITS)];
+
+        if (entry.length > 0)
+        {
+            delta = entry.delta;
+        }
+        else
+        {
+            if (bits == 0)
+                return false; // Only padding left
+
+            // n zeros followed by n + 1 bits of code
+            uint8_t n = __builtin_clz(bits);
+            if (reader.bits_left() < size_t(n) * 2 + 1)
+                return false;
+
+            reader.skip(n);
+            uint32_t code = reader.read(n + 1);
+            delta = (code & 1) ? (code >> 1) : -static_cast<int32_t>(code >> 1);
+            return true;
+        }
+
+        if (reader.bits_left() < entry.length)
+            return false;
+        reader.skip(entry.length);
+        return true;
+    }
+
+    /// Decode one unmapped Elias Gamma code (value >= 1). Returns false on a truncated stream.
+    inline bool read_elias_gamma(BitReader& reader, uint32_t& value)
+    {
+        uint32_t bits = reader.peek32();
+        if (bits == 0)
+            return false; // Only padding left
+
+        uint8_t n = __builtin_clz(bits);
+        if (reader.bits_left() < size_t(n) * 2 + 1)
+            return false;
+
+        reader.skip(n);
+        value = reader.read(n + 1);
+        return true;
+    }
+
+    /// Coders of the extended block layout
+    enum class ECGCoding : uint8_t
+    {
+        Gamma = 0,
+        Rice = 1,
+        Raw = 2,
+        ZeroRun = 3,
+    };
+
+    /// Predictors of the extended block layout
+    enum class ECGPredictor : uint8_t
+    {
+        FirstOrder = 0,
+        ZeroOrder = 1,
+        SecondOrder = 2,
+        LPC = 3,
+    };
+
+    /// Zero run coded residuals: Elias Gamma (run + 1) zeros, followed by an Elias Gamma
+    /// coded zigzag mapped non-zero residual, which is left out at the end of the block
+    struct ZeroRunState
+    {
+        uint32_t zeros = 0;
+        bool value = false; // A non-zero residual follows the zeros
+
+        bool read(BitReader& reader, int32_t& delta)
+        {
+            if (zeros == 0 && !value)
+            {
+                uint32_t run = 0;
+                if (!read_elias_gamma(reader, run))
+                    return false;
+                zeros = run - 1;
+                value = true;
+            }
+
+            if (zeros > 0)
+            {
+                zeros--;
+                delta = 0;
+                return true;
+            }
+
+            uint32_t mapped = 0;
+            if (!read_elias_gamma(reader, mapped))
+                return false;
+            value = false;
+            delta = (mapped & 1) ? -static_cast<int32_t>((mapped + 1) >> 1) : static_cast<int32_t>(mapped >> 1);
+            return true;
+        }
+    };
+
+    /// Running average beat template of beat template blocks, mirrors the encoder
+    /// (compression/ECGBeatTemplate.hpp). The template continues over blocks, so
+    /// the same instance has to decode all blocks of a stream in order.
+    class ECGBeatTemplate
+    {
+    public:
+        static constexpr size_t LENGTH = 128;
+        static constexpr uint16_t REFRACTORY = 48;
+        static constexpr uint16_t DECAY_INTERVAL = 64;
+        static constexpr uint8_t FRACTION_BITS = 3;
+        static constexpr uint8_t ADAPT_SHIFT = 3;
+
+    private:
+        static constexpr uint16_t NO_BEAT = 0xFFFF;
+
+        int16_t m_values[LENGTH];
+        int32_t m_x1;
+        int32_t m_x2;
+        int32_t m_level;
+        int32_t m_beatMax;
+        uint16_t m_sinceBeat;
+        bool m_primed;
+
+        size_t index() const
+        {
+            return m_sinceBeat < LENGTH - 1 ? m_sinceBeat + 1 : LENGTH;
+        }
+
+    public:
+        ECGBeatTemplate()
+        {
+            reset();
+        }
+
+        void reset()
+        {
+            for (size_t i = 0; i < LENGTH; i++)
+                m_values[i] = 0;
+            m_x1 = 0;
+            m_x2 = 0;
+            m_level = 0;
+            m_beatMax = 0;
+            m_sinceBeat = NO_BEAT;
+            m_primed = false;
+        }
+
+        /// Correction to the base prediction of the next sample
+        int32_t prediction() const
+        {
+            const size_t i = index();
+            return i < LENGTH ? (m_values[i] + (1 << (FRACTION_BITS - 1))) >> FRACTION_BITS : 0;
+        }
+
+        /// Beat detection from the slope |x[n] - x[n-2]|
+        void advance(int32_t sample)
+        {
+            if (!m_primed)
+            {
+                m_x1 = sample;
+                m_x2 = sample;
+                m_primed = true;
+            }
+
+            const int32_t slope = sample >= m_x2 ? sample - m_x2 : m_x2 - sample;
+            m_x2 = m_x1;
+            m_x1 = sample;
+
+            if (m_sinceBeat < NO_BEAT)
+                m_sinceBeat++;
+
+            if (m_sinceBeat <= REFRACTORY)
+            {
+                if (slope > m_beatMax)
+                    m_beatMax = slope;
+                if (m_sinceBeat == REFRACTORY)
+                    m_level += (m_beatMax - m_level) >> 2;
+            }
+            else if (slope > (m_level >> 1))
+            {
+                m_sinceBeat = 0;
+                m_beatMax = slope;
+            }
+            else if (m_sinceBeat % DECAY_INTERVAL == 0)
+            {
+                m_level -= m_level >> 3;
+            }
+        }
+
+        /// Learn the base prediction residual of the next sample and advance
+        void update(int32_t sample, int32_t residual)
+        {
+            const size_t i = index();
+            if (i < LENGTH)
+            {
+                constexpr int32_t limit = INT16_MAX >> FRACTION_BITS;
+                const int32_t target = (residual > limit ? limit : residual < -limit ? -limit : residual) * (1 << FRACTION_BITS);
+                m_values[i] += (target - m_values[i]) >> ADAPT_SHIFT;
+            }
+            advance(sample);
+        }
+    };
+
+    /// Prediction for sample index of a block, mirrors the encoder
+    template<typename TSample>
+    inline int32_t ecg_predict(ECGPredictor predictor, const TSample* out, size_t index)
+    {
+        const int32_t x1 = out[index - 1];
+        switch (predictor)
+        {
+        case ECGPredictor::ZeroOrder:
+            return 0;
+        case ECGPredictor::SecondOrder:
+            return index < 2 ? x1 : 2 * x1 - out[index - 2];
+        case ECGPredictor::LPC:
+            if (index < 2)
+                return x1;
+            if (index < 3)
+                return 2 * x1 - out[index - 2];
+            return (84 * x1 - 77 * out[index - 2] + 25 * out[index - 3] + 16) >> 5;
+        case ECGPredictor::FirstOrder:
+        default:
+            return x1;
+        }
+    }
+
+    /// Reconstruction of near-lossless blocks: residuals are multiples of
+    /// 2 * max error + 1 and samples are clamped to the bit depth
+    struct ECGQuantization
+    {
+        int32_t step;
+        int32_t minValue;
+        int32_t maxValue;
+
+        ECGQuantization(uint8_t maxError = 0, uint8_t bitDepth = 16)
+            : step(2 * maxError + 1)
+            , minValue(-(1 << (bitDepth - 1)))
+            , maxValue((1 << (bitDepth - 1)) - 1)
+        {
+        }
+    };
+
+    /// Decode the coded residuals of a block, following the beat template if there is one
+    template<ECGPredictor Predictor, typename TSample, typename TRead>
+    inline size_t decode_ecg_residuals(BitReader& reader, TSample first, TSample* out, size_t count, TRead read,
+        const ECGQuantization& quantization, ECGBeatTemplate* beatTemplate)
+    {
+        out[0] = first;
+        if (beatTemplate)
+            beatTemplate->advance(first);
+
+        for (size_t i = 1; i < count; i++)
+        {
+            int32_t residual = 0;
+            if (!read(reader, residual))
+                return i;
+
+            const int32_t base = ecg_predict(Predictor, out, i);
+            int32_t value = beatTemplate ? base + beatTemplate->prediction() : base;
+            if (quantization.step > 1)
+            {
+                value += residual * quantization.step;
+                if (value > quantization.maxValue)
+                    value = quantization.maxValue;
+                else if (value < quantization.minValue)
+                    value = quantization.minValue;
+            }
+            else
+            {
+                value += residual;
+            }
+            out[i] = static_cast<TSample>(value);
+            if (beatTemplate)
+                beatTemplate->update(value, value - base);
+        }
+        return count;
+    }
+
+    template<typename TSample, typename TRead>
+    inline size_t decode_ecg_residuals(ECGPredictor predictor, BitReader& reader, TSample first, TSample* out, size_t count, TRead read,
+        const ECGQuantization& quantization, ECGBeatTemplate* beatTemplate = nullptr)
+    {
+        switch (predictor)
+        {
+        case ECGPredictor::ZeroOrder:
+            return decode_ecg_residuals<ECGPredictor::ZeroOrder>(reader, first, out, count, read, quantization, beatTemplate);
+        case ECGPredictor::SecondOrder:
+            return decode_ecg_residuals<ECGPredictor::SecondOrder>(reader, first, out, count, read, quantization, beatTemplate);
+        case ECGPredictor::LPC:
+            return decode_ecg_residuals<ECGPredictor::LPC>(reader, first, out, count, read, quantization, beatTemplate);
+        case ECGPredictor::FirstOrder:
+        default:
+            return decode_ecg_residuals<ECGPredictor::FirstOrder>(reader, first, out, count, read, quantization, beatTemplate);
+        }
+    }
+
+    /// Beat template blocks use the extended layout with these markers,
+    /// the restart marker resets the template before the block
+    constexpr uint8_t ECG_TEMPLATE_BLOCK_MARKER = 0xFE;
+    constexpr uint8_t ECG_TEMPLATE_RESTART_BLOCK_MARKER = 0xFD;
+
+    /// True for the blocks with the extended header: extended and beat template blocks
+    inline bool ecg_block_extended(const uint8_t* block)
+    {
+        return block[0] == 0 || block[0] == ECG_TEMPLATE_BLOCK_MARKER || block[0] == ECG_TEMPLATE_RESTART_BLOCK_MARKER;
+    }
+
+    /// Wavelet coded blocks start with this marker
+    constexpr uint8_t ECG_WAVELET_BLOCK_MARKER = 0xFF;
+    constexpr size_t ECG_WAVELET_HEADER_SIZE = 5;
+    constexpr uint8_t ECG_WAVELET_WINDOW_LENGTH_BITS = 7;
+    constexpr size_t ECG_WAVELET_MAX_WINDOW = 1 << ECG_WAVELET_WINDOW_LENGTH_BITS;
+    constexpr uint8_t ECG_WAVELET_MAX_LEVELS = 5;
+
+    /// Sample bit depth of a compressed ECG block: 16 for the original layout,
+    /// up to 23 for the extended and wavelet layouts. Use int32_t output for more than 16 bits.
+    inline uint8_t ecg_block_bit_depth(const uint8_t* block)
+    {
+        if (block[0] == ECG_WAVELET_BLOCK_MARKER)
+            return 16 + ((block[1] >> 3) & 0x07);
+        return !ecg_block_extended(block) ? 16 : 16 + ((block[3] >> 4) & 0x07);
+    }
+
+    /// Maximum reconstruction error of a compressed ECG block, 0 for lossless blocks.
+    /// Thresholded wavelet blocks have no strict bound and are not reported here.
+    inline uint8_t ecg_block_max_error(const uint8_t* block)
+    {
+        return (ecg_block_extended(block) && (block[3] & 0x80)) ? block[4] : 0;
+    }
+
+    /// Number of 5/3 wavelet levels applied to a window of count samples
+    inline uint8_t ecg_wavelet_window_levels(size_t count, uint8_t levels)
+    {
+        uint8_t applied = 0;
+        while (applied < levels && count >= 2)
+        {
+            count = (count + 1) / 2;
+            applied++;
+        }
+        return applied;
+    }
+
+    /// One level of the inverse 5/3 lifting on x[i * stride], i < count (count >= 2)
+    inline void ecg_wavelet_lift_inverse(int32_t* x, size_t count, size_t stride)
+    {
+        const size_t details = count / 2;
+        const size_t approximations = count - details;
+
+        for (size_t i = 0; i < approximations; i++)
+        {
+            int32_t left = i > 0 ? x[(2 * i - 1) * stride] : x[stride];
+            int32_t right = i < details ? x[(2 * i + 1) * stride] : left;
+            x[2 * i * stride] -= (left + right + 2) >> 2;
+        }
+
+        for (size_t i = 0; i < details; i++)
+        {
+            int32_t left = x[2 * i * stride];
+            int32_t right = 2 * i + 2 < count ? x[(2 * i + 2) * stride] : left;
+            x[(2 * i + 1) * stride] += (left + right) >> 1;
+        }
+    }
+
+    /// Read a Rice coded subband of a wavelet window. Returns false on a truncated stream.
+    inline bool read_ecg_wavelet_subband(BitReader& reader, RiceState& rice, int32_t* x, size_t first, size_t step,
+        size_t count, int32_t* previous)
+    {
+        for (size_t j = 0; j < count; j++)
+        {
+            int32_t value = 0;
+            if (!read_rice(reader, rice, value))
+                return false;
+
+            if (previous) // Approximation deltas
+            {
+                value += *previous;
+                *previous = value;
+            }
+            x[first + j * step] = value;
+        }
+        return true;
+    }
+
+    /// Decode a wavelet coded ECG block.
+    ///
+    /// Layout:
+    ///   [0]    0xFF
+    ///   [1]    bits 0-2 wavelet levels, bits 3-5 sample bit depth - 16,
+    ///          bits 6-7 window size (16 << value samples)
+    ///   [2]    detail coefficient threshold, 0 for lossless
+    ///   [3..4] number of samples in the block (uint16, little-endian)
+    ///   [5..]  MSB first: initial Rice parameter (4 bits) of the approximation subband and
+    ///          the detail subbands of levels 1 to levels. Then windows: a one for a full window,
+    ///          or a zero and window length - 1 (7 bits), followed by the coefficients of the
+    ///          approximation subband and the detail subbands from the coarsest level to the finest.
+    ///          With a threshold, each detail subband starts with a zero if all of its coefficients
+    ///          are zero (and are omitted), or with a one.
+    ///
+    /// Each subband has an adaptive Rice state that continues over the windows of the block.
+    /// Approximation coefficients are deltas that continue over the windows of the block.
+    /// Windows are inverse transformed with the integer 5/3 lifting wavelet.
+    template<typename TSample>
+    inline size_t decode_ecg_wavelet_block(const uint8_t* block, size_t blockSize, TSample* out, size_t maxSamples)
+    {
+        if (blockSize < ECG_WAVELET_HEADER_SIZE || block[0] != ECG_WAVELET_BLOCK_MARKER)
+            return 0;
+
+        const uint8_t levels = block[1] & 0x07;
+        const bool thresholded = block[2] > 0;
+        const uint8_t bitDepth = ecg_block_bit_depth(block);
+        const size_t windowSize = size_t(16) << (block[1] >> 6);
+        if (levels == 0 || levels > ECG_WAVELET_MAX_LEVELS || bitDepth > sizeof(TSample) * 8)
+            return 0;
+
+        const size_t count = block[3] | (block[4] << 8);
+        BitReader reader(block + ECG_WAVELET_HEADER_SIZE, blockSize - ECG_WAVELET_HEADER_SIZE);
+        if (reader.bits_left() < size_t(levels + 1) * 4)
+            return 0;
+
+        RiceState rice[ECG_WAVELET_MAX_LEVELS + 1] = { RiceState(0), RiceState(0), RiceState(0), RiceState(0), RiceState(0), RiceState(0) };
+        for (uint8_t band = 0; band <= levels; band++)
+            rice[band] = RiceState(static_cast<uint8_t>(reader.read(4)));
+
+        int32_t x[ECG_WAVELET_MAX_WINDOW];
+        int32_t approximation = 0;
+        size_t decoded = 0;
+        while (decoded < count && decoded < maxSamples)
+        {
+            if (reader.bits_left() < 1)
+                return decoded;
+
+            size_t windowLength = windowSize;
+            if (reader.read(1) == 0)
+            {
+                if (reader.bits_left() < ECG_WAVELET_WINDOW_LENGTH_BITS)
+                    return decoded;
+                windowLength = reader.read(ECG_WAVELET_WINDOW_LENGTH_BITS) + 1;
+            }
+            if (decoded + windowLength > count)
+                return decoded; // Corrupted
+
+            const uint8_t windowLevels = ecg_wavelet_window_levels(windowLength, levels);
+            const uint8_t escapeBits = bitDepth + windowLevels + 2;
+            for (uint8_t band = 0; band <= levels; band++)
+                rice[band].escapeBits = escapeBits;
+
+            const size_t approximationStep = size_t(1) << windowLevels;
+            if (!read_ecg_wavelet_subband(reader, rice[0], x, 0, approximationStep,
+                    (windowLength + approximationStep - 1) >> windowLevels, &approximation))
+                return decoded;
+
+            for (uint8_t level = windowLevels; level >= 1; level--)
+            {
+                const size_t parentStride = size_t(1) << (level - 1);
+                const size_t parentCount = (windowLength + parentStride - 1) >> (level - 1);
+                if (thresholded)
+                {
+                    if (reader.bits_left() < 1)
+                        return decoded;
+
+                    if (reader.read(1) == 0) // All zero
+                    {
+                        for (size_t j = 0; j < parentCount / 2; j++)
+                            x[parentStride + j * parentStride * 2] = 0;
+                        continue;
+                    }
+                }
+                if (!read_ecg_wavelet_subband(reader, rice[level], x, parentStride, parentStride * 2, parentCount / 2, nullptr))
+                    return decoded;
+            }
+
+            for (uint8_t level = windowLevels; level >= 1; level--)
+            {
+                const size_t stride = size_t(1) << (level - 1);
+                ecg_wavelet_lift_inverse(x, (windowLength + stride - 1) >> (level - 1), stride);
+            }
+
+            for (size_t i = 0; i < windowLength && decoded < maxSamples; i++)
+                out[decoded++] = static_cast<TSample>(x[i]);
+        }
+        return decoded;
+    }
+
+    /// Decode a compressed ECG block (/Offline/Meas/ECG/Compressed/{SampleRate}).
+    ///
+    /// Original block layout (Gamma):
+    ///   [0]    number of samples in the block (non-zero)
+    ///   [1..2] first sample as int16 (little-endian)
+    ///   [3..]  deltas to previous sample, Elias Gamma coded with bijection
+    ///          (d >= 0 -> 2d + 1, d < 0 -> -2d), MSB first
+    ///
+    /// Extended block layout:
+    ///   [0]    0x00
+    ///   [1]    coding: bits 0-1 coder (ECGCoding), bits 2-5 coder parameter
+    ///          (initial Rice parameter), bits 6-7 predictor (ECGPredictor)
+    ///   [2..3] uint16 (little-endian): bits 0-11 number of samples in the block,
+    ///          bits 12-14 sample bit depth - 16, bit 15 near-lossless
+    ///   [4]    maximum error, only in near-lossless blocks
+    ///   [..]   first sample, (bit depth + 7) / 8 bytes signed little-endian,
+    ///          followed by prediction residuals, MSB first
+    ///
+    /// Raw coded blocks hold the rest of the samples in bit depth bits (two's complement)
+    /// without prediction. Zero run coded blocks hold Elias Gamma (run + 1) for each run of
+    /// zero residuals, followed by the Elias Gamma coded zigzag mapped non-zero residual.
+    ///
+    /// Near-lossless residuals are in units of 2 * maximum error + 1, the decoded
+    /// samples are within the maximum error of the original samples.
+    ///
+    /// Beat template blocks start with 0xFE, or 0xFD when the template restarts, and
+    /// continue with the extended layout. The predictions are corrected with beatTemplate,
+    /// which has to decode all blocks of the stream in order. After a lost block the
+    /// samples are wrong until the next 0xFD block, which the encoder writes every 32 blocks
+    /// and after a gap. Without beatTemplate these blocks are not decoded.
+    ///
+    /// Wavelet blocks start with 0xFF, see decode_ecg_wavelet_block.
+    ///
+    /// Writes at most maxSamples values and returns the number of decoded samples.
+    /// A return value smaller than the sample count in the header means the block is corrupted.
+    /// Blocks with a bit depth wider than TSample are not decoded, see ecg_block_bit_depth.
+    template<typename TSample>
+    inline size_t decode_ecg_block(const uint8_t* block, size_t blockSize, TSample* out, size_t maxSamples,
+        ECGBeatTemplate* beatTemplate = nullptr)
+    {
+        if (blockSize < 3 || maxSamples == 0)
+            return 0;
+
+        if (block[0] == ECG_WAVELET_BLOCK_MARKER)
+            return decode_ecg_wavelet_block(block, blockSize, out, maxSamples);
+
+        const GammaTable& table = GammaTable::get();
+        auto gamma = [&table](BitReader& reader, int32_t& delta) {
+            return read_gamma(reader, table, delta);
+        };
+
+        if (!ecg_block_extended(block))
+        {
+            size_t count = block[0];
+            if (count > maxSamples)
+                count = maxSamples;
+
+            TSample first = static_cast<int16_t>(block[1] | (block[2] << 8));
+            BitReader reader(block + 3, blockSize - 3);
+            return decode_ecg_residuals<ECGPredictor::FirstOrder>(reader, first, out, count, gamma, ECGQuantization(), nullptr);
+        }
+
+        if (blockSize < 4)
+            return 0;
+
+        if (block[0] == 0)
+            beatTemplate = nullptr;
+        else if (!beatTemplate)
+            return 0; // Beat template blocks need the decoder state
+        else if (block[0] == ECG_TEMPLATE_RESTART_BLOCK_MARKER)
+            beatTemplate->reset();
+
+        const uint8_t bitDepth = ecg_block_bit_depth(block);
+        const size_t sampleBytes = (bitDepth + 7) / 8;
+        const size_t headerSize = (block[3] & 0x80) ? 5 : 4;
+        if (bitDepth > sizeof(TSample) * 8 || blockSize < headerSize + sampleBytes)
+            return 0;
+        const ECGQuantization quantization(ecg_block_max_error(block), bitDepth);
+
+        size_t count = block[2] | ((block[3] & 0x0F) << 8);
+        if (count > maxSamples)
+            count = maxSamples;
+        if (count == 0)
+            return 0;
+
+        // Sign extend the first sample from the bit depth
+        uint32_t raw = 0;
+        for (size_t i = 0; i < sampleBytes; i++)
+            raw |= uint32_t(block[headerSize + i]) << (i * 8);
+        const uint8_t unused = 32 - bitDepth;
+        TSample first = static_cast<TSample>(static_cast<int32_t>(raw << unused) >> unused);
+        BitReader reader(block + headerSize + sampleBytes, blockSize - headerSize - sampleBytes);
+
+        uint8_t param = (block[1] >> 2) & 0x0F;
+        ECGPredictor predictor = static_cast<ECGPredictor>(block[1] >> 6);
+        switch (static_cast<ECGCoding>(block[1] & 0x03))
+        {
+        case ECGCoding::Gamma:
+            return decode_ecg_residuals(predictor, reader, first, out, count, gamma, quantization, beatTemplate);
+        case ECGCoding::Rice:
+        {
+            RiceState rice(param, bitDepth + 3);
+            return decode_ecg_residuals(predictor, reader, first, out, count,
+                [&rice](BitReader& reader, int32_t& delta) { return read_rice(reader, rice, delta); }, quantization,
+                beatTemplate);
+        }
+        case ECGCoding::Raw:
+        {
+            out[0] = first;
+            if (beatTemplate)
+                beatTemplate->advance(first);
+
+            for (size_t i = 1; i < count; i++)
+            {
+                if (reader.bits_left() < bitDepth)
+                    return i;
+                out[i] = static_cast<TSample>(static_cast<int32_t>(reader.read(bitDepth) << unused) >> unused);
+                if (beatTemplate) // The template learns from the residuals of the predictor
+                    beatTemplate->update(out[i], out[i] - ecg_predict(predictor, out, i));
+            }
+            return count;
+        }
+        case ECGCoding::ZeroRun:
+        {
+            ZeroRunState zeroRun;
+            return decode_ecg_residuals(predictor, reader, first, out, count,
+                [&zeroRun](BitReader& reader, int32_t& delta) { return zeroRun.read(reader, delta); }, quantization,
+                beatTemplate);
+        }
+        default:
+            return 0; // Unknown coder
+        }
+    }
+
+    /// Decode a sequence of equally sized compressed ECG blocks.
+    /// Pass beatTemplate to continue a stream decoded in parts.
+    /// Returns the total number of decoded samples.
+    template<typename TSample>
+    inline size_t decode_ecg_blocks(const uint8_t* blocks, size_t blockCount, size_t blockSize, TSample* out, size_t maxSamples,
+        ECGBeatTemplate* beatTemplate = nullptr)
+    {
+        ECGBeatTemplate streamTemplate;
+        if (!beatTemplate)
+            beatTemplate = &streamTemplate;
+
+        size_t total = 0;
+        for (size_t i = 0; i < blockCount && total < maxSamples; i++)
+        {
+            total += decode_ecg_block(blocks + i * blockSize, blockSize, out + total, maxSamples - total, beatTemplate);
+        }
+        return total;
+    }
+
+    /// Timestamp of sample index in a block, the block timestamp being the time of the first sample
+    inline uint32_t ecg_sample_timestamp(uint32_t blockTimestamp, size_t index, uint16_t sampleRate)
+    {
+        return blockTimestamp + static_cast<uint32_t>(index * 1000.0f / sampleRate);
+    }
+} // namespace offline_meas::decoding
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+namespace offline_meas::decoding
+{
+    /// Size of serialized fixed-point values
+    constexpr size_t Q24_BYTES = 3; // Q12.12 and Q16.8
+    constexpr size_t Q16_BYTES = 2; // Q10.6
+
+    /// Size of serialized 3D vectors (Vec3_Q12_12 and Vec3_Q10_6)
+    constexpr size_t VEC3_Q12_12_BYTES = 3 * Q24_BYTES;
+    constexpr size_t VEC3_Q10_6_BYTES = 3 * Q16_BYTES;
+    constexpr size_t VEC3_Q16_BYTES = 3 * Q16_BYTES; // Compact Acc and Gyro
+
+    /// Signed 24-bit little-endian integer
+    inline int32_t read_int24(const uint8_t* in)
+    {
+        return static_cast<int32_t>(
+            (uint32_t(in[0]) << 8) | (uint32_t(in[1]) << 16) | (uint32_t(in[2]) << 24)) >> 8;
+    }
+
+    /// Signed 16-bit little-endian integer
+    inline int16_t read_int16(const uint8_t* in)
+    {
+        return static_cast<int16_t>(in[0] | (in[1] << 8));
+    }
+
+    inline float q12_12_to_float(const uint8_t* in)
+    {
+        return read_int24(in) * (1.0f / (1 << 12));
+    }
+
+    inline float q16_8_to_float(const uint8_t* in)
+    {
+        return read_int24(in) * (1.0f / (1 << 8));
+    }
+
+    inline float q10_6_to_float(const uint8_t* in)
+    {
+        return read_int16(in) * (1.0f / (1 << 6));
+    }
+
+    /// Convert count packed signed 24-bit fixed-point values with F_bits
+    /// fractional bits into floats.
+    template<uint8_t F_bits>
+    inline void unpack_q24(const uint8_t* in, size_t count, float* out)
+    {
+        constexpr float scale = 1.0f / (1 << F_bits);
+        size_t i = 0;
+
+#if defined(__SSSE3__)
+        // Four values (12 bytes) per iteration. The 16-byte load reads
+        // 4 bytes ahead, so the last values are left to the scalar loop.
+        const __m128i shuffle = _mm_setr_epi8(
+            -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+        const __m128 vscale = _mm_set1_ps(scale);
+
+        for (; (i + 4) * Q24_BYTES + 4 <= count * Q24_BYTES; i += 4)
+        {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * Q24_BYTES));
+            __m128i values = _mm_srai_epi32(_mm_shuffle_epi8(bytes, shuffle), 8);
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(values), vscale));
+        }
+#endif
+
+        for (; i < count; i++)
+        {
+            out[i] = read_int24(in + i * Q24_BYTES) * scale;
+        }
+    }
+
+    /// Convert packed Vec3_Q12_12 array into interleaved x, y, z floats.
+    /// out must have room for 3 * count values.
+    inline void unpack_vec3_q12_12(const uint8_t* in, size_t count, float* out)
+    {
+        unpack_q24<12>(in, count * 3, out);
+    }
+
+    /// Convert packed Vec3_Q16_8 array into interleaved x, y, z floats.
+    inline void unpack_vec3_q16_8(const uint8_t* in, size_t count, float* out)
+    {
+        unpack_q24<8>(in, count * 3, out);
+    }
+
+    /// Convert packed Vec3_Q10_6 array into interleaved x, y, z floats.
+    inline void unpack_vec3_q10_6(const uint8_t* in, size_t count, float* out)
+    {
+        constexpr float scale = 1.0f / (1 << 6);
+        for (size_t i = 0; i < count * 3; i++)
+        {
+            out[i] = read_int16(in + i * Q16_BYTES) * scale;
+        }
+    }
+
+    /// Convert packed Vec3_Q16 array into interleaved x, y, z floats.
+    /// fractionBits is the FractionBits field of the record (OfflineIMUCompactData).
+    inline void unpack_vec3_q16(const uint8_t* in, size_t count, uint8_t fractionBits, float* out)
+    {
+        const float scale = 1.0f / (1u << fractionBits);
+        for (size_t i = 0; i < count * 3; i++)
+        {
+            out[i] = read_int16(in + i * Q16_BYTES) * scale;
+        }
+    }
+} // namespace offline_meas::decoding
@@ -0,0 +1,117 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "BitReader.hpp"
+#include "RiceDecoder.hpp"
+
+namespace offline_meas::decoding
+{
+    /// Compressed IMU blocks (/Offline/Meas/{Acc,Gyro,Magn}/Compressed/{SampleRate})
+    ///   [0]    value bits (total bits of a fixed-point component)
+    ///   [1]    fractional bits of the components
+    ///   [2..3] number of vectors (uint16)
+    ///   [4]    bits 0-3 initial Rice parameter of x, bits 4-7 of y
+    ///   [5]    bits 0-3 initial Rice parameter of z, bits 4-5 predictor (IMUPredictor)
+    ///   [6..]  MSB first: the first vector in value bits per component, followed by
+    ///          the adaptive Rice coded x, y and z residuals of the following vectors
+    constexpr size_t IMU_BLOCK_HEADER_SIZE = 6;
+    constexpr size_t IMU_AXES = 3;
+    constexpr uint8_t IMU_MAX_VALUE_BITS = 24;
+
+    enum class IMUPredictor : uint8_t
+    {
+        FirstOrder = 0,
+        SecondOrder = 1,
+    };
+
+    struct IMUBlockInfo
+    {
+        uint8_t valueBits;
+        uint8_t fractionBits;
+        uint16_t count; // Vectors
+        IMUPredictor predictor;
+    };
+
+    /// Read the header of a compressed IMU block. Returns false for an invalid header.
+    inline bool read_imu_block_info(const uint8_t* block, size_t blockSize, IMUBlockInfo& info)
+    {
+        if (blockSize < IMU_BLOCK_HEADER_SIZE)
+            return false;
+
+        info.valueBits = block[0];
+        info.fractionBits = block[1];
+        info.count = static_cast<uint16_t>(block[2] | (block[3] << 8));
+        info.predictor = static_cast<IMUPredictor>((block[5] >> 4) & 0x03);
+        return info.valueBits > 0 && info.valueBits <= IMU_MAX_VALUE_BITS && info.fractionBits <= info.valueBits
+            && info.predictor <= IMUPredictor::SecondOrder;
+    }
+
+    /// Decode a compressed IMU block into interleaved x, y, z fixed-point values.
+    /// out must have room for 3 * maxVectors values. Returns the number of decoded vectors.
+    inline size_t decode_imu_block(const uint8_t* block, size_t blockSize, int32_t* out, size_t maxVectors)
+    {
+        IMUBlockInfo info;
+        if (!read_imu_block_info(block, blockSize, info) || info.count == 0 || maxVectors == 0)
+            return 0;
+
+        const uint8_t escapeBits = info.valueBits + 2;
+        RiceState rice[IMU_AXES] = {
+            RiceState(block[4] & 0x0F, escapeBits),
+            RiceState(block[4] >> 4, escapeBits),
+            RiceState(block[5] & 0x0F, escapeBits),
+        };
+
+        BitReader reader(block + IMU_BLOCK_HEADER_SIZE, blockSize - IMU_BLOCK_HEADER_SIZE);
+        if (reader.bits_left() < size_t(info.valueBits) * IMU_AXES)
+            return 0;
+
+        const uint8_t shift = 32 - info.valueBits;
+        for (size_t axis = 0; axis < IMU_AXES; axis++)
+            out[axis] = static_cast<int32_t>(reader.read(info.valueBits) << shift) >> shift;
+
+        size_t count = info.count < maxVectors ? info.count : maxVectors;
+        for (size_t i = 1; i < count; i++)
+        {
+            int32_t* vector = out + i * IMU_AXES;
+            const int32_t* x1 = vector - IMU_AXES;
+            const int32_t* x2 = i > 1 ? vector - 2 * IMU_AXES : x1;
+
+            for (size_t axis = 0; axis < IMU_AXES; axis++)
+            {
+                int32_t residual;
+                if (!read_rice(reader, rice[axis], residual))
+                    return i;
+
+                const int32_t prediction = (info.predictor == IMUPredictor::SecondOrder && i > 1)
+                    ? 2 * x1[axis] - x2[axis]
+                    : x1[axis];
+                vector[axis] = prediction + residual;
+            }
+        }
+        return count;
+    }
+
+    /// Decode a compressed IMU block into interleaved x, y, z floats.
+    /// Returns the number of decoded vectors.
+    inline size_t decode_imu_block(const uint8_t* block, size_t blockSize, float* out, size_t maxVectors)
+    {
+        IMUBlockInfo info;
+        if (!read_imu_block_info(block, blockSize, info))
+            return 0;
+
+        // Decode in place, int32_t and float have the same size
+        static_assert(sizeof(int32_t) == sizeof(float), "Decoded in place");
+        size_t count = decode_imu_block(block, blockSize, reinterpret_cast<int32_t*>(out), maxVectors);
+
+        const float scale = 1.0f / (1u << info.fractionBits);
+        for (size_t i = 0; i < count * IMU_AXES; i++)
+        {
+            int32_t fixed;
+            memcpy(&fixed, &out[i], sizeof(fixed));
+            out[i] = fixed * scale;
+        }
+        return count;
+    }
+} // namespace offline_meas::decoding
@@ -0,0 +1,74 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "BitReader.hpp"
+#include "RiceDecoder.hpp"
+
+namespace offline_meas::decoding
+{
+    /// RR-interval chunk (/Offline/Meas/RR): 8 x 12-bit values, MSB first
+    constexpr size_t RR_CHUNK_VALUES = 8;
+    constexpr size_t RR_CHUNK_BYTES = 12;
+
+    /// Unpack 12-bit values, two values per three bytes.
+    /// Returns the number of values written (2 * (size / 3)).
+    inline size_t unpack_rr_intervals(const uint8_t* in, size_t size, uint16_t* out)
+    {
+        size_t pairs = size / 3;
+        for (size_t i = 0; i < pairs; i++)
+        {
+            const uint8_t* b = in + i * 3;
+            out[i * 2 + 0] = static_cast<uint16_t>((b[0] << 4) | (b[1] >> 4));
+            out[i * 2 + 1] = static_cast<uint16_t>(((b[1] & 0x0F) << 8) | b[2]);
+        }
+        return pairs * 2;
+    }
+
+    /// Unpack a number of consecutive RR chunks
+    inline size_t unpack_rr_chunks(const uint8_t* chunks, size_t chunkCount, uint16_t* out)
+    {
+        return unpack_rr_intervals(chunks, chunkCount * RR_CHUNK_BYTES, out);
+    }
+
+    /// Compressed RR-interval blocks (/Offline/Meas/RR/Compressed)
+    ///   [0]    number of intervals
+    ///   [1]    bits 0-3 initial Rice parameter
+    ///   [2..]  MSB first: the first interval in 16 bits, followed by the adaptive
+    ///          Rice coded differences of the following intervals
+    constexpr size_t RR_BLOCK_HEADER_SIZE = 2;
+    constexpr uint8_t RR_VALUE_BITS = 16;
+    constexpr uint8_t RR_ESCAPE_BITS = RR_VALUE_BITS + 1;
+
+    /// Number of intervals in a compressed RR block
+    inline size_t rr_block_count(const uint8_t* block, size_t blockSize)
+    {
+        return blockSize >= RR_BLOCK_HEADER_SIZE ? block[0] : 0;
+    }
+
+    /// Decode a compressed RR block. Returns the number of decoded intervals.
+    inline size_t decode_rr_block(const uint8_t* block, size_t blockSize, uint16_t* out, size_t maxIntervals)
+    {
+        size_t count = rr_block_count(block, blockSize);
+        if (count > maxIntervals)
+            count = maxIntervals;
+
+        BitReader reader(block + RR_BLOCK_HEADER_SIZE, blockSize - RR_BLOCK_HEADER_SIZE);
+        if (count == 0 || reader.bits_left() < RR_VALUE_BITS)
+            return 0;
+
+        RiceState rice(block[1] & 0x0F, RR_ESCAPE_BITS);
+        int32_t previous = static_cast<int32_t>(reader.read(RR_VALUE_BITS));
+        out[0] = static_cast<uint16_t>(previous);
+
+        for (size_t i = 1; i < count; i++)
+        {
+            int32_t delta;
+            if (!read_rice(reader, rice, delta))
+                return i;
+            previous += delta;
+            out[i] = static_cast<uint16_t>(previous);
+        }
+        return count;
+    }
+} // namespace offline_meas::decoding
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace offline_meas::decoding
+{
+    /// Low-rate records, serialized as a little-endian uint32 timestamp (ms)
+    /// followed by the value.
+
+    struct HRRecord
+    {
+        static constexpr size_t SIZE = 5;
+        uint32_t timestamp;
+        uint8_t average; // bpm
+    };
+
+    struct TempRecord
+    {
+        static constexpr size_t SIZE = 5;
+        uint32_t timestamp;
+        int8_t measurement; // celsius
+    };
+
+    struct ActivityRecord
+    {
+        static constexpr size_t SIZE = 6;
+        uint32_t timestamp;
+        uint16_t activity;
+    };
+
+    inline uint32_t read_uint32(const uint8_t* in)
+    {
+        return uint32_t(in[0]) | (uint32_t(in[1]) << 8) | (uint32_t(in[2]) << 16) | (uint32_t(in[3]) << 24);
+    }
+
+    inline bool read_record(const uint8_t* in, size_t size, HRRecord& out)
+    {
+        if (size < HRRecord::SIZE)
+            return false;
+        out.timestamp = read_uint32(in);
+        out.average = in[4];
+        return true;
+    }
+
+    inline bool read_record(const uint8_t* in, size_t size, TempRecord& out)
+    {
+        if (size < TempRecord::SIZE)
+            return false;
+        out.timestamp = read_uint32(in);
+        out.measurement = static_cast<int8_t>(in[4]);
+        return true;
+    }
+
+    inline bool read_record(const uint8_t* in, size_t size, ActivityRecord& out)
+    {
+        if (size < ActivityRecord::SIZE)
+            return false;
+        out.timestamp = read_uint32(in);
+        out.activity = static_cast<uint16_t>(in[4] | (in[5] << 8));
+        return true;
+    }
+
+    /// Decode consecutive records of the same type. Returns the number of records read.
+    template<typename TRecord>
+    inline size_t read_records(const uint8_t* in, size_t size, TRecord* out, size_t maxRecords)
+    {
+        size_t count = 0;
+        while (count < maxRecords && read_record(in + count * TRecord::SIZE, size - count * TRecord::SIZE, out[count]))
+            count++;
+        return count;
+    }
+} // namespace offline_meas::decoding
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "BitReader.hpp"
+
+namespace offline_meas::decoding
+{
+    /// Rice escape: RICE_ESCAPE zeros and a one, followed by the mapped value in escape bits,
+    /// which depend on the format (RICE_ESCAPE_BITS for 16-bit ECG samples)
+    constexpr uint8_t RICE_ESCAPE = 16;
+    constexpr uint8_t RICE_ESCAPE_BITS = 19;
+    constexpr uint8_t RICE_MAX_K = 15;
+    constexpr uint32_t RICE_STATS_WINDOW = 8;
+
+    /// Adaptive Rice parameter: smallest k for which count * 2^k >= sum of the
+    /// previous mapped values. Starts from the parameter in the block header.
+    struct RiceState
+    {
+        uint32_t sum;
+        uint32_t count;
+        uint8_t escapeBits;
+
+        explicit RiceState(uint8_t initialK, uint8_t escapeBits = RICE_ESCAPE_BITS)
+            : sum(1u << initialK)
+            , count(1)
+            , escapeBits(escapeBits)
+        {
+        }
+
+        uint8_t parameter() const
+        {
+            if (sum <= count)
+                return 0;
+
+            uint8_t k = __builtin_clz(count) - __builtin_clz(sum);
+            if ((count << k) < sum)
+                k++;
+            return k < RICE_MAX_K ? k : RICE_MAX_K;
+        }
+
+        void update(uint32_t mapped)
+        {
+            sum += mapped;
+            count += 1;
+            if (count >= RICE_STATS_WINDOW)
+            {
+                sum >>= 1;
+                count >>= 1;
+            }
+        }
+    };
+
+    /// Decode one zigzag mapped (d >= 0 -> 2d, d < 0 -> -2d - 1) adaptive Rice code.
+    /// Returns false on a truncated or corrupted stream.
+    inline bool read_rice(BitReader& reader, RiceState& state, int32_t& delta)
+    {
+        const uint8_t k = state.parameter();
+        uint32_t bits = reader.peek32();
+        uint8_t quotient = bits ? __builtin_clz(bits) : 32;
+        if (quotient > RICE_ESCAPE)
+            return false;
+
+        uint32_t mapped = 0;
+        if (quotient == RICE_ESCAPE)
+        {
+            if (reader.bits_left() < size_t(RICE_ESCAPE) + 1 + state.escapeBits)
+                return false;
+            reader.skip(RICE_ESCAPE + 1);
+            mapped = reader.read(state.escapeBits);
+        }
+        else
+        {
+            if (reader.bits_left() < size_t(quotient) + 1 + k)
+                return false;
+            reader.skip(quotient + 1);
+            mapped = (uint32_t(quotient) << k) | (k ? reader.read(k) : 0);
+        }
+
+        state.update(mapped);
+        delta = (mapped & 1) ? -static_cast<int32_t>((mapped + 1) >> 1) : static_cast<int32_t>(mapped >> 1);
+        return true;
+    }
+} // namespace offline_meas::decoding
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "BitReader.hpp"
+
+namespace offline_meas::decoding
+{
+    /// Compressed slow time-series blocks (/Offline/Meas/{HR,Temp,Activity}/Compressed).
+    /// The timestamp of the first reading is the timestamp of the notification.
+    ///   [0]    number of readings
+    ///   [1]    bits 0-4 value bits, bit 7 set for signed values
+    ///   [2..]  MSB first: the first value, followed by a timestamp code (delta-of-delta, ms)
+    ///          and a value code (difference) for each following reading:
+    ///            timestamp: 0 | 10 + 8 bits | 110 + 12 bits | 1110 + 16 bits | 1111 + 32 bits
+    ///            value:     0 | 10 + 4 bits | 11 + value bits + 1
+    constexpr size_t SLOW_BLOCK_HEADER_SIZE = 2;
+    constexpr uint8_t SLOW_SIGNED_FLAG = 0x80;
+    constexpr uint8_t SLOW_MAX_VALUE_BITS = 16;
+
+    struct SlowRecord
+    {
+        uint32_t timestamp; // ms
+        int32_t value;
+    };
+
+    /// Two's complement value of count (<= 32) bits
+    inline int32_t read_signed(BitReader& reader, uint8_t count)
+    {
+        uint32_t value = reader.read(count);
+        return count < 32 ? static_cast<int32_t>(value << (32 - count)) >> (32 - count) : static_cast<int32_t>(value);
+    }
+
+    /// Decode a compressed slow time-series block. Returns the number of decoded readings.
+    inline size_t decode_slow_block(const uint8_t* block, size_t blockSize, uint32_t timestamp,
+        SlowRecord* out, size_t maxRecords)
+    {
+        if (blockSize < SLOW_BLOCK_HEADER_SIZE)
+            return 0;
+
+        const uint8_t valueBits = block[1] & 0x1F;
+        const bool isSigned = !!(block[1] & SLOW_SIGNED_FLAG);
+        size_t count = block[0] < maxRecords ? block[0] : maxRecords;
+        if (count == 0 || valueBits == 0 || valueBits > SLOW_MAX_VALUE_BITS)
+            return 0;
+
+        BitReader reader(block + SLOW_BLOCK_HEADER_SIZE, blockSize - SLOW_BLOCK_HEADER_SIZE);
+        if (reader.bits_left() < valueBits)
+            return 0;
+
+        int32_t value = isSigned ? read_signed(reader, valueBits) : static_cast<int32_t>(reader.read(valueBits));
+        int32_t delta = 0;
+        out[0] = { timestamp, value };
+
+        for (size_t i = 1; i < count; i++)
+        {
+            // Timestamp code, the prefix is up to four ones terminated with a zero
+            uint8_t ones = 0;
+            while (ones < 4 && reader.read(1))
+                ones++;
+
+            static constexpr uint8_t DOD_BITS[] = { 0, 8, 12, 16, 32 };
+            if (reader.bits_left() < DOD_BITS[ones] + 1u)
+                return i;
+            delta += ones ? read_signed(reader, DOD_BITS[ones]) : 0;
+            timestamp += delta;
+
+            // Value code
+            if (reader.read(1))
+                value += reader.read(1) ? read_signed(reader, valueBits + 1) : read_signed(reader, 4);
+
+            out[i] = { timestamp, value };
+        }
+        return count;
+    }
+} // namespace offline_meas::decoding
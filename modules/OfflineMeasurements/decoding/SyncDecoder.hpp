@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "RecordDecoder.hpp"
+
+namespace offline_meas::decoding
+{
+    /// Sync records of the channels recorded with implicit timestamps
+    /// (/Offline/Meas/{ECG,Acc,Gyro,Magn}/Implicit), serialized little-endian:
+    ///   [0]      channel (OfflineMeasurement)
+    ///   [1..4]   timestamp (ms) of the sample
+    ///   [5..8]   index of the sample, counted from 0 since the subscription
+    ///   [9..10]  sample rate (Hz)
+    /// A sync record precedes the samples it refers to.
+    struct SyncRecord
+    {
+        static constexpr size_t SIZE = 11;
+        uint8_t channel;
+        uint32_t timestamp;
+        uint32_t sampleIndex;
+        uint16_t sampleRate;
+    };
+
+    inline bool read_record(const uint8_t* in, size_t size, SyncRecord& out)
+    {
+        if (size < SyncRecord::SIZE)
+            return false;
+        out.channel = in[0];
+        out.timestamp = read_uint32(in + 1);
+        out.sampleIndex = read_uint32(in + 5);
+        out.sampleRate = static_cast<uint16_t>(in[9] | (in[10] << 8));
+        return true;
+    }
+
+    /// Timestamp (ms) of a sample relative to a sync record at or before it
+    inline uint32_t implicit_timestamp(const SyncRecord& sync, uint32_t sampleIndex)
+    {
+        if (sync.sampleRate == 0)
+            return sync.timestamp;
+        return sync.timestamp + static_cast<uint32_t>((uint64_t)(sampleIndex - sync.sampleIndex) * 1000 / sync.sampleRate);
+    }
+
+    /// Timestamps of count samples starting at firstIndex, from the sync records of
+    /// their channel in index order. Each sample uses the last sync record at or
+    /// before it. Returns the number of timestamps written. Samples before the
+    /// first sync record have none, so the timestamps are those of the last samples.
+    inline size_t implicit_timestamps(const SyncRecord* syncs, size_t syncCount,
+        uint32_t firstIndex, size_t count, uint32_t* out)
+    {
+        size_t written = 0;
+        size_t current = 0;
+        bool found = false;
+        for (size_t i = 0; i < count; i++)
+        {
+            const uint32_t index = firstIndex + static_cast<uint32_t>(i);
+            while (current < syncCount && syncs[current].sampleIndex <= index)
+            {
+                current++;
+                found = true;
+            }
+            if (!found)
+                continue;
+
+            out[written++] = implicit_timestamp(syncs[current - 1], index);
+        }
+        return written;
+    }
+} // namespace offline_meas::decoding
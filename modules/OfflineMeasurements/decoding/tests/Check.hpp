@@ -0,0 +1,31 @@
+#pragma once
+// Minimal checks for the host tests: failures are printed and counted, the test
+// returns test_result() from main.
+#include <cstdio>
+
+namespace offline_meas::testing
+{
+    inline int& failures()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    inline bool check(bool condition, const char* expression, const char* file, int line)
+    {
+        if (!condition)
+        {
+            std::printf("%s:%d: check failed: %s\n", file, line, expression);
+            failures()++;
+        }
+        return condition;
+    }
+
+    inline int test_result(const char* name)
+    {
+        std::printf("%s: %s (%d failures)\n", name, failures() == 0 ? "passed" : "FAILED", failures());
+        return failures() == 0 ? 0 : 1;
+    }
+} // namespace offline_meas::testing
+
+#define CHECK(condition) offline_meas::testing::check((condition), #condition, __FILE__, __LINE__)
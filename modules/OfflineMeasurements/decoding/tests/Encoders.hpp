@@ -0,0 +1,40 @@
+#pragma once
+// Firmware encoders of the module, compiled against the stubbed Whiteboard resources.
+// The encoders collect their blocks into a BlockList.
+#include <cstdint>
+#include <vector>
+
+#include "modules-resources/resources.h"
+
+#include "compression/BitPack.hpp"
+#include "compression/ECGCompression.hpp"
+#include "compression/ECGWavelet.hpp"
+#include "compression/FixedPoint.hpp"
+#include "compression/IMUCompression.hpp"
+#include "compression/RRCompression.hpp"
+#include "compression/SlowCompression.hpp"
+
+namespace offline_meas::testing
+{
+    struct Block
+    {
+        std::vector<uint8_t> data;
+        uint32_t timestamp; // Slow blocks only
+    };
+
+    /// Sink of the encoders, keeps the completed blocks in order
+    struct BlockList
+    {
+        std::vector<Block> blocks;
+
+        void operator()(uint8_t* block, size_t size)
+        {
+            blocks.push_back({ std::vector<uint8_t>(block, block + size), 0 });
+        }
+
+        void operator()(uint8_t* block, size_t size, uint32_t timestamp)
+        {
+            blocks.push_back({ std::vector<uint8_t>(block, block + size), timestamp });
+        }
+    };
+} // namespace offline_meas::testing
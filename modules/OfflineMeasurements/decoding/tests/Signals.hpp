@@ -0,0 +1,119 @@
+#pragma once
+// Deterministic test signals
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace offline_meas::testing
+{
+    /// Linear congruential generator, the same sequence on every host
+    class Random
+    {
+        uint32_t m_state;
+
+    public:
+        explicit Random(uint32_t seed)
+            : m_state(seed * 2654435761u + 1)
+        {
+        }
+
+        uint32_t next()
+        {
+            m_state = m_state * 1664525u + 1013904223u;
+            return m_state >> 8;
+        }
+
+        /// Uniform in [-amplitude, amplitude]
+        int32_t uniform(int32_t amplitude)
+        {
+            return amplitude > 0 ? static_cast<int32_t>(next() % (2 * uint32_t(amplitude) + 1)) - amplitude : 0;
+        }
+    };
+
+    /// ECG-like signal: baseline wander, a QRS spike and a T wave each beat, and noise.
+    /// amplitude is the height of the R peak, values are clamped to bitDepth bits.
+    inline std::vector<int32_t> ecg_signal(size_t count, uint32_t seed, int32_t amplitude = 2000,
+        int32_t noise = 8, uint16_t sampleRate = 250, uint8_t bitDepth = 16)
+    {
+        Random random(seed);
+        const int32_t max = (1 << (bitDepth - 1)) - 1;
+        const double beat = 60.0 / (60 + seed % 40) * sampleRate; // Samples per beat
+        const double pi = 3.14159265358979;
+
+        std::vector<int32_t> out(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            const double phase = std::fmod(double(i), beat) / sampleRate; // s since the beat
+            double x = 0.1 * amplitude * std::sin(2 * pi * 0.3 * i / sampleRate);
+            x += amplitude * std::exp(-std::pow((phase - 0.2) / 0.012, 2));
+            x -= 0.2 * amplitude * std::exp(-std::pow((phase - 0.23) / 0.01, 2));
+            x += 0.25 * amplitude * std::exp(-std::pow((phase - 0.45) / 0.05, 2));
+            int32_t value = static_cast<int32_t>(std::lround(x)) + random.uniform(noise);
+            out[i] = value > max ? max : value < -max - 1 ? -max - 1 : value;
+        }
+        return out;
+    }
+
+    /// ECG with the leads off for 20 s of every minute: the front end sits at the
+    /// baseline, with a one LSB flicker now and then
+    inline std::vector<int32_t> lead_off_signal(size_t count, uint32_t seed, uint16_t sampleRate = 250)
+    {
+        Random random(seed);
+        std::vector<int32_t> out = ecg_signal(count, seed, 2000, 8, sampleRate);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (i % (60 * sampleRate) >= 40 * sampleRate)
+                out[i] = random.next() % 64 == 0 ? random.uniform(1) : 0;
+        }
+        return out;
+    }
+
+    /// Full-scale noise of bitDepth bits, the worst case for the coders
+    inline std::vector<int32_t> noise_signal(size_t count, uint32_t seed, uint8_t bitDepth = 16)
+    {
+        Random random(seed);
+        const int32_t max = (1 << (bitDepth - 1)) - 1;
+        std::vector<int32_t> out(count);
+        for (size_t i = 0; i < count; i++)
+            out[i] = random.uniform(max);
+        return out;
+    }
+
+    /// Interleaved x, y, z of a slowly rotating vector with noise, values fit in valueBits bits
+    inline std::vector<int32_t> imu_signal(size_t vectors, uint32_t seed, uint8_t valueBits, int32_t noise = 16)
+    {
+        Random random(seed);
+        const int32_t max = (1 << (valueBits - 1)) - 1;
+        const double amplitude = max / 2.0;
+        std::vector<int32_t> out(vectors * 3);
+        for (size_t i = 0; i < vectors; i++)
+        {
+            const double angle = 0.01 * i + 0.1 * seed;
+            const double components[3] = { std::cos(angle), std::sin(angle), std::sin(0.37 * angle) };
+            for (size_t axis = 0; axis < 3; axis++)
+            {
+                int32_t value = static_cast<int32_t>(amplitude * components[axis]) + random.uniform(noise);
+                out[i * 3 + axis] = value > max ? max : value < -max - 1 ? -max - 1 : value;
+            }
+        }
+        return out;
+    }
+
+    /// RR-intervals (ms) around 60-100 bpm with beat-to-beat variation and occasional artifacts
+    inline std::vector<uint16_t> rr_signal(size_t count, uint32_t seed)
+    {
+        Random random(seed);
+        std::vector<uint16_t> out(count);
+        int32_t interval = 800;
+        for (size_t i = 0; i < count; i++)
+        {
+            interval += random.uniform(20);
+            interval = interval < 600 ? 600 : interval > 1000 ? 1000 : interval;
+            int32_t value = interval;
+            if (random.next() % 50 == 0) // Missed or extra beat
+                value = random.next() % 2 ? 2 * interval : interval / 2;
+            out[i] = static_cast<uint16_t>(value);
+        }
+        return out;
+    }
+} // namespace offline_meas::testing
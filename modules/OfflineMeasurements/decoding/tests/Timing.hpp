@@ -0,0 +1,60 @@
+#pragma once
+// Clock of the host benchmarks: CPU cycles (time stamp counter) on x86, ns elsewhere.
+// Host numbers do not carry over to the device, they compare implementations.
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define OFFLINE_MEAS_CYCLES 1
+#endif
+
+namespace offline_meas::testing
+{
+    /// Results of the measured code go here, so that it is not optimized out
+    inline volatile uint32_t g_sink;
+
+    inline double now()
+    {
+#if defined(OFFLINE_MEAS_CYCLES)
+        return static_cast<double>(__rdtsc());
+#else
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    /// Unit of now()
+    inline const char* clock_unit()
+    {
+#if defined(OFFLINE_MEAS_CYCLES)
+        return "cycles";
+#else
+        return "ns";
+#endif
+    }
+
+    /// Unit of now() per sample
+    inline const char* per_sample_unit()
+    {
+#if defined(OFFLINE_MEAS_CYCLES)
+        return "cycles/sample";
+#else
+        return "ns/sample";
+#endif
+    }
+
+    /// Best time of rounds runs of work
+    template<typename TWork>
+    double best_of(size_t rounds, TWork&& work)
+    {
+        double best = 1e30;
+        for (size_t round = 0; round < rounds; round++)
+        {
+            const double start = now();
+            work();
+            const double elapsed = now() - start;
+            best = elapsed < best ? elapsed : best;
+        }
+        return best;
+    }
+} // namespace offline_meas::testing
@@ -0,0 +1,75 @@
+// BitPack against the per-value writer it replaced (bit_pack::write): the chunks have to
+// stay byte for byte, for all widths, also when the values do not fit in the width.
+// Unpack has to give the values back, sign extended for signed types.
+#include <cstdio>
+#include <utility>
+
+#include "Check.hpp"
+#include "Encoders.hpp"
+#include "Legacy.hpp"
+#include "Signals.hpp"
+
+using namespace offline_meas::testing;
+using offline_meas::compression::BitPack;
+
+namespace
+{
+    constexpr size_t CHUNKS = 256;
+
+    template<uint8_t Bits, size_t N>
+    void compare(Random& random)
+    {
+        using Pack = BitPack<Bits, N>;
+
+        for (size_t chunk = 0; chunk < CHUNKS; chunk++)
+        {
+            int32_t values[N];
+            for (size_t i = 0; i < N; i++)
+                values[i] = chunk % 2 ? random.uniform(1 << (Bits - 1)) : random.uniform(1 << 30);
+
+            uint8_t expected[Pack::BYTES] = {};
+            for (size_t i = 0; i < N; i++)
+                legacy::bit_pack::write<uint32_t, Bits, N>(static_cast<uint32_t>(values[i]), expected, i);
+
+            uint8_t actual[Pack::BYTES];
+            Pack::pack(values, actual);
+
+            bool same = true;
+            for (size_t i = 0; i < Pack::BYTES; i++)
+                same &= actual[i] == expected[i];
+            if (!CHECK(same))
+            {
+                std::printf("  %u bits x %zu: chunk %zu differs\n", Bits, N, chunk);
+                return;
+            }
+
+            int32_t unpacked[N];
+            Pack::unpack(actual, unpacked);
+            for (size_t i = 0; i < N; i++)
+            {
+                const int32_t value = static_cast<int32_t>(static_cast<uint32_t>(values[i]) << (32 - Bits)) >> (32 - Bits);
+                if (!CHECK(unpacked[i] == value))
+                {
+                    std::printf("  %u bits x %zu: value %zu of chunk %zu is %d, expected %d\n", Bits, N, i, chunk,
+                        unpacked[i], value);
+                    return;
+                }
+            }
+        }
+    }
+
+    template<size_t N, size_t... Bits>
+    void compare_widths(Random& random, std::index_sequence<Bits...>)
+    {
+        (compare<Bits + 1, N>(random), ...);
+    }
+} // namespace
+
+int main()
+{
+    Random random(1);
+    compare_widths<8>(random, std::make_index_sequence<24>()); // RR chunks are 12 bits x 8
+    compare_widths<3>(random, std::make_index_sequence<24>()); // Chunks ending in a partial byte
+    compare_widths<5>(random, std::make_index_sequence<24>());
+    return test_result("bit_pack_test");
+}
@@ -0,0 +1,67 @@
+// The Gamma coded blocks of ECGCompression (BitWriter, floor_log2) against the writer
+// they replaced (write_bits, log2f): the original block layout has to stay byte for byte.
+#include <cstdio>
+
+#include "Check.hpp"
+#include "Encoders.hpp"
+#include "Legacy.hpp"
+#include "Signals.hpp"
+
+using namespace offline_meas::testing;
+
+namespace
+{
+    constexpr size_t BLOCK_SIZE = 32;
+    constexpr size_t NOTIFICATION_SAMPLES = 16;
+
+    BlockList encode_legacy(const std::vector<int32_t>& samples)
+    {
+        legacy::ECGCompression<BLOCK_SIZE, int16_t, int32_t> encoder;
+        BlockList sink;
+        auto write = [&](uint8_t* block) { sink(block, BLOCK_SIZE); };
+
+        std::vector<int16_t> narrow(samples.begin(), samples.end());
+        for (size_t i = 0; i < narrow.size(); i += NOTIFICATION_SAMPLES)
+            encoder.pack_continuous(wb::MakeArray(narrow.data() + i, WB_MIN(NOTIFICATION_SAMPLES, narrow.size() - i)), write);
+        encoder.dump_buffer(write);
+        return sink;
+    }
+
+    BlockList encode(const std::vector<int32_t>& samples)
+    {
+        ECGCompression<256, int32_t, int32_t> encoder; // Gamma, first order, 32 B blocks
+        BlockList sink;
+        for (size_t i = 0; i < samples.size(); i += NOTIFICATION_SAMPLES)
+            encoder.pack_continuous(wb::MakeArray(samples.data() + i, WB_MIN(NOTIFICATION_SAMPLES, samples.size() - i)), sink);
+        encoder.dump_buffer(sink);
+        return sink;
+    }
+
+    void compare(const char* name, const std::vector<int32_t>& samples)
+    {
+        const BlockList expected = encode_legacy(samples);
+        const BlockList actual = encode(samples);
+
+        if (!CHECK(actual.blocks.size() == expected.blocks.size()))
+            std::printf("  %s: %zu blocks, expected %zu\n", name, actual.blocks.size(), expected.blocks.size());
+
+        for (size_t i = 0; i < actual.blocks.size() && i < expected.blocks.size(); i++)
+        {
+            if (!CHECK(actual.blocks[i].data == expected.blocks[i].data))
+            {
+                std::printf("  %s: block %zu differs\n", name, i);
+                return;
+            }
+        }
+    }
+} // namespace
+
+int main()
+{
+    compare("ecg", ecg_signal(250 * 120, 1));
+    compare("ecg, large amplitude", ecg_signal(250 * 60, 2, 12000, 64));
+    compare("noise", noise_signal(4096, 3)); // Deltas up to 17 bits, a few per block
+    compare("constant", std::vector<int32_t>(1000, -5)); // Single bit codes, full blocks
+    compare("short", { 7, 8, 6 }); // Flushed partial block
+    return test_result("bit_writer_test");
+}
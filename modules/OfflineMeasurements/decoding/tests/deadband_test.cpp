@@ -0,0 +1,189 @@
+// Deadband (utils/Deadband.hpp) of the HR, temperature and activity channels: record counts
+// of typical traces, and the guarantees of the hysteresis, minimum and heartbeat intervals.
+// The recorded readings go through SlowCompression and decode_slow_block like on the device.
+#include <cstdio>
+#include <cstdlib>
+
+#include "Check.hpp"
+#include "Encoders.hpp"
+#include "Signals.hpp"
+#include "SlowDecoder.hpp"
+#include "utils/Deadband.hpp"
+
+using namespace offline_meas::testing;
+namespace decoding = offline_meas::decoding;
+
+namespace
+{
+    struct Reading
+    {
+        uint32_t timestamp;
+        int32_t value;
+    };
+
+    /// Heart rate once a second: rest, exercise and recovery, with +-1 bpm jitter
+    std::vector<Reading> hr_trace(size_t seconds, uint32_t seed)
+    {
+        Random random(seed);
+        std::vector<Reading> out(seconds);
+        for (size_t i = 0; i < seconds; i++)
+        {
+            const size_t minute = i / 60 % 60;
+            const int32_t base = minute < 20 ? 62 : minute < 40 ? 62 + static_cast<int32_t>(minute - 20) * 5 : 160 - static_cast<int32_t>(minute - 40) * 4;
+            out[i] = { static_cast<uint32_t>(i * 1000 + random.uniform(30)), base + random.uniform(1) };
+        }
+        return out;
+    }
+
+    /// Temperature in degrees every 10 s, drifting slowly
+    std::vector<Reading> temperature_trace(size_t readings, uint32_t seed)
+    {
+        Random random(seed);
+        std::vector<Reading> out(readings);
+        for (size_t i = 0; i < readings; i++)
+            out[i] = { static_cast<uint32_t>(i * 10000), 30 + static_cast<int32_t>(i / 90 % 5) + (random.next() % 20 == 0) };
+        return out;
+    }
+
+    struct Settings
+    {
+        uint32_t hysteresis;
+        uint32_t minInterval; // ms
+        uint32_t heartbeat;   // ms
+    };
+
+    std::vector<Reading> record(const std::vector<Reading>& trace, const Settings& settings)
+    {
+        offline_meas::Deadband deadband(settings.hysteresis, settings.minInterval, settings.heartbeat);
+        std::vector<Reading> out;
+        for (const Reading& reading : trace)
+            if (deadband.update(reading.value, reading.timestamp))
+                out.push_back(reading);
+        return out;
+    }
+
+    /// The guarantees of the settings over the recorded readings
+    void check_guarantees(const std::vector<Reading>& trace, const std::vector<Reading>& recorded, const Settings& settings)
+    {
+        CHECK(!recorded.empty() && recorded[0].timestamp == trace[0].timestamp);
+
+        size_t next = 0; // Index of the next recorded reading in trace
+        const Reading* last = nullptr;
+        for (const Reading& reading : trace)
+        {
+            if (next < recorded.size() && recorded[next].timestamp == reading.timestamp)
+            {
+                if (last)
+                {
+                    const uint32_t elapsed = reading.timestamp - last->timestamp;
+                    const bool forced = settings.heartbeat > 0 && elapsed >= settings.heartbeat;
+                    CHECK(forced || elapsed >= settings.minInterval);
+                    CHECK(forced || uint32_t(std::abs(reading.value - last->value)) >= settings.hysteresis);
+                }
+                last = &recorded[next++];
+                continue;
+            }
+
+            // Skipped readings
+            const uint32_t elapsed = reading.timestamp - last->timestamp;
+            CHECK(settings.heartbeat == 0 || elapsed < settings.heartbeat);
+            CHECK(elapsed < settings.minInterval || uint32_t(std::abs(reading.value - last->value)) < settings.hysteresis);
+        }
+        CHECK(next == recorded.size());
+    }
+
+    /// Recorded readings through the slow compressor, returns the compressed size
+    size_t compress(const std::vector<Reading>& recorded, uint8_t valueBits)
+    {
+        SlowCompression<32> compressor;
+        compressor.set_format(valueBits, false);
+        BlockList sink;
+        for (const Reading& reading : recorded)
+            compressor.pack(reading.value, reading.timestamp, sink);
+        compressor.dump_buffer(sink);
+
+        std::vector<decoding::SlowRecord> decoded(recorded.size());
+        size_t total = 0;
+        size_t bytes = 0;
+        for (const Block& block : sink.blocks)
+        {
+            total += decoding::decode_slow_block(block.data.data(), block.data.size(), block.timestamp,
+                decoded.data() + total, decoded.size() - total);
+            bytes += block.data.size();
+        }
+
+        bool equal = CHECK(total == recorded.size());
+        for (size_t i = 0; equal && i < total; i++)
+            equal = CHECK(decoded[i].timestamp == recorded[i].timestamp && decoded[i].value == recorded[i].value);
+        return bytes;
+    }
+
+    void test_settings()
+    {
+        const Settings settings[] = {
+            { 0, 0, 0 },
+            { 1, 0, 0 },
+            { 2, 0, 0 },
+            { 2, 5000, 0 },
+            { 2, 0, 60000 },
+            { 3, 10000, 300000 },
+            { 5, 1000, 600000 },
+        };
+
+        for (uint32_t seed = 1; seed <= 3; seed++)
+        {
+            const auto trace = hr_trace(3600, seed);
+            size_t previous = trace.size() + 1;
+            for (const Settings& s : settings)
+            {
+                const auto recorded = record(trace, s);
+                check_guarantees(trace, recorded, s);
+                compress(recorded, 8);
+                if (s.minInterval == 0 && s.heartbeat == 0)
+                {
+                    // Larger hysteresis never records more
+                    CHECK(recorded.size() <= previous);
+                    previous = recorded.size();
+                }
+                if (s.hysteresis == 0 && s.minInterval == 0)
+                    CHECK(recorded.size() == trace.size());
+            }
+        }
+    }
+
+    /// Record counts and compressed sizes of an hour of HR and 10 h of temperature
+    void test_record_counts()
+    {
+        const auto hr = hr_trace(3600, 1);
+        const auto temperature = temperature_trace(3600, 1);
+        const Settings settings[] = { { 0, 0, 0 }, { 1, 0, 0 }, { 2, 0, 0 }, { 2, 0, 60000 }, { 3, 10000, 300000 } };
+
+        std::printf("hysteresis  min (s)  heartbeat (s)  HR records  bytes  temperature records  bytes\n");
+        size_t hrRecords[5];
+        size_t tempRecords[5];
+        for (size_t i = 0; i < 5; i++)
+        {
+            const auto hrRecorded = record(hr, settings[i]);
+            const auto tempRecorded = record(temperature, settings[i]);
+            hrRecords[i] = hrRecorded.size();
+            tempRecords[i] = tempRecorded.size();
+            std::printf("%10u %8u %14u %11zu %6zu %20zu %6zu\n", settings[i].hysteresis, settings[i].minInterval / 1000,
+                settings[i].heartbeat / 1000, hrRecorded.size(), compress(hrRecorded, 8), tempRecorded.size(),
+                compress(tempRecorded, 8));
+        }
+
+        // The default hysteresis of 1 drops the repeated values: temperature changes rarely (spikes aside),
+        // the jitter of HR is +-1 so 2 drops most of it
+        CHECK(tempRecords[1] * 5 < tempRecords[0]);
+        CHECK(hrRecords[2] * 2 < hrRecords[1]);
+        // The heartbeat adds at most a record a minute
+        CHECK(hrRecords[3] >= hrRecords[2] && hrRecords[3] <= hrRecords[2] + 60);
+    }
+} // namespace
+
+int main()
+{
+    test_settings();
+    test_record_counts();
+    return test_result("deadband_test");
+}
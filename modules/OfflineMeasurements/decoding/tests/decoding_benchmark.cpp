@@ -0,0 +1,233 @@
+// Decoding throughput of the host decoders, on streams encoded with the firmware encoders.
+//
+//   decoding_benchmark [rounds]
+//
+// MB/s is compressed (or serialized) input per second, Msamples/s the decoded samples
+// (vectors for IMU, readings for slow series).
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "Encoders.hpp"
+#include "Signals.hpp"
+#include "Decoding.hpp"
+
+using namespace offline_meas::testing;
+namespace decoding = offline_meas::decoding;
+
+namespace
+{
+    size_t g_rounds = 20;
+    volatile int64_t g_sink; // Keeps the decoded values alive
+
+    /// Runs decode g_rounds times and prints the throughput of the best round
+    template<typename TDecode>
+    void measure(const char* name, size_t inputBytes, size_t samples, TDecode&& decode)
+    {
+        double best = 1e30;
+        for (size_t round = 0; round < g_rounds; round++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            g_sink = decode();
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = elapsed.count() < best ? elapsed.count() : best;
+        }
+        std::printf("%-28s %10.1f MB/s %10.1f Msamples/s %8.2f bits/sample\n", name, inputBytes / best / 1e6,
+            samples / best / 1e6, 8.0 * inputBytes / samples);
+    }
+
+    std::vector<uint8_t> concatenate(const BlockList& sink)
+    {
+        std::vector<uint8_t> out;
+        for (const Block& block : sink.blocks)
+            out.insert(out.end(), block.data.begin(), block.data.end());
+        return out;
+    }
+
+    /// Prints the number of blocks of each coder, from the block headers (wavelet blocks are left out)
+    void print_coders(const BlockList& sink)
+    {
+        size_t counts[4] = {};
+        size_t ecgBlocks = 0;
+        for (const Block& block : sink.blocks)
+        {
+            const uint8_t marker = block.data[0];
+            if (marker == 0xFF)
+                continue; // Wavelet
+            const bool extended = marker == 0x00 || marker == 0xFE || marker == 0xFD;
+            counts[extended ? block.data[1] & 0x03 : static_cast<uint8_t>(ECGCoding::Gamma)]++;
+            ecgBlocks++;
+        }
+        if (ecgBlocks > 0)
+            std::printf("  coders per block: gamma %zu, rice %zu, raw %zu, zero run %zu\n", counts[0], counts[1],
+                counts[2], counts[3]);
+    }
+
+    template<typename TEncoder>
+    void benchmark_ecg(const char* name, TEncoder& encoder, const std::vector<int32_t>& samples, size_t blockSize)
+    {
+        BlockList sink;
+        for (size_t i = 0; i < samples.size(); i += 16)
+            encoder.pack_continuous(wb::MakeArray(samples.data() + i, WB_MIN(size_t(16), samples.size() - i)), sink);
+        encoder.dump_buffer(sink);
+
+        const std::vector<uint8_t> blocks = concatenate(sink);
+        std::vector<int32_t> out(samples.size());
+        measure(name, blocks.size(), samples.size(), [&]() {
+            size_t count = decoding::decode_ecg_blocks(blocks.data(), blocks.size() / blockSize, blockSize, out.data(),
+                out.size());
+            return count == samples.size() ? out[count / 2] : -1;
+        });
+        print_coders(sink);
+    }
+
+    struct ECGConfiguration
+    {
+        const char* name;
+        ECGCoding coding;
+        ECGPredictor predictor;
+        bool beatTemplate;
+    };
+
+    void benchmark_ecg(const ECGConfiguration& configuration, const std::vector<int32_t>& samples)
+    {
+        const size_t blockSize = configuration.coding == ECGCoding::Gamma ? 32 : 128;
+        offline_meas::compression::ECGBeatTemplate beatTemplate;
+        ECGCompression<256, int32_t, int32_t> compressor;
+        compressor.set_block_size(blockSize);
+        compressor.set_coding(configuration.coding);
+        compressor.set_predictor(configuration.predictor);
+        compressor.set_beat_template(configuration.beatTemplate ? &beatTemplate : nullptr);
+        benchmark_ecg(configuration.name, compressor, samples, blockSize);
+    }
+
+    void benchmark_ecg()
+    {
+        const std::vector<int32_t> samples = ecg_signal(250 * 600, 1); // 10 min at 250 Hz
+        const ECGConfiguration configurations[] = {
+            { "ECG gamma, 32 B", ECGCoding::Gamma, ECGPredictor::FirstOrder, false },
+            { "ECG rice, LPC", ECGCoding::Rice, ECGPredictor::LPC, false },
+            { "ECG zero run", ECGCoding::ZeroRun, ECGPredictor::SecondOrder, false },
+            { "ECG adaptive", ECGCoding::Adaptive, ECGPredictor::LPC, false },
+            { "ECG rice, beat template", ECGCoding::Rice, ECGPredictor::LPC, true },
+        };
+
+        for (const auto& configuration : configurations)
+            benchmark_ecg(configuration, samples);
+
+        ECGWaveletCompression<256, 64, int32_t> wavelet;
+        wavelet.set_block_size(128);
+        wavelet.set_levels(3);
+        benchmark_ecg("ECG wavelet, 3 levels", wavelet, samples, 128);
+
+        // The leads are off a third of the time, the zero run coder can win those blocks
+        const std::vector<int32_t> leadOff = lead_off_signal(250 * 600, 1);
+        benchmark_ecg({ "ECG lead-off, rice, LPC", ECGCoding::Rice, ECGPredictor::LPC, false }, leadOff);
+        benchmark_ecg({ "ECG lead-off, adaptive", ECGCoding::Adaptive, ECGPredictor::LPC, false }, leadOff);
+    }
+
+    void benchmark_imu()
+    {
+        const std::vector<int32_t> vectors = imu_signal(104 * 300, 1, 24); // 5 min at 104 Hz
+        IMUCompression<256> compressor;
+        compressor.set_format(24, 12);
+        compressor.set_predictor(IMUPredictor::Adaptive);
+        BlockList sink;
+        for (size_t i = 0; i < vectors.size() / 3; i += 8)
+            compressor.pack_continuous(vectors.data() + i * 3, WB_MIN(size_t(8), vectors.size() / 3 - i), sink);
+        compressor.dump_buffer(sink);
+
+        size_t bytes = 0;
+        for (const Block& block : sink.blocks)
+            bytes += block.data.size();
+
+        std::vector<float> out(vectors.size());
+        measure("IMU compressed, float", bytes, vectors.size() / 3, [&]() {
+            size_t total = 0;
+            for (const Block& block : sink.blocks)
+                total += decoding::decode_imu_block(block.data.data(), block.data.size(), out.data() + total * 3,
+                    out.size() / 3 - total);
+            return static_cast<int64_t>(total + out[0]);
+        });
+
+        // Uncompressed Q12.12 records
+        std::vector<uint8_t> serialized(vectors.size() * decoding::Q24_BYTES);
+        for (size_t i = 0; i < vectors.size(); i++)
+            for (size_t b = 0; b < decoding::Q24_BYTES; b++)
+                serialized[i * 3 + b] = static_cast<uint8_t>(vectors[i] >> (8 * b));
+        measure("IMU Q12.12 unpack", serialized.size(), vectors.size() / 3, [&]() {
+            decoding::unpack_vec3_q12_12(serialized.data(), vectors.size() / 3, out.data());
+            return static_cast<int64_t>(out[out.size() / 2]);
+        });
+    }
+
+    void benchmark_rr()
+    {
+        const std::vector<uint16_t> intervals = rr_signal(100000, 1);
+        RRCompression<32> compressor;
+        BlockList sink;
+        compressor.pack_continuous(intervals.data(), intervals.size(), sink);
+        compressor.dump_buffer(sink);
+
+        const std::vector<uint8_t> blocks = concatenate(sink);
+        std::vector<uint16_t> out(intervals.size());
+        measure("RR compressed", blocks.size(), intervals.size(), [&]() {
+            size_t total = 0;
+            for (size_t offset = 0; offset < blocks.size(); offset += 32)
+                total += decoding::decode_rr_block(blocks.data() + offset, 32, out.data() + total, out.size() - total);
+            return static_cast<int64_t>(total);
+        });
+
+        std::vector<uint8_t> chunks(intervals.size() / 8 * decoding::RR_CHUNK_BYTES);
+        for (size_t i = 0; i < chunks.size() / decoding::RR_CHUNK_BYTES; i++)
+            offline_meas::compression::bit_pack::pack<12, 8>(intervals.data() + i * 8, chunks.data() + i * 12);
+        measure("RR 12-bit chunks", chunks.size(), chunks.size() / 12 * 8, [&]() {
+            return static_cast<int64_t>(decoding::unpack_rr_chunks(chunks.data(), chunks.size() / 12, out.data()));
+        });
+    }
+
+    void benchmark_slow()
+    {
+        Random random(1);
+        SlowCompression<32> compressor;
+        compressor.set_format(8, false);
+        BlockList sink;
+        int32_t hr = 70;
+        const size_t readings = 100000;
+        for (size_t i = 0; i < readings; i++)
+        {
+            hr += random.uniform(1);
+            hr = hr < 40 ? 40 : hr > 200 ? 200 : hr;
+            compressor.pack(hr, static_cast<uint32_t>(i * 1000 + random.uniform(20)), sink);
+        }
+        compressor.dump_buffer(sink);
+
+        size_t bytes = 0;
+        for (const Block& block : sink.blocks)
+            bytes += block.data.size();
+
+        std::vector<decoding::SlowRecord> out(readings);
+        measure("HR compressed", bytes, readings, [&]() {
+            size_t total = 0;
+            for (const Block& block : sink.blocks)
+                total += decoding::decode_slow_block(block.data.data(), block.data.size(), block.timestamp,
+                    out.data() + total, out.size() - total);
+            return static_cast<int64_t>(total);
+        });
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc > 1)
+        g_rounds = std::strtoul(argv[1], nullptr, 10);
+    if (g_rounds == 0)
+        g_rounds = 1;
+
+    benchmark_ecg();
+    benchmark_imu();
+    benchmark_rr();
+    benchmark_slow();
+    return 0;
+}
@@ -0,0 +1,129 @@
+// Near-lossless ECG (ECGCompression::set_max_error): every decoded sample is within the
+// maximum error of the input, and a larger error bound takes fewer bits per sample.
+#include <cstdio>
+#include <cstdlib>
+
+#include "Check.hpp"
+#include "Encoders.hpp"
+#include "Signals.hpp"
+#include "ECGDecoder.hpp"
+
+using namespace offline_meas::testing;
+namespace decoding = offline_meas::decoding;
+
+namespace
+{
+    using Compressor = ECGCompression<256, int32_t, int32_t>;
+
+    struct Result
+    {
+        bool bounded;
+        double bitsPerSample;
+    };
+
+    Result run(Compressor& compressor, const std::vector<int32_t>& samples, uint8_t maxError)
+    {
+        BlockList sink;
+        for (size_t i = 0; i < samples.size(); i += 16)
+            compressor.pack_continuous(wb::MakeArray(samples.data() + i, WB_MIN(size_t(16), samples.size() - i)), sink);
+        compressor.dump_buffer(sink);
+
+        std::vector<int32_t> decoded(samples.size());
+        decoding::ECGBeatTemplate beatTemplate;
+        size_t total = 0;
+        size_t bytes = 0;
+        for (const Block& block : sink.blocks)
+        {
+            CHECK(decoding::ecg_block_max_error(block.data.data()) == maxError);
+            total += decoding::decode_ecg_block(block.data.data(), block.data.size(), decoded.data() + total,
+                decoded.size() - total, &beatTemplate);
+            bytes += block.data.size();
+        }
+
+        bool bounded = CHECK(total == samples.size());
+        for (size_t i = 0; bounded && i < total; i++)
+            bounded = CHECK(std::abs(decoded[i] - samples[i]) <= maxError);
+        return { bounded, 8.0 * bytes / samples.size() };
+    }
+
+    void test_error_bound()
+    {
+        const ECGCoding codings[] = { ECGCoding::Gamma, ECGCoding::Rice, ECGCoding::ZeroRun, ECGCoding::Adaptive };
+        const ECGPredictor predictors[] = { ECGPredictor::FirstOrder, ECGPredictor::SecondOrder, ECGPredictor::LPC };
+
+        for (uint8_t bitDepth : { 16, 18 })
+            for (ECGCoding coding : codings)
+                for (ECGPredictor predictor : predictors)
+                    for (bool withTemplate : { false, true })
+                        for (uint8_t maxError : { 1, 2, 4, 7, 15 })
+                        {
+                            const int32_t scale = 1 << (bitDepth - 16);
+                            offline_meas::compression::ECGBeatTemplate beatTemplate;
+                            Compressor compressor;
+                            compressor.set_block_size(64);
+                            compressor.set_bit_depth(bitDepth);
+                            compressor.set_coding(coding);
+                            compressor.set_predictor(predictor);
+                            compressor.set_beat_template(withTemplate ? &beatTemplate : nullptr);
+                            CHECK(compressor.set_max_error(maxError));
+
+                            // Clipped and full-scale signals quantize near the limits of the bit depth
+                            for (const auto& samples : { ecg_signal(2500, 1, 2000 * scale, 16 * scale, 250, bitDepth),
+                                     ecg_signal(800, 2, 40000 * scale, 100 * scale, 128, bitDepth),
+                                     noise_signal(500, 3, bitDepth) })
+                            {
+                                compressor.reset();
+                                if (!run(compressor, samples, maxError).bounded)
+                                {
+                                    std::printf("  coding %d, predictor %d, %d bits%s, max error %d\n", int(coding),
+                                        int(predictor), bitDepth, withTemplate ? ", template" : "", maxError);
+                                    break;
+                                }
+                            }
+                        }
+
+        Compressor compressor;
+        CHECK(!compressor.set_max_error(Compressor::MAX_ERROR + 1));
+    }
+
+    /// Prints the bits/sample of each error bound. Each doubling of the quantization step
+    /// saves about a bit per sample while the residuals are above the step.
+    void test_gain()
+    {
+        const auto samples = ecg_signal(250 * 120, 4, 2000, 24);
+        double previous = 0;
+        double lossless = 0;
+        for (uint8_t maxError : { 0, 1, 2, 4, 8, 15 })
+        {
+            Compressor compressor;
+            compressor.set_block_size(128);
+            compressor.set_coding(ECGCoding::Rice);
+            compressor.set_predictor(ECGPredictor::LPC);
+            compressor.set_max_error(maxError);
+            const Result result = run(compressor, samples, maxError);
+
+            if (maxError == 0)
+                lossless = result.bitsPerSample;
+            else
+                CHECK(result.bitsPerSample < previous);
+            std::printf("max error %2d: %5.2f bits/sample, %4.2f bits less than lossless\n", maxError,
+                result.bitsPerSample, lossless - result.bitsPerSample);
+            previous = result.bitsPerSample;
+        }
+
+        // Step 3 (max error 1) is log2(3) = 1.58 bits smaller, allow for the block overhead
+        Compressor compressor;
+        compressor.set_block_size(128);
+        compressor.set_coding(ECGCoding::Rice);
+        compressor.set_predictor(ECGPredictor::LPC);
+        compressor.set_max_error(1);
+        CHECK(lossless - run(compressor, samples, 1).bitsPerSample > 1.0);
+    }
+} // namespace
+
+int main()
+{
+    test_error_bound();
+    test_gain();
+    return test_result("ecg_near_lossless_test");
+}
@@ -0,0 +1,256 @@
+// Round trip of the firmware ECG encoders (ECGCompression, ECGWaveletCompression)
+// through decode_ecg_block: lossless configurations have to reproduce the samples exactly.
+#include <algorithm>
+#include <cstdio>
+
+#include "Check.hpp"
+#include "Encoders.hpp"
+#include "Signals.hpp"
+#include "ECGDecoder.hpp"
+
+using namespace offline_meas::testing;
+namespace decoding = offline_meas::decoding;
+
+namespace
+{
+    using Compressor = ECGCompression<256, int32_t, int32_t>;
+
+    constexpr size_t NOTIFICATION_SAMPLES = 16;
+
+    /// Feed the encoder like the firmware does, one notification at a time, and flush at the end
+    template<typename TEncoder>
+    BlockList encode(TEncoder& encoder, const std::vector<int32_t>& samples)
+    {
+        BlockList sink;
+        for (size_t i = 0; i < samples.size(); i += NOTIFICATION_SAMPLES)
+        {
+            const size_t count = WB_MIN(NOTIFICATION_SAMPLES, samples.size() - i);
+            encoder.pack_continuous(wb::MakeArray(samples.data() + i, count), sink);
+        }
+        encoder.dump_buffer(sink);
+        return sink;
+    }
+
+    std::vector<int32_t> decode(const BlockList& sink, size_t maxSamples)
+    {
+        std::vector<int32_t> out(maxSamples + 1);
+        decoding::ECGBeatTemplate beatTemplate;
+        size_t total = 0;
+        for (const Block& block : sink.blocks)
+        {
+            if (total == out.size())
+                break;
+            total += decoding::decode_ecg_block(block.data.data(), block.data.size(), out.data() + total,
+                out.size() - total, &beatTemplate);
+        }
+        out.resize(total);
+        return out;
+    }
+
+    bool round_trip(const char* name, const BlockList& sink, const std::vector<int32_t>& samples)
+    {
+        const std::vector<int32_t> decoded = decode(sink, samples.size());
+        if (!CHECK(decoded == samples))
+        {
+            size_t first = 0;
+            while (first < decoded.size() && first < samples.size() && decoded[first] == samples[first])
+                first++;
+            std::printf("  %s: %zu samples in, %zu out, first difference at %zu\n", name, samples.size(),
+                decoded.size(), first);
+            return false;
+        }
+        return true;
+    }
+
+    std::vector<std::vector<int32_t>> signals(uint8_t bitDepth)
+    {
+        const int32_t scale = 1 << (bitDepth - 16);
+        std::vector<std::vector<int32_t>> out;
+        for (uint32_t seed = 1; seed <= 3; seed++)
+        {
+            out.push_back(ecg_signal(3000, seed, 2000 * scale, 4 * scale, 250, bitDepth));
+            out.push_back(ecg_signal(1000, seed, 30000 * scale, 200 * scale, 128, bitDepth)); // Clipping
+            out.push_back(noise_signal(700, seed, bitDepth));
+        }
+        out.push_back(std::vector<int32_t>(1000, 0));
+        out.push_back(std::vector<int32_t>(1000, -(1 << (bitDepth - 1))));
+        for (size_t length : { 1, 2, 15, 16, 17, 33 })
+            out.push_back(ecg_signal(length, 7, 2000 * scale, 4 * scale, 250, bitDepth));
+
+        std::vector<int32_t> steps(600);
+        for (size_t i = 0; i < steps.size(); i++) // Alternating full-scale steps
+            steps[i] = (i / 3) % 2 ? (1 << (bitDepth - 1)) - 1 : -(1 << (bitDepth - 1));
+        out.push_back(steps);
+        return out;
+    }
+
+    void test_predictive()
+    {
+        const ECGCoding codings[] = { ECGCoding::Gamma, ECGCoding::Rice, ECGCoding::Raw, ECGCoding::ZeroRun,
+            ECGCoding::Adaptive };
+        const ECGPredictor predictors[] = { ECGPredictor::FirstOrder, ECGPredictor::ZeroOrder,
+            ECGPredictor::SecondOrder, ECGPredictor::LPC };
+
+        for (uint8_t bitDepth : { 16, 18 })
+        {
+            const auto inputs = signals(bitDepth);
+            for (ECGCoding coding : codings)
+                for (ECGPredictor predictor : predictors)
+                    for (size_t blockSize : { 32, 64, 256 })
+                        for (bool withTemplate : { false, true })
+                        {
+                            offline_meas::compression::ECGBeatTemplate beatTemplate;
+                            Compressor compressor;
+                            CHECK(compressor.set_block_size(blockSize));
+                            CHECK(compressor.set_bit_depth(bitDepth));
+                            compressor.set_coding(coding);
+                            compressor.set_predictor(predictor);
+                            compressor.set_beat_template(withTemplate ? &beatTemplate : nullptr);
+
+                            char name[96];
+                            std::snprintf(name, sizeof(name), "coding %d, predictor %d, %zu B, %d bits%s",
+                                int(coding), int(predictor), blockSize, bitDepth, withTemplate ? ", template" : "");
+
+                            // One compressor over all signals: reset() has to start each stream cleanly
+                            for (const auto& samples : inputs)
+                            {
+                                compressor.reset();
+                                if (!round_trip(name, encode(compressor, samples), samples))
+                                    break;
+                            }
+                        }
+        }
+    }
+
+    /// Windows are split to fill the blocks, down to single samples in the smallest blocks
+    template<size_t WindowSize>
+    void test_wavelet()
+    {
+        using Wavelet = ECGWaveletCompression<256, WindowSize, int32_t>;
+        for (uint8_t bitDepth : { 16, 18 })
+        {
+            const auto inputs = signals(bitDepth);
+            for (uint8_t levels = 1; levels <= Wavelet::MAX_LEVELS; levels++)
+                for (size_t blockSize : { 32, 64, 256 })
+                {
+                    Wavelet wavelet;
+                    CHECK(wavelet.set_block_size(blockSize));
+                    CHECK(wavelet.set_bit_depth(bitDepth));
+                    CHECK(wavelet.set_levels(levels));
+
+                    char name[96];
+                    std::snprintf(name, sizeof(name), "wavelet, %zu window, %d levels, %zu B, %d bits", WindowSize, levels,
+                        blockSize, bitDepth);
+                    for (const auto& samples : inputs)
+                    {
+                        wavelet.reset();
+                        if (!round_trip(name, encode(wavelet, samples), samples))
+                            break;
+                    }
+                }
+        }
+    }
+
+    size_t block_sample_count(const Block& block)
+    {
+        return block.data[2] | ((block.data[3] & 0x0F) << 8);
+    }
+
+    /// Beat template streams restart every TEMPLATE_RESTART_BLOCKS blocks and after a
+    /// flush, so that decoding recovers at the next 0xFD block when a block is lost
+    void test_template_restart()
+    {
+        const auto samples = ecg_signal(60000, 3);
+        offline_meas::compression::ECGBeatTemplate beatTemplate;
+        Compressor compressor;
+        CHECK(compressor.set_block_size(64));
+        compressor.set_coding(ECGCoding::Rice);
+        compressor.set_predictor(ECGPredictor::LPC);
+        compressor.set_beat_template(&beatTemplate);
+        const BlockList sink = encode(compressor, samples);
+
+        size_t restarts = 0;
+        for (size_t i = 0; i < sink.blocks.size(); i++)
+        {
+            const bool restart = sink.blocks[i].data[0] == Compressor::TEMPLATE_RESTART_BLOCK_MARKER;
+            CHECK(restart == (i % Compressor::TEMPLATE_RESTART_BLOCKS == 0));
+            CHECK(restart || sink.blocks[i].data[0] == Compressor::TEMPLATE_BLOCK_MARKER);
+            restarts += restart ? 1 : 0;
+        }
+        CHECK(restarts >= 3);
+
+        // Drop a block in the middle of the first template, and decode the rest in order
+        const size_t dropped = Compressor::TEMPLATE_RESTART_BLOCKS / 2;
+        decoding::ECGBeatTemplate decoderTemplate;
+        std::vector<int32_t> out(4096);
+        size_t first = 0; // Index of the first sample of the block
+        size_t recovered = 0;
+        for (size_t i = 0; i < sink.blocks.size(); i++)
+        {
+            const Block& block = sink.blocks[i];
+            const size_t count = block_sample_count(block);
+            if (i != dropped)
+            {
+                const size_t decoded = decoding::decode_ecg_block(block.data.data(), block.data.size(), out.data(),
+                    out.size(), &decoderTemplate);
+                if (i >= Compressor::TEMPLATE_RESTART_BLOCKS)
+                {
+                    if (!CHECK(decoded == count && std::equal(out.begin(), out.begin() + count, samples.begin() + first)))
+                    {
+                        std::printf("  block %zu after the lost block %zu not decoded\n", i, dropped);
+                        break;
+                    }
+                    recovered++;
+                }
+            }
+            first += count;
+        }
+        CHECK(first == samples.size());
+        CHECK(recovered == sink.blocks.size() - Compressor::TEMPLATE_RESTART_BLOCKS);
+
+        // A flush on a gap restarts the template, the blocks after it decode alone
+        const std::vector<int32_t> before(samples.begin(), samples.begin() + 3000);
+        const std::vector<int32_t> after(samples.begin() + 5000, samples.begin() + 8000);
+        compressor.reset();
+        const BlockList beforeGap = encode(compressor, before);
+        const BlockList afterGap = encode(compressor, after);
+        CHECK(beforeGap.blocks.size() > 1 && afterGap.blocks.size() > 1);
+        CHECK(afterGap.blocks[0].data[0] == Compressor::TEMPLATE_RESTART_BLOCK_MARKER);
+        round_trip("template after a gap", afterGap, after);
+    }
+
+    /// Headers: sample counts add up and the bit depth is recorded
+    void test_block_headers()
+    {
+        const auto samples = ecg_signal(2000, 5, 2000 << 2, 16, 250, 18);
+        Compressor compressor;
+        compressor.set_block_size(64);
+        compressor.set_bit_depth(18);
+        compressor.set_coding(ECGCoding::Rice);
+        const BlockList sink = encode(compressor, samples);
+
+        size_t total = 0;
+        for (const Block& block : sink.blocks)
+        {
+            CHECK(block.data.size() == 64);
+            CHECK(decoding::ecg_block_bit_depth(block.data.data()) == 18);
+            total += block.data[2] | ((block.data[3] & 0x0F) << 8);
+        }
+        CHECK(total == samples.size());
+
+        // 18-bit blocks are not decoded into 16-bit samples
+        int16_t narrow[1024];
+        CHECK(decoding::decode_ecg_block(sink.blocks[0].data.data(), 64, narrow, 1024) == 0);
+    }
+} // namespace
+
+int main()
+{
+    test_predictive();
+    test_wavelet<16>();
+    test_wavelet<64>();
+    test_wavelet<128>();
+    test_block_headers();
+    test_template_restart();
+    return test_result("ecg_roundtrip_test");
+}
@@ -0,0 +1,270 @@
+// Encoding cost of the firmware encoders, fed one notification at a time like in the
+// firmware: against the implementations they replaced (Legacy.hpp), the ECG block sink
+// per notification, and the size and error of the ECG coders. Samples are values for
+// the bit packing and 3D vectors for the fixed-point conversions.
+//
+//   encoder_benchmark [rounds]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+#include "ECGDecoder.hpp"
+#include "Encoders.hpp"
+#include "Legacy.hpp"
+#include "Signals.hpp"
+#include "Timing.hpp"
+
+using namespace offline_meas::testing;
+namespace decoding = offline_meas::decoding;
+
+namespace
+{
+    constexpr size_t NOTIFICATION_SAMPLES = 16;
+
+    size_t g_rounds = 20;
+
+    /// Prints the best of g_rounds runs of work over samples, per sample and per second
+    template<typename TWork>
+    void measure(const char* name, size_t samples, TWork&& work)
+    {
+        double seconds = 1e30;
+        const double best = best_of(g_rounds, [&] {
+            const auto start = std::chrono::steady_clock::now();
+            work();
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            seconds = elapsed.count() < seconds ? elapsed.count() : seconds;
+        });
+        std::printf("%-34s %8.1f %s %8.1f Msamples/s\n", name, best / samples, per_sample_unit(),
+            samples / seconds / 1e6);
+    }
+
+    /// Elias Gamma, first order, 32 B blocks: write_bits and log2f before, BitWriter after
+    void benchmark_gamma()
+    {
+        const std::vector<int32_t> samples = ecg_signal(250 * 600, 1); // 10 min at 250 Hz
+        const std::vector<int16_t> narrow(samples.begin(), samples.end());
+
+        measure("ECG gamma, write_bits (before)", samples.size(), [&] {
+            legacy::ECGCompression<32, int16_t, int32_t> encoder;
+            auto write = [](uint8_t* block) { g_sink = g_sink + block[0]; };
+            for (size_t i = 0; i < narrow.size(); i += NOTIFICATION_SAMPLES)
+                encoder.pack_continuous(
+                    wb::MakeArray(narrow.data() + i, WB_MIN(NOTIFICATION_SAMPLES, narrow.size() - i)), write);
+            encoder.dump_buffer(write);
+        });
+
+        measure("ECG gamma, BitWriter", samples.size(), [&] {
+            ECGCompression<256, int32_t, int32_t> encoder;
+            auto write = [](uint8_t* block, size_t) { g_sink = g_sink + block[0]; };
+            for (size_t i = 0; i < samples.size(); i += NOTIFICATION_SAMPLES)
+                encoder.pack_continuous(
+                    wb::MakeArray(samples.data() + i, WB_MIN(NOTIFICATION_SAMPLES, samples.size() - i)), write);
+            encoder.dump_buffer(write);
+        });
+    }
+
+    /// RR chunks, 8 values of 12 bits: per-value bit_pack::write before, BitPack after
+    void benchmark_bit_pack()
+    {
+        constexpr uint8_t BITS = 12;
+        constexpr size_t N = 8;
+        using Pack = offline_meas::compression::BitPack<BITS, N>;
+
+        const std::vector<uint16_t> values = rr_signal(65536, 1);
+        std::vector<uint8_t> out(values.size() / N * Pack::BYTES);
+
+        measure("RR 12 bit chunks, write (before)", values.size(), [&] {
+            for (size_t i = 0; i + N <= values.size(); i += N)
+            {
+                for (uint8_t j = 0; j < N; j++)
+                    legacy::bit_pack::write<uint16_t, BITS, N>(values[i + j], &out[i / N * Pack::BYTES], j);
+            }
+            g_sink = g_sink + out[out.size() / 2];
+        });
+
+        measure("RR 12 bit chunks, BitPack", values.size(), [&] {
+            for (size_t i = 0; i + N <= values.size(); i += N)
+                Pack::pack(&values[i], &out[i / N * Pack::BYTES]);
+            g_sink = g_sink + out[out.size() / 2];
+        });
+    }
+
+    /// IMU notifications of 8 vectors: round() per component before, the batch conversion after
+    template<typename TVector, typename TLegacy, typename TConvert>
+    void benchmark_fixed_point(const char* name, const char* legacyName, const std::vector<wb::FloatVector3D>& in,
+        TLegacy legacy, TConvert convert)
+    {
+        constexpr size_t PER_NOTIFICATION = 8;
+        std::vector<TVector> out(in.size());
+
+        measure(legacyName, in.size(), [&] {
+            for (size_t i = 0; i < in.size(); i++)
+            {
+                out[i].x = legacy(in[i].x);
+                out[i].y = legacy(in[i].y);
+                out[i].z = legacy(in[i].z);
+            }
+            g_sink = g_sink + out[out.size() / 2].x.b0;
+        });
+
+        measure(name, in.size(), [&] {
+            for (size_t i = 0; i + PER_NOTIFICATION <= in.size(); i += PER_NOTIFICATION)
+                convert(wb::MakeArray(&in[i], PER_NOTIFICATION), &out[i]);
+            g_sink = g_sink + out[out.size() / 2].x.b0;
+        });
+    }
+
+    void benchmark_fixed_point()
+    {
+        Random random(1);
+        std::vector<wb::FloatVector3D> in(65536);
+        for (auto& v : in)
+        {
+            v.x = static_cast<float>(random.uniform(1 << 20)) / (1 << 12);
+            v.y = static_cast<float>(random.uniform(1 << 20)) / (1 << 12);
+            v.z = static_cast<float>(random.uniform(1 << 20)) / (1 << 12);
+        }
+
+        benchmark_fixed_point<WB_RES::Vec3_Q12_12>("Q12.12 vectors, batch", "Q12.12 vectors, round() (before)", in,
+            legacy::float_to_fixed_point_Q12_12,
+            [](const wb::Array<wb::FloatVector3D>& vectors, WB_RES::Vec3_Q12_12* out) {
+                offline_meas::compression::float_to_fixed_point_Q12_12(vectors, out);
+            });
+        benchmark_fixed_point<WB_RES::Vec3_Q10_6>("Q10.6 vectors, batch", "Q10.6 vectors, round() (before)", in,
+            legacy::float_to_fixed_point_Q10_6,
+            [](const wb::Array<wb::FloatVector3D>& vectors, WB_RES::Vec3_Q10_6* out) {
+                offline_meas::compression::float_to_fixed_point_Q10_6(vectors, out);
+            });
+    }
+
+    /// Stands in for updateResource, not inlined into the encoder
+    __attribute__((noinline)) void write_block(uint8_t* block, size_t size)
+    {
+        g_sink = g_sink + block[size - 1];
+    }
+
+    /// Time per notification of the ECG encoder with the block sink as a std::function built on
+    /// every notification (before), and as a lambda resolved at compile time
+    void benchmark_ecg_sink(const char* name, ECGCoding coding, size_t blockSize, const std::vector<int32_t>& samples)
+    {
+        using Compressor = ECGCompression<256, int32_t, int32_t>;
+        const size_t notifications = (samples.size() + NOTIFICATION_SAMPLES - 1) / NOTIFICATION_SAMPLES;
+
+        auto run = [&](Compressor& encoder, auto&& notify) {
+            encoder.set_block_size(blockSize);
+            encoder.set_coding(coding);
+            encoder.set_predictor(coding == ECGCoding::Gamma ? ECGPredictor::FirstOrder : ECGPredictor::LPC);
+            for (size_t i = 0; i < samples.size(); i += NOTIFICATION_SAMPLES)
+                notify(wb::MakeArray(samples.data() + i, WB_MIN(NOTIFICATION_SAMPLES, samples.size() - i)));
+        };
+
+        // Alternating, so that both see the same state of the host
+        Compressor encoder;
+        double function = 1e30;
+        double lambda = 1e30;
+        for (size_t round = 0; round < g_rounds; round++)
+        {
+            function = std::min(function, best_of(1, [&] {
+                run(encoder, [&](const wb::Array<int32_t>& notification) {
+                    std::function<void(uint8_t*, size_t)> sink = [](uint8_t* block, size_t size) { write_block(block, size); };
+                    encoder.pack_continuous(notification, sink);
+                });
+            }));
+            lambda = std::min(lambda, best_of(1, [&] {
+                run(encoder, [&](const wb::Array<int32_t>& notification) {
+                    encoder.pack_continuous(notification, [](uint8_t* block, size_t size) { write_block(block, size); });
+                });
+            }));
+        }
+
+        std::printf("%-34s %8.0f -> %4.0f %s/notification\n", name, function / notifications, lambda / notifications,
+            clock_unit());
+    }
+
+    void benchmark_ecg_sink()
+    {
+        const std::vector<int32_t> samples = ecg_signal(256 * 600, 1, 2000, 8, 256); // 10 min at 256 Hz
+        std::printf("ECG sink, std::function (before) -> lambda:\n");
+        benchmark_ecg_sink("  gamma, 32 B", ECGCoding::Gamma, 32, samples);
+        benchmark_ecg_sink("  gamma, 256 B", ECGCoding::Gamma, 256, samples);
+        benchmark_ecg_sink("  rice, 32 B", ECGCoding::Rice, 32, samples);
+        benchmark_ecg_sink("  rice, 256 B", ECGCoding::Rice, 256, samples);
+    }
+
+    /// Bits per sample and encoding time of an ECG encoder over samples at 256 B blocks, with
+    /// the reconstruction error of the decoded blocks
+    template<typename TEncoder>
+    void benchmark_ecg_coder(const char* name, TEncoder& encoder, const std::vector<int32_t>& samples)
+    {
+        constexpr size_t BLOCK_SIZE = 256;
+        BlockList sink;
+        const double best = best_of(g_rounds, [&] {
+            sink.blocks.clear();
+            encoder.reset();
+            for (size_t i = 0; i < samples.size(); i += NOTIFICATION_SAMPLES)
+                encoder.pack_continuous(
+                    wb::MakeArray(samples.data() + i, WB_MIN(NOTIFICATION_SAMPLES, samples.size() - i)), sink);
+            encoder.dump_buffer(sink);
+        });
+
+        std::vector<int32_t> decoded(samples.size());
+        size_t count = 0;
+        for (const Block& block : sink.blocks)
+            count += decoding::decode_ecg_block(block.data.data(), block.data.size(), decoded.data() + count,
+                decoded.size() - count);
+
+        int32_t maxError = 0;
+        double squares = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            const int32_t error = std::abs(decoded[i] - samples[i]);
+            maxError = std::max(maxError, error);
+            squares += double(error) * error;
+        }
+
+        const double bits = 8.0 * sink.blocks.size() * BLOCK_SIZE / samples.size();
+        std::printf("  %-24s %5.2f bits/sample %5.2f:1 %6.1f %s, max error %d, rms %.1f%s\n", name, bits, 16 / bits,
+            best / samples.size(), per_sample_unit(), maxError, std::sqrt(squares / samples.size()),
+            count == samples.size() ? "" : " (samples missing)");
+    }
+
+    /// The wavelet engine at the thresholds of its introduction against the predictive coder,
+    /// 256 Hz ECG in 256 B blocks. The ratio is to 16-bit samples, without the block timestamps.
+    void benchmark_wavelet()
+    {
+        const std::vector<int32_t> samples = ecg_signal(256 * 600, 1, 2000, 8, 256); // 10 min at 256 Hz
+        std::printf("ECG coders, 256 Hz, 256 B blocks:\n");
+
+        ECGCompression<256, int32_t, int32_t> predictive;
+        predictive.set_block_size(256);
+        predictive.set_coding(ECGCoding::Rice);
+        predictive.set_predictor(ECGPredictor::FirstOrder);
+        benchmark_ecg_coder("rice, first order", predictive, samples);
+
+        for (uint8_t threshold : { 0, 8, 12 })
+        {
+            ECGWaveletCompression<256, 64, int32_t> wavelet; // The window of the firmware
+            wavelet.set_block_size(256);
+            wavelet.set_threshold(threshold);
+            char name[32];
+            std::snprintf(name, sizeof(name), "wavelet, threshold %u", threshold);
+            benchmark_ecg_coder(name, wavelet, samples);
+        }
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    g_rounds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : g_rounds;
+    g_rounds = g_rounds > 0 ? g_rounds : 1;
+
+    benchmark_gamma();
+    benchmark_bit_pack();
+    benchmark_fixed_point();
+    benchmark_ecg_sink();
+    benchmark_wavelet();
+    return 0;
+}
@@ -0,0 +1,218 @@
+// Round trip of the firmware fixed-point conversions (FixedPoint.hpp) through the
+// unpack functions of FixedPointDecoder.hpp, and the conversions against the round()
+// based ones they replaced (Legacy.hpp). Built with SSSE3 when the compiler has it,
+// the vector path of unpack_q24 is compared with the scalar conversion.
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "Check.hpp"
+#include "Encoders.hpp"
+#include "Legacy.hpp"
+#include "Signals.hpp"
+#include "FixedPointDecoder.hpp"
+
+using namespace offline_meas::testing;
+namespace compression = offline_meas::compression;
+namespace decoding = offline_meas::decoding;
+
+namespace
+{
+    /// Vectors over the range of a format, including values beyond it and halfway cases
+    std::vector<wb::FloatVector3D> vectors(size_t count, uint32_t seed, float range, uint8_t fractionBits)
+    {
+        Random random(seed);
+        std::vector<wb::FloatVector3D> out(count);
+        const float lsb = 1.0f / (1u << fractionBits);
+        for (size_t i = 0; i < count; i++)
+        {
+            float* components = &out[i].x;
+            for (size_t axis = 0; axis < 3; axis++)
+            {
+                const float unit = static_cast<float>(random.uniform(1 << 20)) / (1 << 20);
+                components[axis] = i % 7 == 0 ? (random.uniform(1 << 12) + 0.5f) * lsb : 1.2f * range * unit;
+            }
+        }
+        return out;
+    }
+
+    /// Decoded value is the input rounded to the format, or its limit
+    bool within(float decoded, float input, uint8_t fractionBits, float min, float max)
+    {
+        const float expected = input > max ? max : input < min ? min : input;
+        return std::fabs(decoded - expected) <= 0.5f / (1u << fractionBits);
+    }
+
+    void test_q12_12()
+    {
+        const auto input = vectors(1001, 1, 2048.0f, 12);
+        std::vector<WB_RES::Vec3_Q12_12> fixed(input.size());
+        compression::float_to_fixed_point_Q12_12(wb::MakeArray(input.data(), input.size()), fixed.data());
+
+        std::vector<float> decoded(input.size() * 3);
+        decoding::unpack_vec3_q12_12(reinterpret_cast<const uint8_t*>(fixed.data()), input.size(), decoded.data());
+
+        const float max = ((1 << 23) - 1) / 4096.0f;
+        const float* values = &input[0].x;
+        for (size_t i = 0; i < decoded.size(); i++)
+        {
+            CHECK(within(decoded[i], values[i], 12, -2048.0f, max));
+            CHECK(decoded[i] == compression::fixed_point_Q12_12_to_float(compression::float_to_fixed_point_Q12_12(values[i])));
+        }
+    }
+
+    void test_q16_8()
+    {
+        const auto input = vectors(333, 2, 32768.0f, 8);
+        std::vector<WB_RES::Q16_8> fixed(input.size() * 3);
+        const float* values = &input[0].x;
+        for (size_t i = 0; i < fixed.size(); i++)
+            fixed[i] = compression::float_to_fixed_point_Q16_8(values[i]);
+
+        std::vector<float> decoded(fixed.size());
+        decoding::unpack_vec3_q16_8(reinterpret_cast<const uint8_t*>(fixed.data()), input.size(), decoded.data());
+        for (size_t i = 0; i < decoded.size(); i++)
+            CHECK(within(decoded[i], values[i], 8, -32768.0f, ((1 << 23) - 1) / 256.0f));
+    }
+
+    void test_q10_6()
+    {
+        const auto input = vectors(500, 3, 512.0f, 6);
+        std::vector<WB_RES::Vec3_Q10_6> fixed(input.size());
+        compression::float_to_fixed_point_Q10_6(wb::MakeArray(input.data(), input.size()), fixed.data());
+
+        std::vector<float> decoded(input.size() * 3);
+        decoding::unpack_vec3_q10_6(reinterpret_cast<const uint8_t*>(fixed.data()), input.size(), decoded.data());
+        const float* values = &input[0].x;
+        for (size_t i = 0; i < decoded.size(); i++)
+            CHECK(within(decoded[i], values[i], 6, -512.0f, 32767 / 64.0f));
+    }
+
+    /// Compact records, the fractional bits follow the range
+    void test_q16()
+    {
+        for (float range : { 2.0f, 8.0f, 16.0f, 2000.0f })
+        {
+            const uint8_t fractionBits = compression::fraction_bits_for_range<16>(range);
+            const auto input = vectors(257, 4, range, fractionBits);
+            std::vector<WB_RES::Vec3_Q16> fixed(input.size());
+            compression::float_to_fixed_point_Q16(wb::MakeArray(input.data(), input.size()), fractionBits, fixed.data());
+
+            std::vector<float> decoded(input.size() * 3);
+            decoding::unpack_vec3_q16(reinterpret_cast<const uint8_t*>(fixed.data()), input.size(), fractionBits,
+                decoded.data());
+            const float lsb = 1.0f / (1u << fractionBits);
+            const float* values = &input[0].x;
+            for (size_t i = 0; i < decoded.size(); i++)
+                CHECK(within(decoded[i], values[i], fractionBits, -32768 * lsb, 32767 * lsb));
+        }
+    }
+
+    /// Every stride-th value of the format, with the floats around it and halfway to the next one
+    std::vector<float> grid(uint8_t fractionBits, int32_t min, int32_t max, int32_t stride)
+    {
+        const float lsb = 1.0f / (1u << fractionBits);
+        std::vector<float> out;
+        for (int32_t k = min; k <= max; k += stride)
+        {
+            const float value = k * lsb;
+            out.push_back(value);
+            if (k > min)
+                out.push_back(std::nextafter(value, -1e9f));
+            if (k == max)
+                break; // Above the largest value can round out of the format
+            out.push_back(std::nextafter(value, 1e9f));
+            const float halfway = (k + 0.5f) * lsb;
+            out.push_back(halfway);
+            out.push_back(std::nextafter(halfway, -1e9f));
+            out.push_back(std::nextafter(halfway, 1e9f));
+            out.push_back((k + 0.25f) * lsb);
+        }
+        while (out.size() % 3 != 0)
+            out.push_back(0.0f);
+        return out;
+    }
+
+    /// The batch conversion of the firmware against the previous per-component conversion,
+    /// byte for byte within the range of the format
+    template<typename TVector, typename TConvert, typename TLegacy>
+    void compare_legacy(const char* name, const std::vector<float>& values, TConvert convert, TLegacy legacy)
+    {
+        const size_t count = values.size() / 3;
+        std::vector<TVector> fixed(count);
+        convert(wb::MakeArray(reinterpret_cast<const wb::FloatVector3D*>(values.data()), count), fixed.data());
+
+        const auto* components = &fixed[0].x;
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            const auto expected = legacy(values[i]);
+            if (!CHECK(std::memcmp(&components[i], &expected, sizeof(expected)) == 0))
+            {
+                std::printf("  %s: %.9g differs from round()\n", name, values[i]);
+                return;
+            }
+        }
+    }
+
+    void test_legacy()
+    {
+        const auto q12_12 = grid(12, -(1 << 23), (1 << 23) - 1, 7);
+        compare_legacy<WB_RES::Vec3_Q12_12>("Q12.12", q12_12,
+            [](const wb::Array<wb::FloatVector3D>& in, WB_RES::Vec3_Q12_12* out) {
+                compression::float_to_fixed_point_Q12_12(in, out);
+            },
+            legacy::float_to_fixed_point_Q12_12);
+
+        const auto q10_6 = grid(6, -(1 << 15), (1 << 15) - 1, 1);
+        compare_legacy<WB_RES::Vec3_Q10_6>("Q10.6", q10_6,
+            [](const wb::Array<wb::FloatVector3D>& in, WB_RES::Vec3_Q10_6* out) {
+                compression::float_to_fixed_point_Q10_6(in, out);
+            },
+            legacy::float_to_fixed_point_Q10_6);
+
+        const auto q16_8 = grid(8, -(1 << 23), (1 << 23) - 1, 7);
+        compare_legacy<WB_RES::Vec3_Q16_8>("Q16.8", q16_8,
+            [](const wb::Array<wb::FloatVector3D>& in, WB_RES::Vec3_Q16_8* out) {
+                WB_RES::Q16_8* components = &out[0].x;
+                for (size_t i = 0; i < in.size(); i++)
+                {
+                    components[3 * i] = compression::float_to_fixed_point_Q16_8(in[i].x);
+                    components[3 * i + 1] = compression::float_to_fixed_point_Q16_8(in[i].y);
+                    components[3 * i + 2] = compression::float_to_fixed_point_Q16_8(in[i].z);
+                }
+            },
+            legacy::float_to_fixed_point_Q16_8);
+    }
+
+    /// Every length, so the vector loop and the scalar tail both get each alignment
+    void test_unpack_q24()
+    {
+        Random random(5);
+        std::vector<uint8_t> bytes(3 * 64);
+        for (uint8_t& byte : bytes)
+            byte = static_cast<uint8_t>(random.next());
+
+        for (size_t count = 0; count <= 64; count++)
+        {
+            std::vector<float> out(count + 1, -1.0f);
+            decoding::unpack_q24<12>(bytes.data(), count, out.data());
+            for (size_t i = 0; i < count; i++)
+                CHECK(out[i] == decoding::q12_12_to_float(bytes.data() + i * decoding::Q24_BYTES));
+            CHECK(out[count] == -1.0f);
+        }
+    }
+} // namespace
+
+int main()
+{
+#if defined(__SSSE3__)
+    std::printf("fixed_point_test: SSSE3\n");
+#endif
+    test_q12_12();
+    test_q16_8();
+    test_q10_6();
+    test_q16();
+    test_unpack_q24();
+    test_legacy();
+    return test_result("fixed_point_test");
+}
@@ -0,0 +1,72 @@
+// Cost of the acc decimation cascade of SensorHub per sensor sample, with the
+// consumers of the firmware at their usual rates.
+//
+//   halfband_benchmark [rounds]
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include <vector>
+
+#include "Signals.hpp"
+#include "Timing.hpp"
+#include "internal/AccCascade.hpp"
+
+using namespace offline_meas::testing;
+
+namespace
+{
+    constexpr uint16_t SENSOR_RATE = 104;
+    constexpr size_t PER_NOTIFICATION = 8;
+
+    struct Consumer : sensor_hub::AccConsumer
+    {
+        void onAccData(const WB_RES::AccData& data) override
+        {
+            g_sink = g_sink + static_cast<uint32_t>(data.arrayAcc[data.arrayAcc.size() - 1].x);
+        }
+    };
+
+    /// Best of rounds, per sensor sample, with a consumer at each of the rates
+    double measure(const std::vector<wb::FloatVector3D>& acc, std::initializer_list<uint16_t> rates, size_t rounds)
+    {
+        Consumer consumers[sensor_hub::AccCascade::MAX_CONSUMERS];
+        const double best = best_of(rounds, [&] {
+            sensor_hub::AccCascade cascade;
+            size_t c = 0;
+            for (uint16_t rate : rates)
+                cascade.set_consumer(consumers[c++], rate, 0);
+            cascade.configure(SENSOR_RATE);
+
+            for (size_t i = 0; i + PER_NOTIFICATION <= acc.size(); i += PER_NOTIFICATION)
+            {
+                WB_RES::AccData data;
+                data.timestamp = static_cast<uint32_t>(i * 1000 / SENSOR_RATE);
+                data.arrayAcc = wb::MakeArray(&acc[i], PER_NOTIFICATION);
+                cascade.deliver(data);
+            }
+            });
+        return best / acc.size();
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    size_t rounds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20;
+    rounds = rounds > 0 ? rounds : 1;
+
+    Random random(1);
+    std::vector<wb::FloatVector3D> acc(65536);
+    for (auto& v : acc)
+    {
+        v.x = static_cast<float>(random.uniform(1 << 16)) / (1 << 14);
+        v.y = static_cast<float>(random.uniform(1 << 16)) / (1 << 14);
+        v.z = 9.8f + static_cast<float>(random.uniform(1 << 16)) / (1 << 14);
+    }
+
+    std::printf("Sensor at %u Hz, %zu samples per notification\n", SENSOR_RATE, PER_NOTIFICATION);
+    std::printf("  104 Hz only:         %6.1f %s\n", measure(acc, { 104 }, rounds), per_sample_unit());
+    std::printf("  52 Hz:               %6.1f %s\n", measure(acc, { 52 }, rounds), per_sample_unit());
+    std::printf("  13 Hz:               %6.1f %s\n", measure(acc, { 13 }, rounds), per_sample_unit());
+    std::printf("  52, 26 and 13 Hz:    %6.1f %s\n", measure(acc, { 52, 26, 13 }, rounds), per_sample_unit());
+    return 0;
+}
@@ -0,0 +1,189 @@
+// The acc decimation cascade of SensorHub: frequency response of the stages, a rate
+// switch without a gap, and the delay correction of the timestamps.
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "Check.hpp"
+#include "internal/AccCascade.hpp"
+
+using namespace offline_meas::testing;
+using sensor_hub::AccCascade;
+
+namespace
+{
+    constexpr uint16_t SENSOR_RATE = 104;
+    constexpr size_t PER_NOTIFICATION = 8;
+    constexpr uint32_t START = 10000; // ms, the first decimated samples are older
+    constexpr double PI = 3.14159265358979;
+
+    struct Sample
+    {
+        double timestamp; // ms
+        float x;
+    };
+
+    /// Keeps the samples it gets, with the timestamps at the rate it subscribed
+    struct Recorder : sensor_hub::AccConsumer
+    {
+        uint16_t sampleRate = 0;
+        std::vector<Sample> samples;
+
+        void onAccData(const WB_RES::AccData& data) override
+        {
+            for (size_t i = 0; i < data.arrayAcc.size(); i++)
+                samples.push_back({ data.timestamp + i * 1000.0 / sampleRate, data.arrayAcc[i].x });
+        }
+    };
+
+    /// Feeds the cascade notifications of the sensor, x from signal(sample index)
+    class Sensor
+    {
+        AccCascade& m_cascade;
+        size_t m_index = 0;
+
+    public:
+        explicit Sensor(AccCascade& cascade)
+            : m_cascade(cascade)
+        {
+        }
+
+        template<typename TSignal>
+        void run(size_t count, TSignal signal)
+        {
+            wb::FloatVector3D acc[PER_NOTIFICATION];
+            for (size_t n = 0; n < count; n += PER_NOTIFICATION)
+            {
+                for (size_t i = 0; i < PER_NOTIFICATION; i++)
+                    acc[i] = { signal(m_index + i), 0.0f, 9.8f };
+
+                WB_RES::AccData data;
+                data.timestamp = START + static_cast<uint32_t>(m_index * 1000 / SENSOR_RATE);
+                data.arrayAcc = wb::MakeArray(acc, PER_NOTIFICATION);
+                m_cascade.deliver(data);
+                m_index += PER_NOTIFICATION;
+            }
+        }
+    };
+
+    void subscribe(AccCascade& cascade, Recorder& recorder, uint16_t sampleRate)
+    {
+        recorder.sampleRate = sampleRate;
+        CHECK(cascade.set_consumer(recorder, sampleRate, 0));
+        cascade.configure(SENSOR_RATE);
+    }
+
+    /// Gain of the cascade at sampleRate for a sine of frequency (Hz) at the sensor rate
+    double gain(uint16_t sampleRate, double frequency)
+    {
+        AccCascade cascade;
+        Recorder recorder;
+        subscribe(cascade, recorder, sampleRate);
+
+        const float amplitude = 16.0f;
+        Sensor(cascade).run(SENSOR_RATE * 60, [=](size_t n) {
+            return amplitude * static_cast<float>(std::sin(2 * PI * frequency * n / SENSOR_RATE));
+            });
+
+        // Past the settling of the stages
+        double peak = 0;
+        for (size_t i = recorder.samples.size() / 4; i < recorder.samples.size(); i++)
+            peak = std::fmax(peak, std::fabs(recorder.samples[i].x));
+        return peak / amplitude;
+    }
+
+    double decibels(double gain)
+    {
+        return 20 * std::log10(gain);
+    }
+
+    /// Flat passband up to 0.3 times the output rate, at least 32 dB attenuation of
+    /// what would alias below a quarter of the output rate
+    void test_frequency_response(uint16_t sampleRate)
+    {
+        for (double f = 0.5; f <= 0.3 * sampleRate; f += 0.5)
+        {
+            const double db = decibels(gain(sampleRate, f));
+            if (!CHECK(std::fabs(db) <= 0.6))
+                std::printf("  %u Hz passband at %.1f Hz: %.2f dB\n", sampleRate, f, db);
+        }
+
+        // Above half of the output rate the cascade has to attenuate: what comes out
+        // of the last stage between 0.75 and 1 times the output rate aliases below
+        // a quarter of it. Earlier stages fold less of the band.
+        for (double f = 0.75 * sampleRate; f < SENSOR_RATE / 2.0; f += 0.5)
+        {
+            const double db = decibels(gain(sampleRate, f));
+            if (!CHECK(db <= -32.0))
+                std::printf("  %u Hz stopband at %.1f Hz: %.2f dB\n", sampleRate, f, db);
+        }
+    }
+
+    /// A consumer that switches from 52 to 13 Hz at the same sensor rate continues
+    /// after its last sample: no sample twice or out of order, and no gap.
+    void test_switch_without_gap()
+    {
+        AccCascade cascade;
+        Recorder recorder;
+        subscribe(cascade, recorder, 52);
+
+        Sensor sensor(cascade);
+        auto ramp = [](size_t n) { return static_cast<float>(n) / 100; };
+        sensor.run(SENSOR_RATE * 5, ramp);
+        const size_t before = recorder.samples.size();
+        CHECK(before > 0);
+
+        subscribe(cascade, recorder, 13);
+        sensor.run(SENSOR_RATE * 5, ramp);
+        CHECK(recorder.samples.size() > before + 13 * 4);
+
+        for (size_t i = 1; i < recorder.samples.size(); i++)
+        {
+            const double step = recorder.samples[i].timestamp - recorder.samples[i - 1].timestamp;
+            const double period = 1000.0 / (i < before ? 52 : 13);
+            // One sensor sample of rounding in the timestamps of the notifications
+            if (!CHECK(step > 0 && step <= period + 1000.0 / SENSOR_RATE))
+                std::printf("  sample %zu: %.1f ms after the previous one\n", i, step);
+        }
+    }
+
+    /// The timestamps are moved back by DELAY * (2^N - 1) sensor samples at stage N:
+    /// a ramp of the time comes out equal to the timestamps
+    void test_timestamp_delay(uint16_t sampleRate)
+    {
+        AccCascade cascade;
+        Recorder recorder;
+        subscribe(cascade, recorder, sampleRate);
+
+        const double slope = 0.01; // Per ms
+        Sensor(cascade).run(SENSOR_RATE * 20, [=](size_t n) {
+            return static_cast<float>(slope * (START + n * 1000.0 / SENSOR_RATE));
+            });
+
+        CHECK(recorder.samples.size() > 0);
+        size_t errors = 0;
+        for (const Sample& s : recorder.samples)
+        {
+            if (s.timestamp < START + 2000)
+                continue; // Priming of the stages
+            // Rounding of the timestamps to ms, and of the samples to the fixed point
+            if (std::fabs(s.x / slope - s.timestamp) > 2.0)
+                errors++;
+        }
+        if (!CHECK(errors == 0))
+            std::printf("  %u Hz: %zu samples off their timestamps\n", sampleRate, errors);
+    }
+} // namespace
+
+int main()
+{
+    test_frequency_response(52);
+    test_frequency_response(26);
+    test_frequency_response(13);
+    test_switch_without_gap();
+    test_timestamp_delay(104);
+    test_timestamp_delay(52);
+    test_timestamp_delay(26);
+    test_timestamp_delay(13);
+    return test_result("halfband_test");
+}
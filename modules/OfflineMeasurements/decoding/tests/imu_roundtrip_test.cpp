@@ -0,0 +1,117 @@
+// Round trip of the firmware IMU encoder (IMUCompression) through decode_imu_block
+#include <cmath>
+#include <cstdio>
+
+#include "Check.hpp"
+#include "Encoders.hpp"
+#include "Signals.hpp"
+#include "IMUDecoder.hpp"
+
+using namespace offline_meas::testing;
+namespace decoding = offline_meas::decoding;
+
+namespace
+{
+    using Compressor = IMUCompression<256>;
+
+    constexpr size_t NOTIFICATION_VECTORS = 8;
+
+    BlockList encode(Compressor& compressor, const std::vector<int32_t>& vectors)
+    {
+        BlockList sink;
+        const size_t count = vectors.size() / 3;
+        for (size_t i = 0; i < count; i += NOTIFICATION_VECTORS)
+            compressor.pack_continuous(vectors.data() + i * 3, WB_MIN(NOTIFICATION_VECTORS, count - i), sink);
+        compressor.dump_buffer(sink);
+        return sink;
+    }
+
+    struct Format
+    {
+        uint8_t valueBits;
+        uint8_t fractionBits;
+    };
+
+    void test_round_trip()
+    {
+        const Format formats[] = { { 24, 12 }, { 24, 8 }, { 16, 6 }, { 16, 11 }, { 12, 4 }, { 24, 0 } };
+        const IMUPredictor predictors[] = { IMUPredictor::FirstOrder, IMUPredictor::SecondOrder, IMUPredictor::Adaptive };
+
+        for (const Format& format : formats)
+            for (IMUPredictor predictor : predictors)
+                for (size_t blockSize : { 32, 96, 256 })
+                    for (uint32_t seed = 1; seed <= 3; seed++)
+                        for (int32_t noise : { 0, 16, 1 << (format.valueBits - 2) })
+                        {
+                            Compressor compressor;
+                            CHECK(compressor.set_block_size(blockSize));
+                            CHECK(compressor.set_format(format.valueBits, format.fractionBits));
+                            compressor.set_predictor(predictor);
+
+                            const size_t vectors = seed == 1 ? 1000 : seed * 7;
+                            const std::vector<int32_t> input = imu_signal(vectors, seed, format.valueBits, noise);
+                            const BlockList sink = encode(compressor, input);
+
+                            std::vector<int32_t> decoded(input.size() + 3);
+                            std::vector<float> values(input.size() + 3);
+                            size_t total = 0;
+                            for (const Block& block : sink.blocks)
+                            {
+                                decoding::IMUBlockInfo info = {};
+                                CHECK(decoding::read_imu_block_info(block.data.data(), block.data.size(), info));
+                                CHECK(info.valueBits == format.valueBits && info.fractionBits == format.fractionBits);
+
+                                const size_t room = decoded.size() / 3 - total;
+                                const size_t count = decoding::decode_imu_block(block.data.data(), block.data.size(),
+                                    decoded.data() + total * 3, room);
+                                CHECK(count == info.count);
+                                CHECK(decoding::decode_imu_block(block.data.data(), block.data.size(),
+                                          values.data() + total * 3, room) == count);
+                                total += count;
+                            }
+
+                            decoded.resize(total * 3);
+                            if (!CHECK(decoded == input))
+                            {
+                                std::printf("  format %d/%d, predictor %d, %zu B, seed %u, noise %d\n", format.valueBits,
+                                    format.fractionBits, int(predictor), blockSize, seed, noise);
+                                continue;
+                            }
+
+                            const float scale = 1.0f / (1u << format.fractionBits);
+                            for (size_t i = 0; i < input.size(); i++)
+                                CHECK(values[i] == input[i] * scale);
+                        }
+    }
+
+    /// Adaptive blocks record the predictor they were coded with
+    void test_adaptive_predictor()
+    {
+        Compressor compressor;
+        compressor.set_block_size(64);
+        compressor.set_format(24, 12);
+        compressor.set_predictor(IMUPredictor::Adaptive);
+
+        std::vector<int32_t> input;
+        for (size_t i = 0; i < 2000; i++) // Smooth, second order prediction wins after the first block
+            for (size_t axis = 0; axis < 3; axis++)
+                input.push_back(static_cast<int32_t>(4000 * std::sin(0.003 * i + axis)));
+
+        const BlockList sink = encode(compressor, input);
+        size_t secondOrder = 0;
+        for (const Block& block : sink.blocks)
+        {
+            decoding::IMUBlockInfo info = {};
+            CHECK(decoding::read_imu_block_info(block.data.data(), block.data.size(), info));
+            secondOrder += info.predictor == decoding::IMUPredictor::SecondOrder;
+        }
+        CHECK(secondOrder + 1 >= sink.blocks.size());
+    }
+} // namespace
+
+int main()
+{
+    test_round_trip();
+    test_adaptive_predictor();
+    return test_result("imu_roundtrip_test");
+}
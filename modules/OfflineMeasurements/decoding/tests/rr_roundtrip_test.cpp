@@ -0,0 +1,81 @@
+// Round trip of the RR-interval encoders: 12-bit chunks (BitPack) through unpack_rr_chunks
+// and compressed blocks (RRCompression) through decode_rr_block
+#include <cstdio>
+
+#include "Check.hpp"
+#include "Encoders.hpp"
+#include "Signals.hpp"
+#include "RRDecoder.hpp"
+
+using namespace offline_meas::testing;
+namespace decoding = offline_meas::decoding;
+
+namespace
+{
+    void test_chunks()
+    {
+        using Packer = offline_meas::compression::BitPack<12, decoding::RR_CHUNK_VALUES>;
+        static_assert(Packer::BYTES == decoding::RR_CHUNK_BYTES, "Chunk layouts differ");
+
+        for (uint32_t seed = 1; seed <= 5; seed++)
+        {
+            std::vector<uint16_t> input = rr_signal(800, seed);
+            for (uint16_t& value : input)
+                value &= 0x0FFF;
+            input[0] = 0;
+            input[1] = 0x0FFF;
+
+            std::vector<uint8_t> chunks(input.size() / decoding::RR_CHUNK_VALUES * decoding::RR_CHUNK_BYTES);
+            for (size_t i = 0; i < chunks.size() / decoding::RR_CHUNK_BYTES; i++)
+                Packer::pack(input.data() + i * decoding::RR_CHUNK_VALUES, chunks.data() + i * decoding::RR_CHUNK_BYTES);
+
+            std::vector<uint16_t> decoded(input.size());
+            CHECK(decoding::unpack_rr_chunks(chunks.data(), chunks.size() / decoding::RR_CHUNK_BYTES, decoded.data())
+                == input.size());
+            CHECK(decoded == input);
+        }
+    }
+
+    template<size_t BlockSize>
+    void test_compressed()
+    {
+        for (uint32_t seed = 1; seed <= 5; seed++)
+            for (size_t length : { 1, 2, 7, 100, 3000 })
+            {
+                std::vector<uint16_t> input = rr_signal(length, seed);
+                if (seed == 5 && length > 2) // Largest jumps escape the Rice code
+                {
+                    input[1] = 0xFFFF;
+                    input[2] = 0;
+                }
+
+                RRCompression<BlockSize> compressor;
+                BlockList sink;
+                for (size_t i = 0; i < input.size(); i += 3) // A few intervals per HR notification
+                    compressor.pack_continuous(input.data() + i, WB_MIN(size_t(3), input.size() - i), sink);
+                compressor.dump_buffer(sink);
+
+                std::vector<uint16_t> decoded(input.size() + 1);
+                size_t total = 0;
+                for (const Block& block : sink.blocks)
+                {
+                    CHECK(block.data.size() == BlockSize);
+                    const size_t count = decoding::decode_rr_block(block.data.data(), block.data.size(),
+                        decoded.data() + total, decoded.size() - total);
+                    CHECK(count == decoding::rr_block_count(block.data.data(), block.data.size()));
+                    total += count;
+                }
+                decoded.resize(total);
+                if (!CHECK(decoded == input))
+                    std::printf("  %zu B blocks, seed %u, %zu intervals\n", BlockSize, seed, length);
+            }
+    }
+} // namespace
+
+int main()
+{
+    test_chunks();
+    test_compressed<32>();
+    test_compressed<16>();
+    return test_result("rr_roundtrip_test");
+}
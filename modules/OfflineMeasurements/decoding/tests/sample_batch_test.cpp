@@ -0,0 +1,154 @@
+// SampleBatch: records of power-of-two lengths, written when full, on gaps, at the
+// latency threshold with the next notification or with expire(), and with flush()
+#include <cstdio>
+#include <vector>
+
+#include "Check.hpp"
+#include "utils/SampleBatch.hpp"
+
+using namespace offline_meas::testing;
+
+namespace
+{
+    using Batch = offline_meas::SampleBatch<64>;
+    constexpr uint16_t SAMPLE_RATE = 100;
+    constexpr uint32_t LATENCY = 1000;
+
+    struct Record
+    {
+        std::vector<int16_t> samples;
+        uint32_t timestamp;
+    };
+
+    struct Records
+    {
+        std::vector<Record> records;
+
+        void operator()(const uint8_t* samples, size_t count, uint32_t timestamp)
+        {
+            const int16_t* values = reinterpret_cast<const int16_t*>(samples);
+            records.push_back({ std::vector<int16_t>(values, values + count), timestamp });
+        }
+
+        size_t samples() const
+        {
+            size_t total = 0;
+            for (const Record& record : records)
+                total += record.samples.size();
+            return total;
+        }
+    };
+
+    /// Notifications of 4 samples at 100 Hz, numbered from first
+    void append(Batch& batch, Records& sink, int16_t first, size_t notifications, uint32_t timestamp)
+    {
+        for (size_t n = 0; n < notifications; n++)
+        {
+            const int16_t samples[4] = { static_cast<int16_t>(first + 4 * n), static_cast<int16_t>(first + 4 * n + 1),
+                static_cast<int16_t>(first + 4 * n + 2), static_cast<int16_t>(first + 4 * n + 3) };
+            batch.append(samples, 4, timestamp + static_cast<uint32_t>(n * 40), SAMPLE_RATE, sink);
+        }
+    }
+
+    bool consecutive(const Records& sink, int16_t first, uint32_t timestamp)
+    {
+        int16_t expected = first;
+        for (const Record& record : sink.records)
+        {
+            if (!CHECK(record.timestamp == timestamp + static_cast<uint32_t>((expected - first) * 10)))
+                return false;
+            for (int16_t sample : record.samples)
+                if (!CHECK(sample == expected++))
+                    return false;
+        }
+        return true;
+    }
+
+    void test_full()
+    {
+        Batch batch;
+        batch.configure(sizeof(int16_t), 64, LATENCY);
+        Records sink;
+        append(batch, sink, 0, 9, 5000);
+        CHECK(sink.records.size() == 1 && sink.records[0].samples.size() == 32);
+        CHECK(batch.size() == 4);
+        consecutive(sink, 0, 5000);
+    }
+
+    void test_expire()
+    {
+        Batch batch;
+        batch.configure(sizeof(int16_t), 64, LATENCY);
+        Records sink;
+
+        batch.expire(100000, sink); // Empty batch
+        CHECK(sink.records.empty());
+
+        // 12 samples, then the notifications stop
+        const uint32_t start = UINT32_MAX - 500; // Wraps around before the latency threshold
+        append(batch, sink, 0, 3, start);
+        batch.expire(start + LATENCY - 1, sink);
+        CHECK(sink.records.empty() && batch.size() == 12);
+
+        batch.expire(start + LATENCY, sink);
+        CHECK(batch.size() == 0);
+        if (CHECK(sink.records.size() == 2))
+            CHECK(sink.records[0].samples.size() == 8 && sink.records[1].samples.size() == 4);
+        consecutive(sink, 0, start);
+
+        // Nothing is left to expire
+        batch.expire(start + 5 * LATENCY, sink);
+        CHECK(sink.samples() == 12);
+    }
+
+    void test_notification_latency()
+    {
+        Batch batch;
+        batch.configure(sizeof(int16_t), 64, 100);
+        Records sink;
+        append(batch, sink, 0, 3, 0); // The third notification is 80 ms after the first sample
+        CHECK(sink.records.empty());
+        append(batch, sink, 12, 1, 120);
+        CHECK(batch.size() == 0 && sink.samples() == 16);
+        consecutive(sink, 0, 0);
+    }
+
+    void test_flush_and_disabled_latency()
+    {
+        Batch batch;
+        batch.configure(sizeof(int16_t), 64, 0);
+        Records sink;
+        append(batch, sink, 0, 7, 0);
+        batch.expire(UINT32_MAX / 2, sink);
+        CHECK(sink.records.size() == 0 && batch.size() == 28);
+
+        batch.flush(sink);
+        CHECK(batch.size() == 0);
+        if (CHECK(sink.records.size() == 3))
+            CHECK(sink.records[0].samples.size() == 16 && sink.records[1].samples.size() == 8 &&
+                sink.records[2].samples.size() == 4);
+        consecutive(sink, 0, 0);
+    }
+
+    void test_gap()
+    {
+        Batch batch;
+        batch.configure(sizeof(int16_t), 64, LATENCY);
+        Records sink;
+        append(batch, sink, 0, 2, 0);
+        append(batch, sink, 8, 1, 200); // 120 ms late
+        if (CHECK(sink.records.size() == 1))
+            CHECK(sink.records[0].samples.size() == 8 && sink.records[0].timestamp == 0);
+        CHECK(batch.size() == 4);
+    }
+} // namespace
+
+int main()
+{
+    test_full();
+    test_expire();
+    test_notification_latency();
+    test_flush_and_disabled_latency();
+    test_gap();
+    return test_result("sample_batch_test");
+}
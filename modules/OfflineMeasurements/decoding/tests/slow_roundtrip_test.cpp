@@ -0,0 +1,141 @@
+// Round trip of the slow time-series encoder (SlowCompression, HR, temperature and activity)
+// through decode_slow_block, values and timestamps
+#include <cstdio>
+
+#include "Check.hpp"
+#include "Encoders.hpp"
+#include "Signals.hpp"
+#include "SlowDecoder.hpp"
+
+using namespace offline_meas::testing;
+namespace decoding = offline_meas::decoding;
+
+namespace
+{
+    using Compressor = SlowCompression<32>;
+
+    struct Reading
+    {
+        uint32_t timestamp;
+        int32_t value;
+    };
+
+    /// Readings about every interval ms with jitter, occasional pauses and value jumps
+    std::vector<Reading> readings(size_t count, uint32_t seed, uint8_t valueBits, bool isSigned, uint32_t interval)
+    {
+        Random random(seed);
+        const int32_t max = isSigned ? (1 << (valueBits - 1)) - 1 : (1 << valueBits) - 1;
+        const int32_t min = isSigned ? -max - 1 : 0;
+
+        std::vector<Reading> out(count);
+        uint32_t timestamp = 0xFFFF0000u + seed; // Wraps around during the test
+        int32_t value = (max + min) / 2;
+        for (size_t i = 0; i < count; i++)
+        {
+            timestamp += interval + random.uniform(interval / 20);
+            if (random.next() % 40 == 0)
+                timestamp += random.next() % 100000; // Pause, up to the 32-bit timestamp code
+            value += random.next() % 8 == 0 ? random.uniform(max - min) : random.uniform(2);
+            value = value > max ? max : value < min ? min : value;
+            out[i] = { timestamp, value };
+        }
+        return out;
+    }
+
+    struct Format
+    {
+        uint8_t valueBits;
+        bool isSigned;
+        uint32_t interval;
+    };
+
+    void test_round_trip()
+    {
+        const Format formats[] = {
+            { 8, false, 1000 },  // HR
+            { 16, true, 1000 },  // Temperature
+            { 12, false, 1000 }, // Activity
+            { 1, false, 10 },
+            { 16, false, 30000 },
+        };
+
+        for (const Format& format : formats)
+            for (uint32_t maxAge : { 0u, 5000u, 900000u })
+                for (uint32_t seed = 1; seed <= 4; seed++)
+                    for (size_t length : { 1, 2, 3, 500 })
+                    {
+                        const std::vector<Reading> input = readings(length, seed, format.valueBits, format.isSigned,
+                            format.interval);
+
+                        Compressor compressor;
+                        CHECK(compressor.set_format(format.valueBits, format.isSigned));
+                        compressor.set_max_age(maxAge);
+                        BlockList sink;
+                        for (const Reading& reading : input)
+                            compressor.pack(reading.value, reading.timestamp, sink);
+                        compressor.dump_buffer(sink);
+
+                        std::vector<decoding::SlowRecord> decoded(input.size() + 1);
+                        size_t total = 0;
+                        for (const Block& block : sink.blocks)
+                        {
+                            CHECK(block.data.size() == 8 || block.data.size() == 16 || block.data.size() == 32);
+                            const size_t count = decoding::decode_slow_block(block.data.data(), block.data.size(),
+                                block.timestamp, decoded.data() + total, decoded.size() - total);
+                            CHECK(count == block.data[0]);
+                            if (maxAge > 0 && count > 0)
+                                CHECK(decoded[total + count - 1].timestamp - block.timestamp < maxAge);
+                            total += count;
+                        }
+
+                        bool equal = CHECK(total == input.size());
+                        for (size_t i = 0; equal && i < total; i++)
+                            equal = CHECK(decoded[i].timestamp == input[i].timestamp && decoded[i].value == input[i].value);
+                        if (!equal)
+                            std::printf("  %d bits%s, max age %u, seed %u, %zu readings\n", format.valueBits,
+                                format.isSigned ? " signed" : "", maxAge, seed, length);
+                    }
+    }
+
+    /// A block completes when expire() is called at its max age, also without further readings
+    void test_expire()
+    {
+        Compressor compressor;
+        CHECK(compressor.set_format(8, false));
+        compressor.set_max_age(5000);
+        BlockList sink;
+
+        compressor.expire(1000, sink); // Empty block
+        compressor.pack(60, 1000, sink);
+        compressor.pack(61, 2000, sink);
+        compressor.expire(5999, sink);
+        CHECK(sink.blocks.empty() && compressor.block_samples() == 2);
+
+        compressor.expire(6000, sink);
+        CHECK(sink.blocks.size() == 1 && compressor.block_samples() == 0);
+        compressor.expire(20000, sink);
+        CHECK(sink.blocks.size() == 1);
+
+        decoding::SlowRecord decoded[2];
+        if (CHECK(sink.blocks.size() == 1))
+        {
+            const Block& block = sink.blocks[0];
+            CHECK(decoding::decode_slow_block(block.data.data(), block.data.size(), block.timestamp, decoded, 2) == 2);
+            CHECK(decoded[0].timestamp == 1000 && decoded[0].value == 60);
+            CHECK(decoded[1].timestamp == 2000 && decoded[1].value == 61);
+        }
+
+        // Without a max age only full blocks and dump_buffer() complete them
+        compressor.set_max_age(0);
+        compressor.pack(62, 30000, sink);
+        compressor.expire(UINT32_MAX, sink);
+        CHECK(sink.blocks.size() == 1 && compressor.block_samples() == 1);
+    }
+} // namespace
+
+int main()
+{
+    test_round_trip();
+    test_expire();
+    return test_result("slow_roundtrip_test");
+}
@@ -0,0 +1,16 @@
+#pragma once
+// Stand-in for the generated resources of the accelerometer, with only the
+// notification type the SensorHub cascade uses. Host tests only.
+#include "modules-resources/resources.h"
+
+namespace whiteboard
+{
+    namespace resources
+    {
+        struct AccData
+        {
+            uint32_t timestamp;
+            Array<FloatVector3D> arrayAcc;
+        };
+    } // namespace resources
+} // namespace whiteboard
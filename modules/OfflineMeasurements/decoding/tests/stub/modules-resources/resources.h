@@ -0,0 +1,104 @@
+#pragma once
+// Stand-in for the Whiteboard resources generated by the Movesense build, with only
+// what the encoder headers use. Host tests only.
+#include <cstddef>
+#include <cstdint>
+
+namespace whiteboard
+{
+    /// Read-only view of count elements, like the Whiteboard array of the generated types
+    template<typename T>
+    class Array
+    {
+        const T* m_data;
+        size_t m_size;
+
+    public:
+        Array(const T* data = nullptr, size_t size = 0)
+            : m_data(data)
+            , m_size(size)
+        {
+        }
+
+        size_t size() const
+        {
+            return m_size;
+        }
+
+        const T& operator[](size_t index) const
+        {
+            return m_data[index];
+        }
+
+        const T* begin() const
+        {
+            return m_data;
+        }
+
+        const T* end() const
+        {
+            return m_data + m_size;
+        }
+    };
+
+    template<typename T>
+    inline Array<T> MakeArray(const T* data, size_t size)
+    {
+        return Array<T>(data, size);
+    }
+
+    struct FloatVector3D
+    {
+        float x, y, z;
+    };
+
+    namespace resources
+    {
+#pragma pack(push, 1)
+        struct Q12_12
+        {
+            uint8_t b0, b1;
+            int8_t b2;
+        };
+
+        struct Q16_8
+        {
+            uint8_t b0, b1;
+            int8_t b2;
+        };
+
+        struct Q10_6
+        {
+            uint8_t b0;
+            int8_t b1;
+        };
+
+        struct Vec3_Q12_12
+        {
+            Q12_12 x, y, z;
+        };
+
+        struct Vec3_Q16_8
+        {
+            Q16_8 x, y, z;
+        };
+
+        struct Vec3_Q10_6
+        {
+            Q10_6 x, y, z;
+        };
+
+        struct Vec3_Q16
+        {
+            int16_t x, y, z;
+        };
+#pragma pack(pop)
+    } // namespace resources
+} // namespace whiteboard
+
+namespace wb = whiteboard;
+
+#define WB_RES whiteboard::resources
+
+#define WB_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define WB_MAX(a, b) ((a) > (b) ? (a) : (b))
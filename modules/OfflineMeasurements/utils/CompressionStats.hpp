@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace offline_meas
+{
+    /// Counters of a compressed channel since its subscription
+    struct CompressionStats
+    {
+        uint32_t samples = 0;     // Samples passed to the compressor
+        uint32_t bytes = 0;       // Bytes of the emitted blocks
+        uint32_t blocks = 0;      // Emitted blocks
+        uint32_t gapBlocks = 0;   // Blocks emitted early because of a gap in the timestamps
+        uint32_t maxResidual = 0; // Largest residual magnitude reported by the compressor
+
+        void reset()
+        {
+            *this = {};
+        }
+
+        void add_block(size_t size)
+        {
+            blocks++;
+            bytes += size;
+        }
+
+        void add_residual(uint32_t residual)
+        {
+            if (residual > maxResidual)
+                maxResidual = residual;
+        }
+
+        float bits_per_sample() const
+        {
+            return samples > 0 ? bytes * 8.0f / samples : 0.0f;
+        }
+    };
+} // namespace offline_meas
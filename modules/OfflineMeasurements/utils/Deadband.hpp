@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+
+namespace offline_meas
+{
+    /// Change detection for slow channels (HR, temperature, activity).
+    ///
+    /// A reading is recorded when
+    /// - it is the first one since reset, or
+    /// - the heartbeat interval has passed since the last recorded reading, or
+    /// - the minimum interval has passed and the value differs from the last
+    ///   recorded value by at least the hysteresis.
+    ///
+    /// Hysteresis 0 records every reading allowed by the minimum interval,
+    /// heartbeat 0 disables the forced records. Times are in milliseconds.
+    class Deadband
+    {
+    private:
+        int32_t m_last;
+        uint32_t m_lastTime;
+        bool m_hasValue;
+
+        uint32_t m_hysteresis;
+        uint32_t m_minInterval;
+        uint32_t m_heartbeat;
+
+    public:
+        Deadband(uint32_t hysteresis = 1, uint32_t minInterval = 0, uint32_t heartbeat = 0)
+            : m_hysteresis(hysteresis)
+            , m_minInterval(minInterval)
+            , m_heartbeat(heartbeat)
+        {
+            reset();
+        }
+
+        void configure(uint32_t hysteresis, uint32_t minInterval, uint32_t heartbeat)
+        {
+            m_hysteresis = hysteresis;
+            m_minInterval = minInterval;
+            m_heartbeat = heartbeat;
+        }
+
+        void reset()
+        {
+            m_last = 0;
+            m_lastTime = 0;
+            m_hasValue = false;
+        }
+
+        /// Returns true if the reading should be recorded, and takes it as the last recorded one
+        bool update(int32_t value, uint32_t timestamp)
+        {
+            bool record = !m_hasValue;
+            if (!record)
+            {
+                const uint32_t elapsed = timestamp - m_lastTime;
+                const uint32_t change = value >= m_last ? value - m_last : m_last - value;
+
+                if (m_heartbeat > 0 && elapsed >= m_heartbeat)
+                    record = true;
+                else if (elapsed >= m_minInterval && change >= m_hysteresis)
+                    record = true;
+            }
+
+            if (record)
+            {
+                m_last = value;
+                m_lastTime = timestamp;
+                m_hasValue = true;
+            }
+            return record;
+        }
+    };
+} // namespace offline_meas
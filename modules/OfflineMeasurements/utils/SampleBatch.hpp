@@ -0,0 +1,155 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace offline_meas
+{
+    /// Staging buffer that joins the samples of consecutive notifications of a
+    /// fixed-rate channel into larger records.
+    ///
+    /// Samples are opaque values of a fixed size. A batch is written out when
+    /// - it holds the maximum number of samples, the largest power of two that
+    ///   fits in the byte threshold, or
+    /// - the latency threshold has passed since its first sample, checked with
+    ///   each notification and with expire(), or
+    /// - the next samples do not continue it (gap or sample rate change).
+    /// Partial batches are written in power-of-two pieces, so records keep the
+    /// array lengths 1, 2, 4, ... of the data logger configuration.
+    ///
+    /// Written records are passed to a sink, any callable with signature
+    /// void(const uint8_t* samples, size_t count, uint32_t timestamp).
+    /// Byte threshold 0 disables batching, and samples are passed to the sink as they come.
+    template<size_t Capacity>
+    class SampleBatch
+    {
+    private:
+        alignas(4) uint8_t m_buffer[Capacity];
+        size_t m_sampleSize;
+        size_t m_maxSamples;
+        size_t m_count;
+        uint32_t m_maxLatency;
+        uint32_t m_timestamp;
+        uint16_t m_sampleRate;
+
+        uint32_t sample_offset(size_t index, uint16_t sampleRate) const
+        {
+            return static_cast<uint32_t>((uint64_t)index * 1000 / sampleRate);
+        }
+
+        bool continues(uint32_t timestamp, size_t count, uint16_t sampleRate) const
+        {
+            if (sampleRate != m_sampleRate || sampleRate == 0)
+                return false;
+
+            const int32_t diff = timestamp - (m_timestamp + sample_offset(m_count, sampleRate));
+            const int32_t maxDiff = (count * 1000 / 2) / sampleRate;
+            return diff <= maxDiff && diff >= -maxDiff;
+        }
+
+    public:
+        SampleBatch()
+            : m_sampleSize(1)
+            , m_maxSamples(0)
+            , m_maxLatency(0)
+        {
+            reset();
+        }
+
+        /// Select the sample size and the thresholds (bytes, ms), drops the buffered samples
+        void configure(size_t sampleSize, size_t maxBytes, uint32_t maxLatency)
+        {
+            const size_t bytes = maxBytes < Capacity ? maxBytes : Capacity;
+            size_t maxSamples = 1;
+            while (maxSamples * 2 * sampleSize <= bytes)
+                maxSamples *= 2;
+
+            m_sampleSize = sampleSize;
+            m_maxSamples = maxSamples > 1 ? maxSamples : 0; // Single samples gain nothing
+            m_maxLatency = maxLatency;
+            reset();
+        }
+
+        void reset()
+        {
+            m_count = 0;
+            m_timestamp = 0;
+            m_sampleRate = 0;
+        }
+
+        bool enabled() const
+        {
+            return m_maxSamples > 0;
+        }
+
+        /// Number of buffered samples
+        size_t size() const
+        {
+            return m_count;
+        }
+
+        /// Add count samples of the configured size, timestamp is the one of the first sample
+        template<typename TSink>
+        void append(const void* samples, size_t count, uint32_t timestamp, uint16_t sampleRate, TSink&& sink)
+        {
+            const uint8_t* in = static_cast<const uint8_t*>(samples);
+            if (!enabled())
+            {
+                sink(in, count, timestamp);
+                return;
+            }
+
+            if (m_count > 0 && !continues(timestamp, count, sampleRate))
+                flush(sink);
+
+            size_t offset = 0;
+            while (offset < count)
+            {
+                if (m_count == 0)
+                {
+                    m_timestamp = timestamp + sample_offset(offset, sampleRate);
+                    m_sampleRate = sampleRate;
+                }
+
+                size_t n = count - offset;
+                if (n > m_maxSamples - m_count)
+                    n = m_maxSamples - m_count;
+
+                memcpy(m_buffer + m_count * m_sampleSize, in + offset * m_sampleSize, n * m_sampleSize);
+                m_count += n;
+                offset += n;
+
+                if (m_count == m_maxSamples)
+                    flush(sink);
+            }
+
+            expire(timestamp, sink);
+        }
+
+        /// Write out the buffered samples if the first one is the latency threshold or more before now (ms).
+        /// Called from a timer, so the samples also get out when the notifications stop.
+        template<typename TSink>
+        void expire(uint32_t now, TSink&& sink)
+        {
+            if (m_count > 0 && m_maxLatency > 0 && now - m_timestamp >= m_maxLatency)
+                flush(sink);
+        }
+
+        /// Write out the buffered samples
+        template<typename TSink>
+        void flush(TSink&& sink)
+        {
+            size_t done = 0;
+            while (done < m_count)
+            {
+                size_t piece = 1;
+                while (piece * 2 <= m_count - done)
+                    piece *= 2;
+
+                sink(m_buffer + done * m_sampleSize, piece, m_timestamp + sample_offset(done, m_sampleRate));
+                done += piece;
+            }
+            m_count = 0;
+        }
+    };
+} // namespace offline_meas
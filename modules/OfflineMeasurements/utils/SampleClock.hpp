@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace offline_meas
+{
+    /// Sample counter of a fixed-rate channel recorded without timestamps.
+    ///
+    /// Samples are numbered from 0 since reset. A sync record, the timestamp of
+    /// a sample index, is needed
+    /// - for the first samples since reset or resync(), or
+    /// - when the sample rate changes, or
+    /// - when the timestamp of the samples is more than half of their duration
+    ///   off from the one implied by the last sync (gap or drift), or
+    /// - when the sync interval has passed since the last sync.
+    ///
+    /// Sync interval 0 disables the last case. Times are in milliseconds.
+    class SampleClock
+    {
+    private:
+        uint32_t m_samples;
+        uint32_t m_index;
+        uint32_t m_syncTimestamp;
+        uint32_t m_syncIndex;
+        uint16_t m_sampleRate;
+        bool m_synced;
+
+        uint32_t m_syncInterval;
+
+    public:
+        SampleClock(uint32_t syncInterval = 0)
+            : m_syncInterval(syncInterval)
+        {
+            reset();
+        }
+
+        void configure(uint32_t syncInterval)
+        {
+            m_syncInterval = syncInterval;
+        }
+
+        void reset()
+        {
+            m_samples = 0;
+            m_index = 0;
+            m_syncTimestamp = 0;
+            m_syncIndex = 0;
+            m_sampleRate = 0;
+            m_synced = false;
+        }
+
+        /// Request a sync record with the next samples, keeping the numbering
+        void resync()
+        {
+            m_synced = false;
+        }
+
+        /// Index of the first sample of the last update
+        uint32_t sample_index() const
+        {
+            return m_index;
+        }
+
+        /// Count samples, timestamp is the one of the first sample.
+        /// Returns true if a sync record with sample_index() and timestamp should precede them.
+        bool update(uint32_t timestamp, size_t count, uint16_t sampleRate)
+        {
+            bool sync = !m_synced || sampleRate == 0 || sampleRate != m_sampleRate;
+            if (!sync)
+            {
+                const uint32_t expected = m_syncTimestamp +
+                    static_cast<uint32_t>((uint64_t)(m_samples - m_syncIndex) * 1000 / sampleRate);
+                const int32_t diff = timestamp - expected;
+                const int32_t maxDiff = (count * 1000 / 2) / sampleRate;
+
+                if (diff > maxDiff || diff < -maxDiff)
+                    sync = true;
+                else if (m_syncInterval > 0 && timestamp - m_syncTimestamp >= m_syncInterval)
+                    sync = true;
+            }
+
+            m_index = m_samples;
+            if (sync)
+            {
+                m_syncTimestamp = timestamp;
+                m_syncIndex = m_samples;
+                m_sampleRate = sampleRate;
+                m_synced = true;
+            }
+            m_samples += count;
+            return sync;
+        }
+    };
+} // namespace offline_meas
@@ -0,0 +1,217 @@
+#include "SensorHub.hpp"
+
+#include "common/core/dbgassert.h"
+#include "DebugLogger.hpp"
+
+const char* const SensorHub::LAUNCHABLE_NAME = "SensorHub";
+
+SensorHub* SensorHub::s_instance = nullptr;
+
+SensorHub::SensorHub()
+    : ResourceClient(WBDEBUG_NAME(__FUNCTION__), WB_EXEC_CTX_ENCODING)
+    , LaunchableModule(LAUNCHABLE_NAME, WB_EXEC_CTX_ENCODING)
+    , m_accSampleRate(0)
+    , m_accBaseRate(0)
+    , m_accRange(0)
+    , m_accOwnRange(0)
+{
+    ASSERT(s_instance == nullptr);
+    s_instance = this;
+}
+
+SensorHub::~SensorHub()
+{
+    s_instance = nullptr;
+}
+
+SensorHub* SensorHub::instance()
+{
+    return s_instance;
+}
+
+bool SensorHub::initModule()
+{
+    mModuleState = WB_RES::ModuleStateValues::INITIALIZED;
+    return true;
+}
+
+void SensorHub::deinitModule()
+{
+    mModuleState = WB_RES::ModuleStateValues::UNINITIALIZED;
+}
+
+bool SensorHub::startModule()
+{
+    mModuleState = WB_RES::ModuleStateValues::STARTED;
+    return true;
+}
+
+void SensorHub::stopModule()
+{
+    mModuleState = WB_RES::ModuleStateValues::STOPPED;
+}
+
+bool SensorHub::subscribeAcc(sensor_hub::AccConsumer& consumer, uint16_t sampleRate, uint8_t gRange)
+{
+    if (sampleRate == 0)
+        return false;
+
+    if (!m_accCascade.set_consumer(consumer, sampleRate, gRange))
+    {
+        DebugLogger::error("%s: No free acc consumer slots", LAUNCHABLE_NAME);
+        return false;
+    }
+
+    updateAccRange();
+    updateAccSubscription();
+    return true;
+}
+
+void SensorHub::unsubscribeAcc(sensor_hub::AccConsumer& consumer)
+{
+    m_accCascade.remove_consumer(consumer);
+    updateAccRange();
+    updateAccSubscription();
+}
+
+void SensorHub::setAccBaseRate(uint16_t sampleRate)
+{
+    m_accBaseRate = sampleRate;
+    updateAccSubscription();
+}
+
+void SensorHub::updateAccSubscription()
+{
+    uint16_t requiredSampleRate = m_accCascade.required_rate();
+    if (requiredSampleRate > 0 && m_accBaseRate > requiredSampleRate)
+        requiredSampleRate = m_accBaseRate;
+
+    if (requiredSampleRate != m_accSampleRate)
+        resubscribeAcc(requiredSampleRate);
+
+    m_accCascade.configure(m_accSampleRate);
+}
+
+void SensorHub::resubscribeAcc(uint16_t requiredSampleRate)
+{
+    DebugLogger::info("%s: Changing acc samplerate %u -> %u",
+        LAUNCHABLE_NAME, m_accSampleRate, requiredSampleRate);
+
+    if (m_accSampleRate > 0)
+    {
+        asyncUnsubscribe(
+            WB_RES::LOCAL::MEAS_ACC_SAMPLERATE(), AsyncRequestOptions::Empty,
+            m_accSampleRate);
+    }
+
+    if (requiredSampleRate > 0)
+    {
+        asyncSubscribe(
+            WB_RES::LOCAL::MEAS_ACC_SAMPLERATE(), AsyncRequestOptions::Empty,
+            requiredSampleRate);
+    }
+
+    m_accSampleRate = requiredSampleRate;
+}
+
+void SensorHub::updateAccRange()
+{
+    const uint8_t requiredRange = m_accCascade.required_range();
+
+    if (requiredRange == m_accRange)
+        return;
+
+    // Read the range of the sensor before the first change, to go back to it.
+    // The request is handled before the change that follows it.
+    if (m_accRange == 0)
+        asyncGet(WB_RES::LOCAL::MEAS_ACC_CONFIG(), AsyncRequestOptions::Empty);
+
+    const uint8_t range = requiredRange > 0 ? requiredRange : m_accOwnRange;
+    m_accRange = requiredRange;
+    if (range == 0)
+    {
+        DebugLogger::warning("%s: Acc range before the change not known, keeping it", LAUNCHABLE_NAME);
+        return;
+    }
+
+    DebugLogger::info("%s: Changing acc range to %u g", LAUNCHABLE_NAME, range);
+    WB_RES::AccConfig accConfig = {};
+    accConfig.gRange = range;
+    asyncPut(WB_RES::LOCAL::MEAS_ACC_CONFIG(), AsyncRequestOptions::Empty, accConfig);
+}
+
+void SensorHub::onGetResult(
+    wb::RequestId requestId,
+    wb::ResourceId resourceId,
+    wb::Result resultCode,
+    const wb::Value& result)
+{
+    if (resultCode >= 400)
+    {
+        DebugLogger::error("%s: onGetResult resource: %d, status: %d",
+            LAUNCHABLE_NAME, resourceId.localResourceId, resultCode);
+        return;
+    }
+
+    if (resourceId.localResourceId == WB_RES::LOCAL::MEAS_ACC_CONFIG::LID)
+        m_accOwnRange = result.convertTo<const WB_RES::AccConfig&>().gRange;
+}
+
+void SensorHub::onPutResult(
+    wb::RequestId requestId,
+    wb::ResourceId resourceId,
+    wb::Result resultCode,
+    const wb::Value& result)
+{
+    if (resultCode >= 400)
+    {
+        DebugLogger::error("%s: onPutResult resource: %d, status: %d",
+            LAUNCHABLE_NAME, resourceId.localResourceId, resultCode);
+    }
+}
+
+void SensorHub::onSubscribeResult(
+    wb::RequestId requestId,
+    wb::ResourceId resourceId,
+    wb::Result resultCode,
+    const wb::Value& result)
+{
+    if (resultCode >= 400)
+    {
+        DebugLogger::error("%s: onSubscribeResult resource: %d, status: %d",
+            LAUNCHABLE_NAME, resourceId.localResourceId, resultCode);
+    }
+}
+
+void SensorHub::onUnsubscribeResult(
+    wb::RequestId requestId,
+    wb::ResourceId resourceId,
+    wb::Result resultCode,
+    const wb::Value& rResultData)
+{
+    if (resultCode >= 400)
+    {
+        DebugLogger::error("%s: onUnsubscribeResult resource: %d, status: %d",
+            LAUNCHABLE_NAME, resourceId.localResourceId, resultCode);
+    }
+}
+
+void SensorHub::onNotify(
+    wb::ResourceId resourceId,
+    const wb::Value& value,
+    const wb::ParameterList& parameters)
+{
+    switch (resourceId.localResourceId)
+    {
+    case WB_RES::LOCAL::MEAS_ACC_SAMPLERATE::LID:
+    {
+        auto data = value.convertTo<const WB_RES::AccData&>();
+        m_accCascade.deliver(data);
+        break;
+    }
+    default:
+        DebugLogger::warning("%s: Unhandled notification from resource: %d",
+            LAUNCHABLE_NAME, resourceId.localResourceId);
+        break;
+    }
+}
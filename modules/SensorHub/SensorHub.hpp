@@ -0,0 +1,94 @@
+#pragma once
+#include <whiteboard/LaunchableModule.h>
+#include <whiteboard/ResourceClient.h>
+
+#include "app-resources/resources.h"
+#include "meas_acc/resources.h"
+#include "internal/AccCascade.hpp"
+
+/// Owner of the sensor subscriptions shared by several modules.
+///
+/// The accelerometer is subscribed once at the highest sample rate of the
+/// registered consumers, or at the base rate if that is higher. The other
+/// consumers get the samples through a cascade of halfband decimators, shared
+/// by all of them: the acc rates 13, 26, 52, ... Hz are (close to) powers of
+/// two apart, and a consumer at 1/2^N of the sensor rate takes the output of
+/// stage N. Consumers can change their rate up to the sensor rate without a
+/// resubscription, so a base rate above the usual rates avoids the gaps.
+/// The hub also owns the range of the sensor: it runs at the largest range
+/// requested by the consumers, and goes back to the range it had before when
+/// none is requested. Consumers have to run in the encoding execution context, as they are
+/// called directly from the notifications.
+class SensorHub FINAL : private wb::ResourceClient, public wb::LaunchableModule
+{
+public:
+    static const char* const LAUNCHABLE_NAME;
+    static constexpr size_t MAX_ACC_CONSUMERS = sensor_hub::AccCascade::MAX_CONSUMERS;
+
+    SensorHub();
+    ~SensorHub();
+
+    /// The hub of the firmware, nullptr before it is created
+    static SensorHub* instance();
+
+    /// Deliver samples to consumer at sampleRate (Hz), or change its rate.
+    /// gRange (g) is the range the consumer needs, 0 takes any.
+    /// Returns false if all consumer slots are taken.
+    bool subscribeAcc(sensor_hub::AccConsumer& consumer, uint16_t sampleRate, uint8_t gRange = 0);
+    void unsubscribeAcc(sensor_hub::AccConsumer& consumer);
+
+    /// Run the sensor at least at sampleRate (Hz) while there are consumers, 0 follows the consumers
+    void setAccBaseRate(uint16_t sampleRate);
+
+    /// Current sample rate of the sensor, 0 when not subscribed
+    uint16_t accSampleRate() const { return m_accSampleRate; }
+
+private: /* wb::LaunchableModule*/
+    virtual bool initModule() OVERRIDE;
+    virtual void deinitModule() OVERRIDE;
+    virtual bool startModule() OVERRIDE;
+    virtual void stopModule() OVERRIDE;
+
+private: /* wb::ResourceClient */
+    virtual void onGetResult(
+        wb::RequestId requestId,
+        wb::ResourceId resourceId,
+        wb::Result resultCode,
+        const wb::Value& result) OVERRIDE;
+
+    virtual void onPutResult(
+        wb::RequestId requestId,
+        wb::ResourceId resourceId,
+        wb::Result resultCode,
+        const wb::Value& result) OVERRIDE;
+
+    virtual void onSubscribeResult(
+        wb::RequestId requestId,
+        wb::ResourceId resourceId,
+        wb::Result resultCode,
+        const wb::Value& result) OVERRIDE;
+
+    virtual void onUnsubscribeResult(
+        wb::RequestId requestId,
+        wb::ResourceId resourceId,
+        wb::Result resultCode,
+        const wb::Value& rResultData) OVERRIDE;
+
+    virtual void onNotify(
+        wb::ResourceId resourceId,
+        const wb::Value& value,
+        const wb::ParameterList& parameters) OVERRIDE;
+
+private:
+    void updateAccSubscription();
+    void resubscribeAcc(uint16_t requiredSampleRate);
+    void updateAccRange();
+
+    sensor_hub::AccCascade m_accCascade;
+    uint16_t m_accSampleRate;
+    uint16_t m_accBaseRate;
+    uint8_t m_accRange;    // Set by the hub, 0 while the sensor has its own range
+    uint8_t m_accOwnRange; // Range of the sensor before the hub set one, 0 if not known
+
+    static SensorHub* s_instance;
+};
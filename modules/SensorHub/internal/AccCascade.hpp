@@ -0,0 +1,273 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "meas_acc/resources.h"
+#include "Halfband.hpp"
+
+namespace sensor_hub
+{
+    /// Receiver of acceleration samples at the sample rate it was registered with.
+    /// Called in the execution context of the hub (encoding).
+    class AccConsumer
+    {
+    public:
+        virtual void onAccData(const WB_RES::AccData& data) = 0;
+
+    protected:
+        ~AccConsumer() = default;
+    };
+
+    /// Consumer that forwards the samples to a member function of its owner
+    template<typename TOwner, void (TOwner::*Handler)(const WB_RES::AccData&)>
+    class AccHandler final : public AccConsumer
+    {
+    private:
+        TOwner& m_owner;
+
+    public:
+        explicit AccHandler(TOwner& owner)
+            : m_owner(owner)
+        {
+        }
+
+        void onAccData(const WB_RES::AccData& data) override
+        {
+            (m_owner.*Handler)(data);
+        }
+    };
+
+    /// The consumers of the accelerometer and the halfband cascade that feeds them
+    /// from the samples of the sensor, without the subscription (see SensorHub).
+    ///
+    /// A consumer at 1/2^N of the sensor rate gets the output of stage N, with the
+    /// timestamps moved back by the delay of the stages, DELAY * (2^N - 1) sensor
+    /// samples. A consumer that changes its rate continues after the last sample it got.
+    class AccCascade
+    {
+    public:
+        static constexpr size_t MAX_CONSUMERS = 8;
+        static constexpr size_t MAX_LEVELS = 7; // Decimation by up to 128
+        static constexpr size_t CHUNK_SIZE = 8; // Input samples decimated at a time
+        static constexpr int32_t FRACTION_BITS = 12; // Fixed-point format of the decimators, Q19.12 m/s^2
+
+    private:
+        struct Slot
+        {
+            AccConsumer* consumer = nullptr;
+            uint16_t sampleRate = 0;
+            uint8_t gRange = 0; // Requested range, 0 takes any
+            uint8_t level = 0; // Decimation by 2^level from the sensor rate
+            bool resuming = false; // Rate changed, skip the samples up to lastTimestamp
+            uint32_t lastTimestamp = 0; // Of the last delivered sample
+        } m_slots[MAX_CONSUMERS];
+
+        HalfbandDecimator m_stages[MAX_LEVELS];
+        size_t m_levels; // Stages in use
+        uint16_t m_sensorRate;
+
+        /// Exponent of the power of two closest to the ratio of the rates
+        static uint8_t decimation_level(uint16_t sensorRate, uint16_t sampleRate)
+        {
+            uint8_t level = 0;
+            while (level < MAX_LEVELS && (uint32_t)sampleRate * (3u << level) < (uint32_t)sensorRate * 2)
+                level++;
+            return level;
+        }
+
+        void deliver_level(size_t level, const WB_RES::AccData& data)
+        {
+            const size_t count = data.arrayAcc.size();
+            auto sampleTimestamp = [this, level, &data](size_t i) {
+                return data.timestamp + static_cast<uint32_t>(((uint64_t)i << level) * 1000 / m_sensorRate);
+                };
+
+            for (Slot& s : m_slots)
+            {
+                if (s.consumer == nullptr || s.level != level)
+                    continue;
+
+                size_t first = 0;
+                if (s.resuming)
+                {
+                    while (first < count && static_cast<int32_t>(sampleTimestamp(first) - s.lastTimestamp) <= 0)
+                        first++;
+                    if (first == count)
+                        continue;
+                    s.resuming = false;
+                }
+
+                if (first == 0)
+                {
+                    s.consumer->onAccData(data);
+                }
+                else
+                {
+                    WB_RES::AccData newer;
+                    newer.timestamp = sampleTimestamp(first);
+                    newer.arrayAcc = wb::MakeArray(&data.arrayAcc[first], count - first);
+                    s.consumer->onAccData(newer);
+                }
+                s.lastTimestamp = sampleTimestamp(count - 1);
+            }
+        }
+
+    public:
+        AccCascade()
+            : m_levels(0)
+            , m_sensorRate(0)
+        {
+        }
+
+        /// Register consumer at sampleRate (Hz) with gRange (g, 0 for any), or change
+        /// them. Returns false if all slots are taken. Call configure() after the changes.
+        bool set_consumer(AccConsumer& consumer, uint16_t sampleRate, uint8_t gRange)
+        {
+            Slot* free = nullptr;
+            Slot* slot = nullptr;
+            for (Slot& s : m_slots)
+            {
+                if (s.consumer == &consumer)
+                    slot = &s;
+                else if (s.consumer == nullptr && free == nullptr)
+                    free = &s;
+            }
+
+            if (slot == nullptr)
+                slot = free;
+            if (slot == nullptr)
+                return false;
+
+            // The stages have different delays, so a consumer that changes its rate
+            // could get samples older than the ones it already has
+            slot->resuming = (slot->consumer != nullptr);
+            slot->consumer = &consumer;
+            slot->sampleRate = sampleRate;
+            slot->gRange = gRange;
+            return true;
+        }
+
+        void remove_consumer(AccConsumer& consumer)
+        {
+            for (Slot& s : m_slots)
+            {
+                if (s.consumer == &consumer)
+                    s = Slot();
+            }
+        }
+
+        /// Highest sample rate of the consumers, 0 without consumers
+        uint16_t required_rate() const
+        {
+            uint16_t rate = 0;
+            for (const Slot& s : m_slots)
+            {
+                if (s.consumer != nullptr && s.sampleRate > rate)
+                    rate = s.sampleRate;
+            }
+            return rate;
+        }
+
+        /// Largest range requested by the consumers, 0 if none
+        uint8_t required_range() const
+        {
+            uint8_t range = 0;
+            for (const Slot& s : m_slots)
+            {
+                if (s.consumer != nullptr && s.gRange > range)
+                    range = s.gRange;
+            }
+            return range;
+        }
+
+        /// Assign the consumers to the stages for the sensor rate (Hz). A new sensor
+        /// rate restarts all stages, the stages out of use start over when they are
+        /// needed again.
+        void configure(uint16_t sensorRate)
+        {
+            if (sensorRate != m_sensorRate)
+            {
+                for (auto& stage : m_stages)
+                    stage.reset();
+                m_sensorRate = sensorRate;
+            }
+
+            m_levels = 0;
+            for (Slot& s : m_slots)
+            {
+                if (s.consumer == nullptr)
+                    continue;
+
+                s.level = decimation_level(m_sensorRate, s.sampleRate);
+                if (s.level > m_levels)
+                    m_levels = s.level;
+            }
+
+            for (size_t i = m_levels; i < MAX_LEVELS; i++)
+                m_stages[i].reset();
+        }
+
+        /// Pass the samples of a sensor notification to the consumers
+        void deliver(const WB_RES::AccData& data)
+        {
+            deliver_level(0, data);
+            if (m_levels == 0)
+                return;
+
+            // Fixed-point samples and the index of the input sample that completed them,
+            // passed from stage to stage
+            static int32_t samples[2][CHUNK_SIZE][3];
+            static size_t indices[2][CHUNK_SIZE];
+            static wb::FloatVector3D output[CHUNK_SIZE];
+            constexpr float TO_FIXED = (float)(1 << FRACTION_BITS);
+            constexpr float TO_FLOAT = 1.0f / (1 << FRACTION_BITS);
+
+            const size_t count = data.arrayAcc.size();
+            for (size_t start = 0; start < count; start += CHUNK_SIZE)
+            {
+                size_t n = count - start < CHUNK_SIZE ? count - start : CHUNK_SIZE;
+                size_t in = 0;
+                for (size_t i = 0; i < n; i++)
+                {
+                    const wb::FloatVector3D& v = data.arrayAcc[start + i];
+                    samples[in][i][0] = static_cast<int32_t>(v.x * TO_FIXED + (v.x >= 0.0f ? 0.5f : -0.5f));
+                    samples[in][i][1] = static_cast<int32_t>(v.y * TO_FIXED + (v.y >= 0.0f ? 0.5f : -0.5f));
+                    samples[in][i][2] = static_cast<int32_t>(v.z * TO_FIXED + (v.z >= 0.0f ? 0.5f : -0.5f));
+                    indices[in][i] = start + i;
+                }
+
+                for (size_t level = 1; level <= m_levels && n > 0; level++)
+                {
+                    const size_t out = 1 - in;
+                    size_t m = 0;
+                    for (size_t i = 0; i < n; i++)
+                    {
+                        if (m_stages[level - 1].push(samples[in][i], samples[out][m]))
+                            indices[out][m++] = indices[in][i];
+                    }
+
+                    if (m > 0)
+                    {
+                        for (size_t i = 0; i < m; i++)
+                        {
+                            output[i].x = samples[out][i][0] * TO_FLOAT;
+                            output[i].y = samples[out][i][1] * TO_FLOAT;
+                            output[i].z = samples[out][i][2] * TO_FLOAT;
+                        }
+
+                        // The outputs lag behind the inputs that completed them
+                        const int32_t delay = HalfbandDecimator::DELAY * ((1 << level) - 1);
+                        WB_RES::AccData decimated;
+                        decimated.timestamp = data.timestamp +
+                            ((int32_t)indices[out][0] - delay) * 1000 / (int32_t)m_sensorRate;
+                        decimated.arrayAcc = wb::MakeArray(output, m);
+                        deliver_level(level, decimated);
+                    }
+
+                    in = out;
+                    n = m;
+                }
+            }
+        }
+    };
+} // namespace sensor_hub
@@ -0,0 +1,104 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace sensor_hub
+{
+    /// Lowpass that halves the sample rate of 3-axis fixed-point samples.
+    ///
+    /// 11-tap halfband FIR (3, 0, -25, 0, 150, 256, 150, 0, -25, 0, 3) / 512, unity
+    /// gain at DC, -6 dB at a quarter of the input rate. In polyphase form the odd
+    /// inputs go through the six outer taps and the even inputs through the center
+    /// tap, so an output costs 4 multiplies per axis. Stages are cascaded for
+    /// decimation by powers of two.
+    ///
+    /// The history is filled with the first input after reset, so the output
+    /// starts without a transient. An output is the filtered value at the input
+    /// DELAY samples before the one that completed it.
+    class HalfbandDecimator
+    {
+    public:
+        static constexpr uint32_t DELAY = 5; // Input samples
+        static constexpr int32_t GAIN_BITS = 9;
+
+    private:
+        static constexpr size_t ODD_TAPS = 6;
+        static constexpr size_t EVEN_TAPS = 3; // The center tap needs the third latest even input
+
+        int32_t m_odd[ODD_TAPS][3];   // Latest first
+        int32_t m_even[EVEN_TAPS][3]; // Latest first
+        bool m_primed;
+        bool m_phase; // Next input is odd
+
+        template<size_t N>
+        static void shift_in(int32_t (&line)[N][3], const int32_t in[3])
+        {
+            for (size_t i = N - 1; i > 0; i--)
+            {
+                line[i][0] = line[i - 1][0];
+                line[i][1] = line[i - 1][1];
+                line[i][2] = line[i - 1][2];
+            }
+            line[0][0] = in[0];
+            line[0][1] = in[1];
+            line[0][2] = in[2];
+        }
+
+        void prime(const int32_t in[3])
+        {
+            for (auto& v : m_odd)
+            {
+                v[0] = in[0];
+                v[1] = in[1];
+                v[2] = in[2];
+            }
+            for (auto& v : m_even)
+            {
+                v[0] = in[0];
+                v[1] = in[1];
+                v[2] = in[2];
+            }
+            m_primed = true;
+        }
+
+    public:
+        HalfbandDecimator()
+        {
+            reset();
+        }
+
+        void reset()
+        {
+            m_primed = false;
+            m_phase = false;
+        }
+
+        /// Filter an input, returns true when an output was written
+        bool push(const int32_t in[3], int32_t out[3])
+        {
+            if (!m_primed)
+                prime(in);
+
+            if (!m_phase)
+            {
+                shift_in(m_even, in);
+                m_phase = true;
+                return false;
+            }
+
+            shift_in(m_odd, in);
+            m_phase = false;
+
+            for (size_t a = 0; a < 3; a++)
+            {
+                const int32_t acc =
+                    3 * (m_odd[0][a] + m_odd[5][a]) -
+                    25 * (m_odd[1][a] + m_odd[4][a]) +
+                    150 * (m_odd[2][a] + m_odd[3][a]) +
+                    256 * m_even[2][a];
+                out[a] = (acc + (1 << (GAIN_BITS - 1))) >> GAIN_BITS;
+            }
+            return true;
+        }
+    };
+} // namespace sensor_hub
@@ -1,4 +1,5 @@
 #include "OfflineApp.hpp"
+#include "../modules/SensorHub/SensorHub.hpp"
 #include "../modules/OfflineMeasurements/OfflineMeasurements.hpp"
 #include "../modules/OfflineGattService/OfflineGattService.hpp"
 #include "../modules/GestureService/GestureService.hpp"
@@ -6,12 +7,13 @@
 
 MOVESENSE_APPLICATION_STACKSIZE(1024)
 
-MOVESENSE_PROVIDERS_BEGIN(4)
+MOVESENSE_PROVIDERS_BEGIN(5)
 MOVESENSE_PROVIDER_DEF(OfflineApp)
+MOVESENSE_PROVIDER_DEF(SensorHub)
 MOVESENSE_PROVIDER_DEF(OfflineMeasurements)
 MOVESENSE_PROVIDER_DEF(OfflineGattService)
 MOVESENSE_PROVIDER_DEF(GestureService)
-MOVESENSE_PROVIDERS_END(4)
+MOVESENSE_PROVIDERS_END(5)
 
 MOVESENSE_FEATURES_BEGIN()
 
@@ -20,7 +20,7 @@
 #include "DebugLogger.hpp"
 
 const char* const OfflineApp::LAUNCHABLE_NAME = "OfflineApp";
-constexpr uint8_t EEPROM_INIT_MAGIC = 0x42; // Change this for breaking changes
+constexpr uint8_t EEPROM_INIT_MAGIC = 0x4F; // Change this for breaking changes
 
 constexpr uint32_t TIMER_TICK_SLEEP = 1000;
 constexpr uint32_t TIMER_TICK_LED = 250;
@@ -556,6 +556,25 @@ WB_RES::OfflineConfig OfflineApp::getConfig() const
         .measurementParams = wb::MakeArray(m_config.params),
         .sleepDelay = m_config.sleepDelay,
         .options = m_config.options,
+        .ecgCompression = m_config.ecgCompression,
+        .ecgPredictor = m_config.ecgPredictor,
+        .ecgBlockSize = m_config.ecgBlockSize,
+        .ecgBitDepth = m_config.ecgBitDepth,
+        .ecgMaxError = m_config.ecgMaxError,
+        .ecgWaveletThreshold = m_config.ecgWaveletThreshold,
+        .accRange = m_config.accRange,
+        .gyroRange = m_config.gyroRange,
+        .extendedOptions = m_config.extendedOptions,
+        .hrHysteresis = m_config.hrHysteresis,
+        .tempHysteresis = m_config.tempHysteresis,
+        .activityHysteresis = m_config.activityHysteresis,
+        .slowMinInterval = m_config.slowMinInterval,
+        .slowHeartbeat = m_config.slowHeartbeat,
+        .slowBlockAge = m_config.slowBlockAge,
+        .syncInterval = m_config.syncInterval,
+        .batchBytes = m_config.batchBytes,
+        .batchLatency = m_config.batchLatency,
+        .accBaseRate = m_config.accBaseRate,
     };
 }
 
@@ -601,6 +620,54 @@ bool OfflineApp::applyConfig(const WB_RES::OfflineConfig& config)
                 return false;
             }
         }
+
+        if (config.ecgCompression != WB_RES::OfflineECGCompression::GAMMA &&
+            config.ecgCompression != WB_RES::OfflineECGCompression::RICE &&
+            config.ecgCompression != WB_RES::OfflineECGCompression::WAVELET &&
+            config.ecgCompression != WB_RES::OfflineECGCompression::ADAPTIVE)
+        {
+            return false;
+        }
+
+        if (config.ecgPredictor > WB_RES::OfflineECGPredictor::BEATTEMPLATE)
+        {
+            return false;
+        }
+
+        if (config.ecgBlockSize != 32 && config.ecgBlockSize != 64 &&
+            config.ecgBlockSize != 128 && config.ecgBlockSize != 256)
+        {
+            return false;
+        }
+
+        if (config.ecgBitDepth != 16 && config.ecgBitDepth != 18)
+        {
+            return false;
+        }
+
+        if (config.ecgMaxError > 15)
+        {
+            return false;
+        }
+
+        if (config.accRange != 0 && config.accRange != 2 && config.accRange != 4 &&
+            config.accRange != 8 && config.accRange != 16)
+        {
+            return false;
+        }
+
+        if (config.gyroRange != 0 && config.gyroRange != 245 && config.gyroRange != 500 &&
+            config.gyroRange != 1000 && config.gyroRange != 2000)
+        {
+            return false;
+        }
+
+        if (config.accBaseRate != 0 && config.accBaseRate != 13 && config.accBaseRate != 26 &&
+            config.accBaseRate != 52 && config.accBaseRate != 104 && config.accBaseRate != 208 &&
+            config.accBaseRate != 416 && config.accBaseRate != 833 && config.accBaseRate != 1666)
+        {
+            return false;
+        }
     }
 
     bool init = (m_state.id.getValue() == WB_RES::OfflineState::INIT);
@@ -644,8 +711,28 @@ bool OfflineApp::applyConfig(const WB_RES::OfflineConfig& config)
     m_config.wakeUp = config.wakeUpBehavior;
     m_config.sleepDelay = config.sleepDelay;
     m_config.options = config.options;
+    m_config.ecgCompression = config.ecgCompression;
+    m_config.ecgPredictor = config.ecgPredictor;
+    m_config.ecgBlockSize = config.ecgBlockSize;
+    m_config.ecgBitDepth = config.ecgBitDepth;
+    m_config.ecgMaxError = config.ecgMaxError;
+    m_config.ecgWaveletThreshold = config.ecgWaveletThreshold;
+    m_config.accRange = config.accRange;
+    m_config.gyroRange = config.gyroRange;
+    m_config.extendedOptions = config.extendedOptions;
+    m_config.hrHysteresis = config.hrHysteresis;
+    m_config.tempHysteresis = config.tempHysteresis;
+    m_config.activityHysteresis = config.activityHysteresis;
+    m_config.slowMinInterval = config.slowMinInterval;
+    m_config.slowHeartbeat = config.slowHeartbeat;
+    m_config.slowBlockAge = config.slowBlockAge;
+    m_config.syncInterval = config.syncInterval;
+    m_config.batchBytes = config.batchBytes;
+    m_config.batchLatency = config.batchLatency;
+    m_config.accBaseRate = config.accBaseRate;
     memcpy(m_config.params, config.measurementParams.begin(), sizeof(m_config.params));
 
+    configureMeasurements(config);
     configureLogger(config);
 
     DebugLogger::info("%s: Configuration changed!", LAUNCHABLE_NAME);
@@ -658,11 +745,33 @@ void OfflineApp::configureLogger(const WB_RES::OfflineConfig& config)
     memset(m_logger.paths, 0, sizeof(m_logger.paths));
 
     bool ecgCompression = !!(config.options & WB_RES::OfflineOptionsFlags::COMPRESSECGSAMPLES);
+    bool imuCompression = !!(config.options & WB_RES::OfflineOptionsFlags::COMPRESSIMUSAMPLES);
+    bool rrCompression = !!(config.extendedOptions & WB_RES::OfflineExtendedOptionsFlags::COMPRESSRRINTERVALS);
+    bool slowCompression = !!(config.extendedOptions & WB_RES::OfflineExtendedOptionsFlags::COMPRESSSLOWCHANNELS);
+    bool implicitTimestamps = !!(config.extendedOptions & WB_RES::OfflineExtendedOptionsFlags::IMPLICITTIMESTAMPS);
     bool logTapGestures = !!(config.options & WB_RES::OfflineOptionsFlags::LOGTAPGESTURES);
     bool logShakeGestures = !!(config.options & WB_RES::OfflineOptionsFlags::LOGSHAKEGESTURES);
     bool logOrientation = !!(config.options & WB_RES::OfflineOptionsFlags::LOGORIENTATION);
 
     WB_RES::DataEntry entries[Logger::MAX_LOGGED_PATHS] = {};
+
+    // Only the uncompressed, full precision formats have implicit timestamps
+    const auto& params = config.measurementParams;
+    bool ecgImplicit = implicitTimestamps && !ecgCompression;
+    bool accImplicit = implicitTimestamps && !imuCompression && config.accRange == 0;
+    bool gyroImplicit = implicitTimestamps && !imuCompression && config.gyroRange == 0;
+    bool magnImplicit = implicitTimestamps && !imuCompression;
+    if ((ecgImplicit && params[WB_RES::OfflineMeasurement::ECG]) ||
+        (accImplicit && params[WB_RES::OfflineMeasurement::ACC]) ||
+        (gyroImplicit && params[WB_RES::OfflineMeasurement::GYRO]) ||
+        (magnImplicit && params[WB_RES::OfflineMeasurement::MAGN]))
+    {
+        // Before the measurements, so that it gets the first sync records
+        strcpy(m_logger.paths[count], "/Offline/Meas/Sync");
+        entries[count].path = m_logger.paths[count];
+        count++;
+    }
+
     for (auto i = 0; i < WB_RES::OfflineMeasurement::COUNT; i++)
     {
         if (config.measurementParams[i])
@@ -672,29 +781,62 @@ void OfflineApp::configureLogger(const WB_RES::OfflineConfig& config)
             case WB_RES::OfflineMeasurement::ECG:
                 if (ecgCompression)
                     sprintf(m_logger.paths[count], "/Offline/Meas/ECG/Compressed/%u", config.measurementParams[i]);
+                else if (ecgImplicit)
+                    sprintf(m_logger.paths[count], "/Offline/Meas/ECG/Implicit/%u", config.measurementParams[i]);
                 else
                     sprintf(m_logger.paths[count], "/Offline/Meas/ECG/%u", config.measurementParams[i]);
                 break;
             case WB_RES::OfflineMeasurement::ACC:
-                sprintf(m_logger.paths[count], "/Offline/Meas/Acc/%u", config.measurementParams[i]);
+                if (imuCompression)
+                    sprintf(m_logger.paths[count], "/Offline/Meas/Acc/Compressed/%u", config.measurementParams[i]);
+                else if (config.accRange > 0)
+                    sprintf(m_logger.paths[count], "/Offline/Meas/Acc/Compact/%u", config.measurementParams[i]);
+                else if (accImplicit)
+                    sprintf(m_logger.paths[count], "/Offline/Meas/Acc/Implicit/%u", config.measurementParams[i]);
+                else
+                    sprintf(m_logger.paths[count], "/Offline/Meas/Acc/%u", config.measurementParams[i]);
                 break;
             case WB_RES::OfflineMeasurement::GYRO:
-                sprintf(m_logger.paths[count], "/Offline/Meas/Gyro/%u", config.measurementParams[i]);
+                if (imuCompression)
+                    sprintf(m_logger.paths[count], "/Offline/Meas/Gyro/Compressed/%u", config.measurementParams[i]);
+                else if (config.gyroRange > 0)
+                    sprintf(m_logger.paths[count], "/Offline/Meas/Gyro/Compact/%u", config.measurementParams[i]);
+                else if (gyroImplicit)
+                    sprintf(m_logger.paths[count], "/Offline/Meas/Gyro/Implicit/%u", config.measurementParams[i]);
+                else
+                    sprintf(m_logger.paths[count], "/Offline/Meas/Gyro/%u", config.measurementParams[i]);
                 break;
             case WB_RES::OfflineMeasurement::MAGN:
-                sprintf(m_logger.paths[count], "/Offline/Meas/Magn/%u", config.measurementParams[i]);
+                if (imuCompression)
+                    sprintf(m_logger.paths[count], "/Offline/Meas/Magn/Compressed/%u", config.measurementParams[i]);
+                else if (magnImplicit)
+                    sprintf(m_logger.paths[count], "/Offline/Meas/Magn/Implicit/%u", config.measurementParams[i]);
+                else
+                    sprintf(m_logger.paths[count], "/Offline/Meas/Magn/%u", config.measurementParams[i]);
                 break;
             case WB_RES::OfflineMeasurement::HR:
-                strcpy(m_logger.paths[count], "/Offline/Meas/HR");
+                if (slowCompression)
+                    strcpy(m_logger.paths[count], "/Offline/Meas/HR/Compressed");
+                else
+                    strcpy(m_logger.paths[count], "/Offline/Meas/HR");
                 break;
             case WB_RES::OfflineMeasurement::RR:
-                strcpy(m_logger.paths[count], "/Offline/Meas/RR");
+                if (rrCompression)
+                    strcpy(m_logger.paths[count], "/Offline/Meas/RR/Compressed");
+                else
+                    strcpy(m_logger.paths[count], "/Offline/Meas/RR");
                 break;
             case WB_RES::OfflineMeasurement::TEMP:
-                strcpy(m_logger.paths[count], "/Offline/Meas/Temp");
+                if (slowCompression)
+                    strcpy(m_logger.paths[count], "/Offline/Meas/Temp/Compressed");
+                else
+                    strcpy(m_logger.paths[count], "/Offline/Meas/Temp");
                 break;
             case WB_RES::OfflineMeasurement::ACTIVITY:
-                sprintf(m_logger.paths[count], "/Offline/Meas/Activity/%u", config.measurementParams[i]);
+                if (slowCompression)
+                    sprintf(m_logger.paths[count], "/Offline/Meas/Activity/Compressed/%u", config.measurementParams[i]);
+                else
+                    sprintf(m_logger.paths[count], "/Offline/Meas/Activity/%u", config.measurementParams[i]);
                 break;
             }
 
@@ -731,6 +873,31 @@ void OfflineApp::configureLogger(const WB_RES::OfflineConfig& config)
     asyncPut(WB_RES::LOCAL::MEM_DATALOGGER_CONFIG(), AsyncRequestOptions::Empty, logConfig);
 }
 
+void OfflineApp::configureMeasurements(const WB_RES::OfflineConfig& config)
+{
+    WB_RES::OfflineMeasConfig measConfig = {
+        .ecgCompression = static_cast<WB_RES::OfflineECGCompression::Type>(config.ecgCompression),
+        .ecgPredictor = static_cast<WB_RES::OfflineECGPredictor::Type>(config.ecgPredictor),
+        .ecgBlockSize = config.ecgBlockSize,
+        .ecgBitDepth = config.ecgBitDepth,
+        .ecgMaxError = config.ecgMaxError,
+        .ecgWaveletThreshold = config.ecgWaveletThreshold,
+        .accRange = config.accRange,
+        .gyroRange = config.gyroRange,
+        .hrHysteresis = config.hrHysteresis,
+        .tempHysteresis = config.tempHysteresis,
+        .activityHysteresis = config.activityHysteresis,
+        .slowMinInterval = config.slowMinInterval,
+        .slowHeartbeat = config.slowHeartbeat,
+        .slowBlockAge = config.slowBlockAge,
+        .syncInterval = config.syncInterval,
+        .batchBytes = config.batchBytes,
+        .batchLatency = config.batchLatency,
+        .accBaseRate = config.accBaseRate,
+    };
+    asyncPut(WB_RES::LOCAL::OFFLINE_MEAS_CONFIG(), AsyncRequestOptions::Empty, measConfig);
+}
+
 void OfflineApp::startLogging()
 {
     if (!m_state.validConfig || m_logger.number_of_paths == 0)
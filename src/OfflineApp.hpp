@@ -18,6 +18,25 @@ struct OfflineConfigData
     uint16_t params[WB_RES::OfflineMeasurement::COUNT] = {};
     uint16_t sleepDelay = 60;
     uint8_t options = WB_RES::OfflineOptionsFlags::SHAKETOCONNECT;
+    uint8_t ecgCompression = WB_RES::OfflineECGCompression::GAMMA;
+    uint8_t ecgPredictor = WB_RES::OfflineECGPredictor::FIRSTORDER;
+    uint16_t ecgBlockSize = 32;
+    uint8_t ecgBitDepth = 16;
+    uint8_t ecgMaxError = 0;
+    uint8_t ecgWaveletThreshold = 0;
+    uint8_t accRange = 0;
+    uint16_t gyroRange = 0;
+    uint8_t extendedOptions = 0;
+    uint8_t hrHysteresis = 1;
+    uint8_t tempHysteresis = 1;
+    uint16_t activityHysteresis = 0;
+    uint16_t slowMinInterval = 0;
+    uint16_t slowHeartbeat = 0;
+    uint16_t slowBlockAge = 900;
+    uint16_t syncInterval = 60;
+    uint16_t batchBytes = 0;
+    uint16_t batchLatency = 1000;
+    uint16_t accBaseRate = 0; // Follow the channels, rate changes resubscribe the accelerometer
 };
 
 struct OfflineDebugData
@@ -154,7 +173,7 @@ private:
     struct Logger
     {
         static constexpr size_t MAX_LOGGED_PATHS = (
-            WB_RES::OfflineMeasurement::COUNT + WB_RES::Gesture::COUNT
+            WB_RES::OfflineMeasurement::COUNT + WB_RES::Gesture::COUNT + 1 // Sync records
             );
         static constexpr size_t MAX_PATH_LEN = 42;
         char paths[MAX_LOGGED_PATHS][MAX_PATH_LEN];
@@ -170,6 +189,7 @@ private:
     void stopLogging();
     void restartLogging();
     void configureLogger(const WB_RES::OfflineConfig& config);
+    void configureMeasurements(const WB_RES::OfflineConfig& config);
 
     void setState(WB_RES::OfflineState state);
     void powerOff(bool reset);